@@ -0,0 +1,2 @@
+#define HUB_BUILD_GIT_HASH "33f8d1d7639e-dirty"
+#define HUB_BUILD_CXXFLAGS "-O2 -std=c++17 -Wall -Wextra -pedantic -frounding-math -mno-fma -mno-fma4 -pthread -DEXP_BITS=8 -DMANT_BITS=23 -DUNBIASED_ROUNDING=1"
@@ -0,0 +1,87 @@
+/*
+    File: hub_float_array.hpp
+    Elementwise hub_float kernels over arrays of doubles, used by the NumPy functions of the Python bindings.
+
+    Values are passed as doubles, as hub_float stores them. Every operand is first rounded to the hub grid,
+    exactly as constructing a HubFloat from it would, so the results are the same as those of the scalar
+    operators applied element by element. An operand given with a step of 0 is a single value broadcast
+    over all n elements. The output may alias an input of the same length.
+*/
+
+#ifndef HUB_FLOAT_ARRAY_HPP
+#define HUB_FLOAT_ARRAY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include "../src/hub_float.hpp"
+
+namespace hub_array {
+
+/*
+    Function: quantize
+    Rounds each value to the nearest hub_float: out[i] = hub_float(x[i]).
+*/
+inline void quantize(const double* x, size_t n, double* out) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<double>(hub_float(x[i]));
+    }
+}
+
+/*
+    Function: unary
+    out[i] = op(hub_float(x[i])) for an operation on hub_float such as sqrt.
+*/
+template<typename Op>
+void unary(const double* x, size_t n, double* out, Op op) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<double>(op(hub_float(x[i])));
+    }
+}
+
+/*
+    Function: binary
+    out[i] = op(hub_float(a[i * a_step]), hub_float(b[i * b_step])).
+*/
+template<typename Op>
+void binary(const double* a, size_t a_step, const double* b, size_t b_step, size_t n, double* out, Op op) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<double>(op(hub_float(a[i * a_step]), hub_float(b[i * b_step])));
+    }
+}
+
+/*
+    Function: fma
+    out[i] = fma(hub_float(a[i]), hub_float(b[i]), hub_float(c[i])) with a single rounding, each operand
+    stepping by its own step.
+*/
+inline void fma(const double* a, size_t a_step, const double* b, size_t b_step, const double* c, size_t c_step,
+                size_t n, double* out) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<double>(fma(hub_float(a[i * a_step]), hub_float(b[i * b_step]), hub_float(c[i * c_step])));
+    }
+}
+
+/*
+    Function: pack
+    Rounds each value to hub_float and stores its raw binary representation (sign, exponent, mantissa),
+    as hub_float::toBits. Needs 1 + EXP_BITS + MANT_BITS <= 32.
+*/
+inline void pack(const double* x, size_t n, uint32_t* out) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<uint32_t>(hub_float(x[i]).toBits());
+    }
+}
+
+/*
+    Function: unpack
+    The inverse of pack: out[i] is the value of the hub_float with raw binary representation bits[i].
+*/
+inline void unpack(const uint32_t* bits, size_t n, double* out) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<double>(hub_float(bits[i]));
+    }
+}
+
+} // namespace hub_array
+
+#endif // HUB_FLOAT_ARRAY_HPP
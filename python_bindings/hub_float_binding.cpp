@@ -4,12 +4,81 @@
 */
 
 #include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
 #include <pybind11/operators.h>
 #include <pybind11/stl.h>
+#include <algorithm>
+#include <initializer_list>
+#include <string>
+#include <vector>
 #include "../src/hub_float.hpp"
+#include "hub_float_array.hpp"
 
 namespace py = pybind11;
 
+/*
+    NumPy arrays of float64 holding hub_float values. C-contiguous float64 arrays are read in place
+    through the buffer protocol; anything else (lists, scalars, other dtypes or layouts) is converted
+    once on the way in. The GIL is released while the kernels run.
+*/
+using DoubleArray = py::array_t<double, py::array::c_style | py::array::forcecast>;
+using BitsArray = py::array_t<uint32_t, py::array::c_style | py::array::forcecast>;
+
+// Shape of an elementwise result: every operand has that shape or a single element
+static std::vector<py::ssize_t> broadcast_shape(std::initializer_list<const py::array*> operands) {
+    const py::array* largest = *operands.begin();
+    for (const py::array* a : operands) {
+        if (a->size() > largest->size()) {
+            largest = a;
+        }
+    }
+    std::vector<py::ssize_t> shape(largest->shape(), largest->shape() + largest->ndim());
+    for (const py::array* a : operands) {
+        if (a->size() != 1 && (a->ndim() != largest->ndim() ||
+                               !std::equal(shape.begin(), shape.end(), a->shape()))) {
+            throw py::value_error("operands must have the same shape or a single element");
+        }
+    }
+    return shape;
+}
+
+// Step through an operand: 0 broadcasts a single element
+static size_t step(const py::array& a) {
+    return a.size() == 1 ? 0 : 1;
+}
+
+// The result array: a new one, or `out`, which must be a writable C-contiguous float64 array of the
+// result shape and is then written in place
+static DoubleArray output(const std::vector<py::ssize_t>& shape, const py::object& out) {
+    if (out.is_none()) {
+        return DoubleArray(shape);
+    }
+    if (!py::isinstance<py::array_t<double, py::array::c_style>>(out)) {
+        throw py::type_error("out must be a C-contiguous float64 array");
+    }
+    DoubleArray result = out.cast<DoubleArray>();
+    if (static_cast<size_t>(result.ndim()) != shape.size() ||
+        !std::equal(shape.begin(), shape.end(), result.shape())) {
+        throw py::value_error("out does not have the shape of the result");
+    }
+    if (!result.writeable()) {
+        throw py::value_error("out is read-only");
+    }
+    return result;
+}
+
+template<typename Op>
+static DoubleArray binary_array(const DoubleArray& a, const DoubleArray& b, const py::object& out, Op op) {
+    DoubleArray result = output(broadcast_shape({&a, &b}), out);
+    const size_t n = static_cast<size_t>(result.size());
+    double* r = result.mutable_data();
+    {
+        py::gil_scoped_release release;
+        hub_array::binary(a.data(), step(a), b.data(), step(b), n, r, op);
+    }
+    return result;
+}
+
 PYBIND11_MODULE(hub_float, m) {
     m.doc() = "Python bindings for hub_float - a custom floating-point implementation";
     
@@ -92,6 +161,71 @@ PYBIND11_MODULE(hub_float, m) {
         return fma(a, b, c); 
     }, "Fused multiply-add: (a*b + c)");
         
+    // Elementwise functions over NumPy arrays; the results are float64 arrays of hub_float values
+    m.def("quantize", [](const DoubleArray& x, const py::object& out) {
+        DoubleArray result = output(broadcast_shape({&x}), out);
+        double* r = result.mutable_data();
+        {
+            py::gil_scoped_release release;
+            hub_array::quantize(x.data(), static_cast<size_t>(x.size()), r);
+        }
+        return result;
+    }, py::arg("x"), py::arg("out") = py::none(), "Round each element to the nearest hub_float");
+    m.def("add", [](const DoubleArray& a, const DoubleArray& b, const py::object& out) {
+        return binary_array(a, b, out, [](const hub_float& x, const hub_float& y) { return x + y; });
+    }, py::arg("a"), py::arg("b"), py::arg("out") = py::none(), "Elementwise hub_float a + b");
+    m.def("sub", [](const DoubleArray& a, const DoubleArray& b, const py::object& out) {
+        return binary_array(a, b, out, [](const hub_float& x, const hub_float& y) { return x - y; });
+    }, py::arg("a"), py::arg("b"), py::arg("out") = py::none(), "Elementwise hub_float a - b");
+    m.def("mul", [](const DoubleArray& a, const DoubleArray& b, const py::object& out) {
+        return binary_array(a, b, out, [](const hub_float& x, const hub_float& y) { return x * y; });
+    }, py::arg("a"), py::arg("b"), py::arg("out") = py::none(), "Elementwise hub_float a * b");
+    m.def("div", [](const DoubleArray& a, const DoubleArray& b, const py::object& out) {
+        return binary_array(a, b, out, [](const hub_float& x, const hub_float& y) { return x / y; });
+    }, py::arg("a"), py::arg("b"), py::arg("out") = py::none(), "Elementwise hub_float a / b");
+    m.def("fma", [](const DoubleArray& a, const DoubleArray& b, const DoubleArray& c, const py::object& out) {
+        DoubleArray result = output(broadcast_shape({&a, &b, &c}), out);
+        const size_t n = static_cast<size_t>(result.size());
+        double* r = result.mutable_data();
+        {
+            py::gil_scoped_release release;
+            hub_array::fma(a.data(), step(a), b.data(), step(b), c.data(), step(c), n, r);
+        }
+        return result;
+    }, py::arg("a"), py::arg("b"), py::arg("c"), py::arg("out") = py::none(),
+       "Elementwise hub_float (a*b + c) with one rounding");
+    m.def("sqrt", [](const DoubleArray& x, const py::object& out) {
+        DoubleArray result = output(broadcast_shape({&x}), out);
+        double* r = result.mutable_data();
+        {
+            py::gil_scoped_release release;
+            hub_array::unary(x.data(), static_cast<size_t>(x.size()), r, [](const hub_float& v) { return sqrt(v); });
+        }
+        return result;
+    }, py::arg("x"), py::arg("out") = py::none(), "Elementwise hub_float square root");
+    m.def("pack", [](const DoubleArray& x) {
+        if (1 + EXP_BITS + MANT_BITS > 32) {
+            throw py::value_error("pack needs 1 + EXP_BITS + MANT_BITS <= 32, the format has " +
+                                  std::to_string(1 + EXP_BITS + MANT_BITS) + " bits");
+        }
+        BitsArray result(std::vector<py::ssize_t>(x.shape(), x.shape() + x.ndim()));
+        uint32_t* r = result.mutable_data();
+        {
+            py::gil_scoped_release release;
+            hub_array::pack(x.data(), static_cast<size_t>(x.size()), r);
+        }
+        return result;
+    }, py::arg("x"), "Round each element to hub_float and return its raw binary representation as uint32");
+    m.def("unpack", [](const BitsArray& bits) {
+        DoubleArray result(std::vector<py::ssize_t>(bits.shape(), bits.shape() + bits.ndim()));
+        double* r = result.mutable_data();
+        {
+            py::gil_scoped_release release;
+            hub_array::unpack(bits.data(), static_cast<size_t>(bits.size()), r);
+        }
+        return result;
+    }, py::arg("bits"), "Values of uint32 raw binary representations, the inverse of pack");
+
     // Module-level constants
     m.attr("EXP_BITS") = EXP_BITS;
     m.attr("MANT_BITS") = MANT_BITS;
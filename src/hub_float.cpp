@@ -174,57 +174,6 @@ hub_float::hub_float(uint32_t binary_value) {
     std::memcpy(&value, &double_bits, sizeof(value));
 }
 
-/*
-   Function: operator double
-   Converts a hub_float to a double.
-
-   Returns:
-       The internal value as a double.
-*/
-hub_float::operator double() const {
-    return value;
-}
-
-/*
-   Function: quantize
-   Quantizes a double to the nearest point on the hub grid.
-
-   Parameters:
-       d - The double value to quantize.
-
-   Returns:
-       The quantized double value.
-*/
-double hub_float::quantize(double d)
-{
-    double special_result;
-    return handle_special_cases(d, special_result) ? special_result : apply_hub_grid(d);
-}
-
-/*
-   Function: handle_special_cases
-   Handles special floating-point cases like NaN and infinity.
-
-   Parameters:
-       d - The input double value.
-       result - Output result for special cases.
-
-   Returns:
-       True if a special case was handled; false otherwise.
-*/
-inline bool hub_float::handle_special_cases(double d, double& result) {
-    const int category = std::fpclassify(d);
-    if (category == FP_INFINITE || category == FP_ZERO || d == 1.0 || d == -1.0) {
-        result = d;
-        return true;
-    }
-    if (category == FP_NAN || (std::abs(d) < lowestVal && d != 0.0 && d != -0.0))  {
-        result = handle_specials(d);
-        return true;
-    }
-    return false;
-}
-
 /*
     Function: is_on_grid
     Checks if a double value is already on the hub grid.
@@ -241,51 +190,6 @@ inline bool hub_float::is_on_grid(double d) {
     return (bits & ((1ULL << SHIFT) - 1)) == HUB_BIT;
 }
 
-/*
-    Function: apply_hub_grid
-    Applies the hub grid to a double value.
-
-    Parameters:
-        d - The double value to quantize.
-
-    Returns:
-        The quantized double value.
-*/
-inline double hub_float::apply_hub_grid(double d) {
-    uint64_t bits;
-
-
-    std::memcpy(&bits, &d, sizeof(d));
-
-    #if UNBIASED_ROUNDING
-        // Check if all the bits we are truncating are zeros
-        bool all_truncated_bits_zero = ((bits & ((1ULL << (SHIFT-1)) - 1)) == 0);
-        
-        if (all_truncated_bits_zero) {
-            // std::cout << "Unbiased rounding enabled" << std::endl;
-            uint64_t clear_mask = ~(1ULL << SHIFT);
-            bits = (bits & clear_mask) | HUB_BIT;
-        } else {
-            // Standard behavior - set HUB_BIT and clear all lower bits
-            bits = (bits & ~((1ULL << (SHIFT-1)) - 1)) | HUB_BIT;
-        }
-    #else
-        // Standard behavior - set HUB_BIT and clear all lower bits
-        bits = (bits & ~((1ULL << (SHIFT-1)) - 1)) | HUB_BIT;
-    #endif
-
-    std::memcpy(&d, &bits, sizeof(d));
-
-    if (d > maxVal){
-        return std::numeric_limits<double>::infinity();
-    } else if (d < minVal){
-        return -std::numeric_limits<double>::infinity();
-    }
-    
-    return d;
-}
-
-
 /*
     Function: handle_specials
     Handles special values like NaN and subnormal numbers.
@@ -502,28 +406,37 @@ std::string hub_float::toBinaryString() const {
        A string containing the hexadecimal representation of the number prefixed with "0x".
 */
 std::string hub_float::toHexString() const {
-    hub_float::BitFields fields = extractBitFields();
-    
-    // Pack components
     const int total_bits = 1 + EXP_BITS + MANT_BITS;
     const int hex_digits = (total_bits + 3) / 4; // Ceiling division
-    // Modify packing to use only required bits
-    const uint64_t packed = ((fields.sign & 0x1) << (EXP_BITS + MANT_BITS)) |
-    ((fields.custom_exp & ((1 << EXP_BITS)-1)) << MANT_BITS) |
-    (fields.custom_frac & ((1 << MANT_BITS)-1));
-
-    // Mask to only keep the bits we need to avoid sign extension issues
-    const uint64_t mask = (1ULL << total_bits) - 1;
-    const uint64_t masked_packed = packed & mask;
 
     // Format hex string
     std::ostringstream oss;
     oss << "0x" << std::hex << std::uppercase 
-        << std::setw(hex_digits) << std::setfill('0') << masked_packed;
+        << std::setw(hex_digits) << std::setfill('0') << toBits();
     
     return oss.str();
 }
 
+/*
+   Function: toBits
+   Packs a hub_float into its raw binary representation, using only the required bits.
+
+   Returns:
+       The sign, exponent and mantissa fields packed into the low 1 + EXP_BITS + MANT_BITS bits.
+*/
+uint64_t hub_float::toBits() const {
+    hub_float::BitFields fields = extractBitFields();
+
+    const int total_bits = 1 + EXP_BITS + MANT_BITS;
+    const uint64_t packed = (static_cast<uint64_t>(fields.sign & 0x1) << (EXP_BITS + MANT_BITS)) |
+    ((static_cast<uint64_t>(fields.custom_exp) & ((1ULL << EXP_BITS) - 1)) << MANT_BITS) |
+    (fields.custom_frac & ((1ULL << MANT_BITS) - 1));
+
+    // Mask to only keep the bits we need to avoid sign extension issues
+    const uint64_t mask = total_bits >= 64 ? ~0ULL : (1ULL << total_bits) - 1;
+    return packed & mask;
+}
+
 
 // -------------------------------------------------------------------
 // Non-member functions
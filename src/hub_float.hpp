@@ -10,6 +10,9 @@
 
 #include <iostream>
 #include <cstdint>  // For uint64_t
+#include <cmath>
+#include <cstring>
+#include <limits>
 
 
 
@@ -233,6 +236,16 @@ public:
    */
     std::string toHexString() const;
 
+   /*
+       Function: toBits
+       Pack the hub_float into its raw binary representation (sign, exponent, mantissa),
+       the inverse of the raw-bits constructor.
+
+       Returns:
+       The packed value in the low 1 + EXP_BITS + MANT_BITS bits.
+   */
+    uint64_t toBits() const;
+
    /*
        Friend Function: sqrt
        Square root function for hub_float.
@@ -273,12 +286,44 @@ public:
    */
     friend std::ostream& operator<<(std::ostream &os, const hub_float &hf);
 
+    /*
+        Friend: std::numeric_limits<hub_float>
+        Derives the exponent range from CUSTOM_BIAS.
+    */
+    friend class std::numeric_limits<hub_float>;
+
    /*
       Constant: lowestVal
-      Lowest representable negative value in hub_float format as a double.
+      Smallest representable positive value in hub_float format as a double.
    */
     static const double lowestVal;
 
+   /*
+      Constant: maxVal
+      Maximum representable value in hub_float format as a double.
+   */
+    static const double maxVal;
+
+   /*
+      Constant: minVal
+      Most negative representable value in hub_float format as a double.
+   */
+    static const double minVal;
+
+    /*
+        Function: quantize
+        Quantize a double result to the hub_float grid. The arithmetic operators round
+        their exact double result with this function, so kernels can keep intermediate
+        values in doubles and call it after every operation to get identical results.
+
+        Parameters:
+        d - The double value to quantize.
+
+        Returns:
+        The quantized double value.
+    */
+    static double quantize(double d);
+
 private:
     /*
         Variable: value
@@ -298,18 +343,6 @@ private:
     */
     static double float_to_hub(double d);
 
-    /*
-        Function: quantize
-        Quantize a double result to the hub_float grid.
-
-        Parameters:
-        d - The double value to quantize.
-
-        Returns:
-        The quantized double value.
-    */
-    static double quantize(double d);
-    
     /*
         Function: handle_special_cases
         Handle special cases in floating-point operations, such as NaN or infinities.
@@ -359,6 +392,18 @@ private:
     */   
     static double apply_hub_grid(double d);
 
+    /*
+        Function: grid_bits
+        Apply the hub grid to the bit pattern of a double value.
+
+        Parameters:
+        bits - The bit pattern to quantize.
+
+        Returns:
+        The quantized bit pattern.
+    */   
+    static uint64_t grid_bits(uint64_t bits);
+
     /*
        Constant: SHIFT
        Number of low-order bits in the double's mantissa that will be forced or cleared.
@@ -442,18 +487,14 @@ private:
     */
     static constexpr uint64_t minPosBits = (static_cast<uint64_t>(BIAS_DIFF) << 52) | doubleMinFrac;
 
-
     /*
-       Constant: maxVal
-       Maximum representable value in hub_float format as a double.
+       Constants: FAST_MIN_EXP, FAST_MAX_EXP
+       Range of IEEE double exponents for which quantize only needs to apply the grid:
+       values above the binade of lowestVal and below the binade of maxVal.
     */
-    static const double maxVal;
+    static constexpr uint64_t FAST_MIN_EXP = BIAS_DIFF + 1 > 1 ? BIAS_DIFF + 1 : 1;
+    static constexpr uint64_t FAST_MAX_EXP = doubleExp - 1 < 2046 ? doubleExp - 1 : 2046;
 
-    /*
-       Constant: minVal
-       Minimum representable positive value in hub_float format as a double.
-    */    
-    static const double minVal;
 
 };
 
@@ -469,4 +510,181 @@ private:
 */
 hub_float operator"" _hb(long double d);
 
+/*
+    Class: std::numeric_limits<hub_float>
+    Properties of the configured hub_float format, so that generic numerical code
+    (scaling thresholds, convergence tests) can be instantiated for hub_float.
+    epsilon is the spacing of the grid relative to the leading bit, 2^-MANT_BITS,
+    and round_error is 1/2 since every operation rounds to the nearest grid point.
+    Every exponent field encodes normal numbers, so min() lies in the binade
+    2^-CUSTOM_BIAS and max() in the binade 2^(2^EXP_BITS - 1 - CUSTOM_BIAS); there
+    are no subnormals, and results below min() are detected before rounding.
+    A NaN converts to an infinity of the same sign, so the format has no NaN and
+    quiet_NaN and signaling_NaN return zero, as for types without one.
+    The decimal digit counts use 30103/100000 as log10(2).
+*/
+namespace std {
+template <>
+class numeric_limits<hub_float> {
+public:
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool is_integer = false;
+    static constexpr bool is_exact = false;
+    static constexpr bool has_infinity = true;
+    static constexpr bool has_quiet_NaN = false;
+    static constexpr bool has_signaling_NaN = false;
+    static constexpr bool is_iec559 = false;
+    static constexpr bool is_bounded = true;
+    static constexpr bool is_modulo = false;
+    static constexpr int radix = 2;
+    static constexpr int digits = MANT_BITS + 1;
+    static constexpr int digits10 = (digits - 1) * 30103 / 100000;
+    static constexpr int max_digits10 = 2 + digits * 30103 / 100000;
+    static constexpr int min_exponent = 1 - hub_float::CUSTOM_BIAS;
+    static constexpr int max_exponent = (1 << EXP_BITS) - hub_float::CUSTOM_BIAS;
+    static constexpr int min_exponent10 = -((1 - min_exponent) * 30103 / 100000);
+    static constexpr int max_exponent10 = max_exponent * 30103 / 100000;
+    static constexpr float_denorm_style has_denorm = denorm_absent;
+    static constexpr bool has_denorm_loss = false;
+    static constexpr bool tinyness_before = true;
+    static constexpr bool traps = false;
+    static constexpr float_round_style round_style = round_to_nearest;
+
+    static hub_float min() noexcept { return hub_float(hub_float::lowestVal); }
+    static hub_float max() noexcept { return hub_float(hub_float::maxVal); }
+    static hub_float lowest() noexcept { return hub_float(hub_float::minVal); }
+    static hub_float epsilon() noexcept { return hub_float(std::ldexp(1.0, -MANT_BITS)); }
+    static hub_float round_error() noexcept { return hub_float(0.5); }
+    static hub_float infinity() noexcept { return hub_float(numeric_limits<double>::infinity()); }
+    static hub_float quiet_NaN() noexcept { return hub_float(); }
+    static hub_float signaling_NaN() noexcept { return hub_float(); }
+    static hub_float denorm_min() noexcept { return min(); }
+};
+} // namespace std
+
+// -------------------------------------------------------------------
+// Inline rounding path, shared by every arithmetic operation
+// -------------------------------------------------------------------
+
+/*
+   Function: operator double
+   Converts a hub_float to a double.
+
+   Returns:
+       The internal value as a double.
+*/
+inline hub_float::operator double() const {
+    return value;
+}
+
+/*
+   Function: quantize
+   Quantizes a double to the nearest point on the hub grid.
+
+   Parameters:
+       d - The double value to quantize.
+
+   Returns:
+       The quantized double value.
+*/
+inline double hub_float::quantize(double d)
+{
+    // Fast path: a normal value whose exponent lies strictly inside the hub_float
+    // range cannot be special, underflow or overflow, so only the grid is applied
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(d));
+    const uint64_t exp = (bits >> 52) & 0x7FF;
+    // (+-1.0 have their own encoding; compare the bits so no FP compare is needed)
+    if (exp - FAST_MIN_EXP <= FAST_MAX_EXP - FAST_MIN_EXP && (bits << 1) != (0x3FF0000000000000ULL << 1)) {
+        bits = grid_bits(bits);
+        std::memcpy(&d, &bits, sizeof(d));
+        return d;
+    }
+
+    double special_result;
+    return handle_special_cases(d, special_result) ? special_result : apply_hub_grid(d);
+}
+
+/*
+   Function: handle_special_cases
+   Handles special floating-point cases like NaN and infinity.
+
+   Parameters:
+       d - The input double value.
+       result - Output result for special cases.
+
+   Returns:
+       True if a special case was handled; false otherwise.
+*/
+inline bool hub_float::handle_special_cases(double d, double& result) {
+    const int category = std::fpclassify(d);
+    if (category == FP_INFINITE || category == FP_ZERO || d == 1.0 || d == -1.0) {
+        result = d;
+        return true;
+    }
+    if (category == FP_NAN || (std::abs(d) < lowestVal && d != 0.0 && d != -0.0))  {
+        result = handle_specials(d);
+        return true;
+    }
+    return false;
+}
+
+/*
+    Function: apply_hub_grid
+    Applies the hub grid to a double value.
+
+    Parameters:
+        d - The double value to quantize.
+
+    Returns:
+        The quantized double value.
+*/
+inline double hub_float::apply_hub_grid(double d) {
+    uint64_t bits;
+
+
+    std::memcpy(&bits, &d, sizeof(d));
+    bits = grid_bits(bits);
+    std::memcpy(&d, &bits, sizeof(d));
+
+    if (d > maxVal){
+        return std::numeric_limits<double>::infinity();
+    } else if (d < minVal){
+        return -std::numeric_limits<double>::infinity();
+    }
+    
+    return d;
+}
+
+/*
+    Function: grid_bits
+    Moves the bit pattern of a double onto the hub grid. The exponent is left unchanged.
+
+    Parameters:
+        bits - The bit pattern of the double value.
+
+    Returns:
+        The bit pattern of the value on the hub grid.
+*/
+inline uint64_t hub_float::grid_bits(uint64_t bits) {
+    #if UNBIASED_ROUNDING
+        // Check if all the bits we are truncating are zeros
+        bool all_truncated_bits_zero = ((bits & ((1ULL << (SHIFT-1)) - 1)) == 0);
+        
+        if (all_truncated_bits_zero) {
+            // std::cout << "Unbiased rounding enabled" << std::endl;
+            uint64_t clear_mask = ~(1ULL << SHIFT);
+            bits = (bits & clear_mask) | HUB_BIT;
+        } else {
+            // Standard behavior - set HUB_BIT and clear all lower bits
+            bits = (bits & ~((1ULL << (SHIFT-1)) - 1)) | HUB_BIT;
+        }
+    #else
+        // Standard behavior - set HUB_BIT and clear all lower bits
+        bits = (bits & ~((1ULL << (SHIFT-1)) - 1)) | HUB_BIT;
+    #endif
+    return bits;
+}
+
 #endif // HUB_FLOAT_HPP
@@ -3,9 +3,14 @@
 #include <vector>
 #include <memory>
 #include <functional>
+#include <random>
+#include <cmath>
+#include <cstring>
 #include "utils.hpp"
 #include "operation_tester.hpp"
 #include "hub_float.hpp"
+#include "../common/benchmark.hpp"
+#include "../common/counter_rng.hpp"
 
 static std::function<hub_float(const hub_float&, const hub_float&)> addition = 
     [](const hub_float& a, const hub_float& b) { return a + b; };
@@ -20,7 +25,84 @@ static std::function<hub_float(const hub_float&, const hub_float&, const hub_flo
         return fma(a,b,c);
     };
 
-int main() {
+// Throughput of the basic operations in each type over 4096-element arrays of
+// operands in [0.5, 2), one result per element and iteration
+template<typename T>
+void add_operation_benchmarks(BenchmarkHarness& harness, const char* type) {
+    const size_t n = 4096;
+    std::mt19937_64 gen(TestConfig::RANDOM_SEED);
+    std::uniform_real_distribution<double> dist(0.5, 2.0);
+    std::vector<T> a(n), b(n), c(n), r(n);
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = T(dist(gen));
+        b[i] = T(dist(gen));
+        c[i] = T(dist(gen));
+    }
+    using std::sqrt;
+    using std::fma;
+    harness.add("add", type, {}, [a, b, r]() mutable {
+        for (size_t i = 0; i < a.size(); ++i) r[i] = a[i] + b[i];
+        do_not_optimize(r[0]);
+    }, n);
+    harness.add("multiply", type, {}, [a, b, r]() mutable {
+        for (size_t i = 0; i < a.size(); ++i) r[i] = a[i] * b[i];
+        do_not_optimize(r[0]);
+    }, n);
+    harness.add("divide", type, {}, [a, b, r]() mutable {
+        for (size_t i = 0; i < a.size(); ++i) r[i] = a[i] / b[i];
+        do_not_optimize(r[0]);
+    }, n);
+    harness.add("sqrt", type, {}, [a, r]() mutable {
+        for (size_t i = 0; i < a.size(); ++i) r[i] = sqrt(a[i]);
+        do_not_optimize(r[0]);
+    }, n);
+    harness.add("fma", type, {}, [a, b, c, r]() mutable {
+        for (size_t i = 0; i < a.size(); ++i) r[i] = fma(a[i], b[i], c[i]);
+        do_not_optimize(r[0]);
+    }, n);
+    harness.add("convert from double", type, {}, [a, r]() mutable {
+        for (size_t i = 0; i < a.size(); ++i) r[i] = T(static_cast<double>(a[i]) * 1.25);
+        do_not_optimize(r[0]);
+    }, n);
+    // Test input generation: Philox values converted straight into the type
+    harness.add("random uniform fill", type, {}, [r, trial = uint64_t(0)]() mutable {
+        PhiloxRandom(TestConfig::RANDOM_SEED).fill_uniform(trial++, 0, r.size(), r.data(), 0.5, 2.0);
+        do_not_optimize(r[0]);
+    }, n);
+    harness.add("random normal fill", type, {}, [r, trial = uint64_t(0)]() mutable {
+        PhiloxRandom(TestConfig::RANDOM_SEED).fill_normal(trial++, 0, r.size(), r.data());
+        do_not_optimize(r[0]);
+    }, n);
+}
+
+int main(int argc, char* argv[]) {
+    // --bench times the operations through the benchmark harness instead;
+    // --threads sets how many threads evaluate the testbench cases
+    BenchmarkOptions bench_options;
+    bool usage = !bench_options.parse(argc, argv);
+    bool bench = false;
+    size_t threads = ThreadPool::default_threads();
+    for (int i = 1; i < argc && !usage; ++i) {
+        if (std::strcmp(argv[i], "--bench") == 0) {
+            bench = true;
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            usage = true;
+        }
+    }
+    if (usage) {
+        std::cerr << "Usage: " << argv[0] << " [--threads N] [--bench " << BenchmarkOptions::usage() << "]" << std::endl;
+        return 1;
+    }
+    if (bench) {
+        BenchmarkHarness harness("arithmetic_test", bench_options);
+        add_operation_benchmarks<float>(harness, "float");
+        add_operation_benchmarks<double>(harness, "double");
+        add_operation_benchmarks<hub_float>(harness, "hub_float");
+        harness.run();
+        return 0;
+    }
     std::cout << std::setprecision(50);
     Utils::clearScreen();
     std::cout << "=== Hub Float Operation Tester ===\n"
@@ -34,7 +116,9 @@ int main() {
     //testers.push_back(createTester("sqrt", squareRoot));
     //testers.push_back(createTester("fused_multiply_add", fused_multiply_add));
 
+    ThreadPool pool(threads);
     for (auto& tester : testers) {
+        tester->setThreadPool(&pool);
         tester->runTests();
         tester->runSpecialCaseTests();
     }
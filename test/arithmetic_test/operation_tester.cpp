@@ -6,6 +6,8 @@
 #include <limits> // Required for numeric_limits
 #include <iomanip> // Required for setprecision
 #include <optional> // Required for optional ofstream
+#include <array>
+#include <sstream>
 
 OperationTester::OperationTester(std::string opName) 
     : rng_(TestConfig::RANDOM_SEED), opName_(std::move(opName)) {}
@@ -192,115 +194,80 @@ void OperationTesterImpl<Operation, Type>::performTesting(const Args&... args) {
     std::cout << (useSampling ? "Using random sampling\n" : "Performing exhaustive testing\n");
 
     std::uniform_int_distribution<uint64_t> dist(0, maxValue - 1);
-    
+    constexpr size_t arity = Type == OpType::TERNARY ? 3 : (Type == OpType::BINARY ? 2 : 1);
+
     // --- Data Writing ---
-    if (!useSampling) {
-        // --- Exhaustive Testing ---
-        if constexpr (Type == OpType::TERNARY) {
-            for (uint64_t x = 0; x < maxValue; ++x) {
-                for (uint64_t y = 0; y < maxValue; ++y) {
-                    for (uint64_t z = 0; z < maxValue; ++z) {
-                        hub_float value1(static_cast<uint32_t>(x));
-                        hub_float value2(static_cast<uint32_t>(y));
-                        hub_float value3(static_cast<uint32_t>(z));
-                        hub_float result = operation_(value1, value2, value3);
-                        // Write Hex values
-                        outfile_hex << value1.toHexString().substr(2) << "," 
-                                    << value2.toHexString().substr(2) << "," 
-                                    << value3.toHexString().substr(2) << "," 
-                                    << result.toHexString().substr(2) << "\n";
-                        // Conditionally write Numeric values
-                        if (outfile_num) {
-                            *outfile_num << value1 << "," << value2 << "," << value3 << "," << result << "\n";
-                        }
-                        Utils::displayCalculation(value1, value2, value3, result);
-                        uint64_t progress = ((x * maxValue + y) * maxValue + z) + 1;
-                        Utils::showProgress(progress, totalCombinations, "Testing " + opName_);
-                    }
-                }
+    // Operand bit patterns of case i: for the exhaustive sweep the digits of i
+    // in base maxValue, the last operand varying fastest; for sampling, draws
+    // from rng_ in case order, which is why they are made serially
+    auto operands = [&](uint64_t i, std::array<uint32_t, 3>& bits) {
+        for (size_t k = 0; k < arity; ++k) {
+            if (useSampling) {
+                bits[k] = static_cast<uint32_t>(dist(rng_));
+            } else {
+                bits[arity - 1 - k] = static_cast<uint32_t>(i % maxValue);
+                i /= maxValue;
             }
-        } else if constexpr (Type == OpType::BINARY) {
-            for (uint64_t x = 0; x < maxValue; ++x) {
-                for (uint64_t y = 0; y < maxValue; ++y) {
-                    hub_float value1(static_cast<uint32_t>(x));
-                    hub_float value2(static_cast<uint32_t>(y));
-                    hub_float result = operation_(value1, value2);
-                    // Write Hex values
-                    outfile_hex << value1.toHexString().substr(2) << "," 
-                                << value2.toHexString().substr(2) << "," 
-                                << result.toHexString().substr(2) << "\n";
-                    // Conditionally write Numeric values
-                    if (outfile_num) {
-                        *outfile_num << value1 << "," << value2 << "," << result << "\n";
-                    }
-                    Utils::displayCalculation(value1, value2, result);
-                    Utils::showProgress(x * maxValue + y + 1, totalCombinations, "Testing " + opName_);
-                }
+        }
+    };
+
+    // Cases go in blocks: operands serially, then the operation and the row
+    // formatting on the pool, then the rows in order to the files
+    const uint64_t blockSize = 16384;
+    std::vector<std::array<hub_float, 3>> values(blockSize);
+    std::vector<hub_float> results(blockSize);
+    std::vector<std::string> hexRows(blockSize), numRows(blockSize);
+    auto evaluate = [&](size_t b, size_t e, size_t) {
+        std::ostringstream num;
+        num << std::setprecision(std::numeric_limits<long double>::max_digits10);
+        for (size_t i = b; i < e; ++i) {
+            const auto& v = values[i];
+            if constexpr (Type == OpType::TERNARY) results[i] = operation_(v[0], v[1], v[2]);
+            else if constexpr (Type == OpType::BINARY) results[i] = operation_(v[0], v[1]);
+            else results[i] = operation_(v[0]);
+
+            std::string& hex = hexRows[i];
+            hex.clear();
+            for (size_t k = 0; k < arity; ++k) {
+                hex += v[k].toHexString().substr(2) + ",";
             }
-        } else { // UNARY
-            for (uint64_t x = 0; x < maxValue; ++x) {
-                hub_float value1(static_cast<uint32_t>(x));
-                hub_float result = operation_(value1);
-                // Write Hex values
-                outfile_hex << value1.toHexString().substr(2) << "," 
-                            << result.toHexString().substr(2) << "\n";
-                // Conditionally write Numeric values
-                if (outfile_num) {
-                    *outfile_num << value1 << "," << result << "\n";
+            hex += results[i].toHexString().substr(2) + "\n";
+            if (outfile_num) {
+                num.str("");
+                for (size_t k = 0; k < arity; ++k) {
+                    num << v[k] << ",";
                 }
-                Utils::displayCalculation(value1, result);
-                Utils::showProgress(x + 1, totalCombinations, "Testing " + opName_);
+                num << results[i] << "\n";
+                numRows[i] = num.str();
             }
         }
-    } else { 
-        // --- Random Sampling ---
-        for (uint64_t i = 0; i < sampleSize; ++i) {
-            uint64_t x = dist(rng_);
-            hub_float value1(static_cast<uint32_t>(x));
-            hub_float result;
+    };
 
-            if constexpr (Type == OpType::TERNARY) {
-                uint64_t y = dist(rng_);
-                uint64_t z = dist(rng_);
-                hub_float value2(static_cast<uint32_t>(y));
-                hub_float value3(static_cast<uint32_t>(z));
-                result = operation_(value1, value2, value3);
-                // Write Hex values
-                outfile_hex << value1.toHexString().substr(2) << "," 
-                            << value2.toHexString().substr(2) << "," 
-                            << value3.toHexString().substr(2) << "," 
-                            << result.toHexString().substr(2) << "\n";
-                // Conditionally write Numeric values
-                if (outfile_num) {
-                    *outfile_num << value1 << "," << value2 << "," << value3 << "," << result << "\n";
-                }
-                Utils::displayCalculation(value1, value2, value3, result);
-            } else if constexpr (Type == OpType::BINARY) {
-                uint64_t y = dist(rng_);
-                hub_float value2(static_cast<uint32_t>(y));
-                result = operation_(value1, value2);
-                // Write Hex values
-                outfile_hex << value1.toHexString().substr(2) << "," 
-                            << value2.toHexString().substr(2) << "," 
-                            << result.toHexString().substr(2) << "\n";
-                // Conditionally write Numeric values
-                if (outfile_num) {
-                    *outfile_num << value1 << "," << value2 << "," << result << "\n";
-                }
-                Utils::displayCalculation(value1, value2, result);
-            } else { // UNARY
-                result = operation_(value1);
-                // Write Hex values
-                outfile_hex << value1.toHexString().substr(2) << "," 
-                            << result.toHexString().substr(2) << "\n";
-                // Conditionally write Numeric values
-                if (outfile_num) {
-                    *outfile_num << value1 << "," << result << "\n";
-                }
-                Utils::displayCalculation(value1, result);
+    std::array<uint32_t, 3> bits{};
+    for (uint64_t first = 0; first < sampleSize; first += blockSize) {
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(blockSize, sampleSize - first));
+        for (size_t i = 0; i < count; ++i) {
+            operands(first + i, bits);
+            for (size_t k = 0; k < arity; ++k) {
+                values[i][k] = hub_float(bits[k]);
+            }
+        }
+        if (pool_ != nullptr) {
+            pool_->parallel_for(0, count, 256, evaluate);
+        } else {
+            evaluate(0, count, 0);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            outfile_hex << hexRows[i];
+            if (outfile_num) {
+                *outfile_num << numRows[i];
             }
-            Utils::showProgress(i + 1, sampleSize, "Testing " + opName_);
+            const auto& v = values[i];
+            if constexpr (Type == OpType::TERNARY) Utils::displayCalculation(v[0], v[1], v[2], results[i]);
+            else if constexpr (Type == OpType::BINARY) Utils::displayCalculation(v[0], v[1], results[i]);
+            else Utils::displayCalculation(v[0], results[i]);
         }
+        Utils::showProgress(first + count, sampleSize, "Testing " + opName_);
     }
 
     // --- Cleanup ---
@@ -10,11 +10,13 @@
 #include "hub_float.hpp"
 #include "test_config.hpp"
 #include "utils.hpp"
+#include "../common/thread_pool.hpp"
 
 class OperationTester {
 protected:
     std::mt19937_64 rng_{TestConfig::RANDOM_SEED};
     std::string opName_;
+    ThreadPool* pool_ = nullptr;
 
     std::vector<std::pair<hub_float, std::string>> getSpecialValues() const;
 
@@ -26,6 +28,10 @@ public:
     virtual void runSpecialCaseTests() = 0;
 
     const std::string& getName() const;
+
+    // Evaluates and formats the cases on the pool; the files are written in
+    // case order, so they are the same as with no pool
+    void setThreadPool(ThreadPool* pool) { pool_ = pool; }
 };
 
 // Enum to define operation type
@@ -0,0 +1,456 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "hub_float.hpp"
+#include "perf_counters.hpp"
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+// The Makefile generates build_info.h with the git revision and the flags of
+// the build; without it the harness reports them as unknown
+#if defined(__has_include)
+#if __has_include("build_info.h")
+#include "build_info.h"
+#endif
+#endif
+#ifndef HUB_BUILD_GIT_HASH
+#define HUB_BUILD_GIT_HASH "unknown"
+#endif
+#ifndef HUB_BUILD_CXXFLAGS
+#define HUB_BUILD_CXXFLAGS "unknown"
+#endif
+
+// Keeps the compiler from optimizing away a value computed by a benchmark case
+template<typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+struct BenchmarkOptions {
+    size_t warmup_runs = 2;        // Untimed runs, the first of which calibrates the iteration count
+    size_t runs = 15;              // Timed runs per case
+    double min_run_seconds = 0.005; // Each run repeats the case until it takes at least this long
+    int pin_cpu = -1;              // CPU to pin the process to, or -1 to leave it alone
+    std::string output;            // JSON-lines file to append to; by default <program>_bench_<time>.jsonl
+    std::string filter;            // Run only the cases whose name or type contains this
+    bool counters = false;         // Count hardware events over the timed runs
+
+    // Takes the harness options out of argv, leaving the program's own ones;
+    // returns false if one of them is missing its value
+    bool parse(int& argc, char* argv[]) {
+        static const char* const names[] = {"--bench-runs", "--bench-warmup", "--bench-min-time",
+                                            "--bench-pin", "--bench-out", "--bench-filter"};
+        int kept = 1;
+        bool ok = true;
+        for (int i = 1; i < argc; ++i) {
+            if (std::strcmp(argv[i], "--bench-counters") == 0) {
+                counters = true;
+                continue;
+            }
+            size_t option = 0;
+            while (option < 6 && std::strcmp(argv[i], names[option]) != 0) {
+                ++option;
+            }
+            if (option == 6) {
+                argv[kept++] = argv[i];
+                continue;
+            }
+            if (i + 1 >= argc) {
+                ok = false;
+                break;
+            }
+            const char* value = argv[++i];
+            switch (option) {
+            case 0: runs = std::max<size_t>(std::strtoul(value, nullptr, 10), 1); break;
+            case 1: warmup_runs = std::strtoul(value, nullptr, 10); break;
+            case 2: min_run_seconds = std::strtod(value, nullptr); break;
+            case 3: pin_cpu = std::atoi(value); break;
+            case 4: output = value; break;
+            default: filter = value; break;
+            }
+        }
+        argc = kept;
+        return ok;
+    }
+
+    static const char* usage() {
+        return "[--bench-runs N] [--bench-warmup N] [--bench-min-time SECONDS] [--bench-pin CPU] "
+               "[--bench-out FILE] [--bench-filter TEXT] [--bench-counters]";
+    }
+};
+
+// Timing of one case: per-iteration times of the timed runs, in seconds
+struct BenchmarkResult {
+    std::string name;
+    std::string type;
+    std::vector<std::pair<std::string, double>> params;
+    double items = 1.0;             // Work items (elements, flops, images) per iteration
+    size_t iterations = 1;          // Iterations per run
+    std::vector<double> seconds;    // Sorted
+    // Hardware event counts per iteration, indexed by PerfEvent; empty if not
+    // counted, NaN for the events the machine could not count
+    std::vector<double> counters;
+
+    double percentile(double p) const {
+        if (seconds.empty()) {
+            return 0.0;
+        }
+        const double pos = p / 100.0 * static_cast<double>(seconds.size() - 1);
+        const size_t lo = static_cast<size_t>(pos);
+        const size_t hi = std::min(lo + 1, seconds.size() - 1);
+        return seconds[lo] + (pos - static_cast<double>(lo)) * (seconds[hi] - seconds[lo]);
+    }
+    double median() const { return percentile(50.0); }
+    double mean() const {
+        double sum = 0.0;
+        for (double s : seconds) {
+            sum += s;
+        }
+        return seconds.empty() ? 0.0 : sum / static_cast<double>(seconds.size());
+    }
+    double items_per_second() const { return median() > 0.0 ? items / median() : 0.0; }
+
+    double counter(PerfEvent e) const {
+        return counters.empty() ? std::numeric_limits<double>::quiet_NaN() : counters[static_cast<size_t>(e)];
+    }
+    // Instructions per cycle; NaN unless both were counted
+    double ipc() const { return counter(PerfEvent::Instructions) / counter(PerfEvent::Cycles); }
+};
+
+// Shared timing harness of the test programs. Cases are registered with add()
+// and timed by run(): after warm-up runs, the first of which sets how many
+// iterations make up a run of at least min_run_seconds, every case is timed
+// over `runs` runs and reported by its median and 10th/90th percentile time
+// per iteration. Results are printed as a table and appended as JSON lines,
+// one object per case, together with the hub_float format, the rounding
+// policy, the compiler, the build flags and the git revision, so that runs of
+// different builds and releases can be compared. With the counters option the
+// timed runs of each add() case are also measured with PerfCounters, and the
+// per-iteration event counts, IPC and per-item miss rates are reported with
+// the times; counters the machine lacks are reported as unavailable.
+//
+//   BenchmarkHarness harness("fft", options);
+//   harness.add("fft", "float", {{"n", 1024}}, [&] { ... }, 1024);
+//   harness.run();
+class BenchmarkHarness {
+public:
+    using Params = std::vector<std::pair<std::string, double>>;
+
+    explicit BenchmarkHarness(std::string program, BenchmarkOptions options = BenchmarkOptions())
+        : program_(std::move(program)), options_(std::move(options)) {
+        if (options_.output.empty()) {
+            options_.output = program_ + "_bench_" + timestamp("%Y%m%d_%H%M%S") + ".jsonl";
+        }
+    }
+
+    // Registers fn, which does `items` units of work per call
+    void add(const std::string& name, const std::string& type, Params params, std::function<void()> fn,
+             double items = 1.0) {
+        BenchmarkResult result;
+        result.name = name;
+        result.type = type;
+        result.params = std::move(params);
+        result.items = items;
+        cases_.push_back({std::move(result), std::move(fn)});
+    }
+
+    // Records a case timed by the caller, from per-iteration times of its runs
+    void add_samples(const std::string& name, const std::string& type, Params params,
+                     std::vector<double> seconds, size_t iterations, double items = 1.0) {
+        BenchmarkResult result;
+        result.name = name;
+        result.type = type;
+        result.params = std::move(params);
+        result.items = items;
+        result.iterations = iterations;
+        result.seconds = std::move(seconds);
+        std::sort(result.seconds.begin(), result.seconds.end());
+        cases_.push_back({std::move(result), nullptr});
+    }
+
+    // Times the registered cases in order, prints them and writes the JSON lines
+    void run() {
+        pinned_cpu_ = pin(options_.pin_cpu);
+        if (options_.counters) {
+            counters_.reset(new PerfCounters());
+            if (!counters_->any_available()) {
+                std::cerr << "Hardware counters unavailable (" << counters_->error() << "), reporting times only"
+                          << std::endl;
+            }
+        }
+        print_header();
+        std::ofstream out(options_.output, std::ios::app);
+        if (!out.is_open()) {
+            std::cerr << "Failed to open file: " << options_.output << std::endl;
+        }
+        for (auto& c : cases_) {
+            if (!matches(c.result)) {
+                continue;
+            }
+            if (c.fn) {
+                time_case(c.fn, c.result);
+            }
+            print_row(c.result);
+            if (out.is_open()) {
+                out << json(c.result) << "\n";
+            }
+            results_.push_back(c.result);
+        }
+        if (out.is_open()) {
+            std::cout << "\nBenchmark results appended to " << options_.output << std::endl;
+        }
+    }
+
+    const std::vector<BenchmarkResult>& results() const { return results_; }
+    const BenchmarkOptions& options() const { return options_; }
+
+    static const char* rounding_policy() {
+#if defined(UNBIASED_ROUNDING) && UNBIASED_ROUNDING
+        return "hub-unbiased";
+#else
+        return "hub";
+#endif
+    }
+
+private:
+    struct Case {
+        BenchmarkResult result;
+        std::function<void()> fn;
+    };
+
+    bool matches(const BenchmarkResult& r) const {
+        return options_.filter.empty() || r.name.find(options_.filter) != std::string::npos ||
+               r.type.find(options_.filter) != std::string::npos;
+    }
+
+    void time_case(const std::function<void()>& fn, BenchmarkResult& result) {
+        using Clock = std::chrono::steady_clock;
+        auto timed = [&](size_t iterations) {
+            const auto start = Clock::now();
+            for (size_t i = 0; i < iterations; ++i) {
+                fn();
+            }
+            return std::chrono::duration<double>(Clock::now() - start).count();
+        };
+
+        // Calibrate: grow the iteration count until a run is long enough
+        size_t iterations = 1;
+        for (;;) {
+            const double seconds = timed(iterations);
+            if (seconds >= options_.min_run_seconds || iterations >= (size_t(1) << 30)) {
+                break;
+            }
+            const double scale = seconds > 0.0 ? 1.2 * options_.min_run_seconds / seconds : 10.0;
+            iterations = static_cast<size_t>(static_cast<double>(iterations) * std::min(std::max(scale, 2.0), 100.0));
+        }
+        for (size_t w = 1; w < options_.warmup_runs; ++w) {
+            timed(iterations);
+        }
+
+        result.iterations = iterations;
+        result.seconds.clear();
+        if (counters_) {
+            counters_->start();
+        }
+        for (size_t r = 0; r < options_.runs; ++r) {
+            result.seconds.push_back(timed(iterations) / static_cast<double>(iterations));
+        }
+        if (counters_) {
+            counters_->stop();
+            const double calls = static_cast<double>(iterations * options_.runs);
+            result.counters.assign(PerfCounters::event_count, std::numeric_limits<double>::quiet_NaN());
+            for (size_t e = 0; e < PerfCounters::event_count; ++e) {
+                if (counters_->available(static_cast<PerfEvent>(e))) {
+                    result.counters[e] = counters_->value(static_cast<PerfEvent>(e)) / calls;
+                }
+            }
+        }
+        std::sort(result.seconds.begin(), result.seconds.end());
+    }
+
+    static int pin(int cpu) {
+        if (cpu < 0) {
+            return -1;
+        }
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) == 0) {
+            return cpu;
+        }
+#endif
+        std::cerr << "Could not pin to CPU " << cpu << ", running unpinned" << std::endl;
+        return -1;
+    }
+
+    static std::string timestamp(const char* format) {
+        std::time_t now = std::time(nullptr);
+        std::tm tm_now{};
+#ifdef _WIN32
+        localtime_s(&tm_now, &now);
+#else
+        localtime_r(&now, &tm_now);
+#endif
+        char buffer[32];
+        std::strftime(buffer, sizeof(buffer), format, &tm_now);
+        return buffer;
+    }
+
+    static std::string compiler() {
+#if defined(__clang__)
+        return "clang " __clang_version__;
+#elif defined(__GNUC__)
+        return "gcc " __VERSION__;
+#else
+        return "unknown";
+#endif
+    }
+
+    static std::string quoted(const std::string& s) {
+        std::string q = "\"";
+        for (char c : s) {
+            if (c == '"' || c == '\\') {
+                q += '\\';
+                q += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                q += buffer;
+            } else {
+                q += c;
+            }
+        }
+        return q + "\"";
+    }
+
+    std::string json(const BenchmarkResult& r) const {
+        std::ostringstream s;
+        s << std::setprecision(9);
+        s << "{\"program\":" << quoted(program_) << ",\"case\":" << quoted(r.name) << ",\"type\":" << quoted(r.type)
+          << ",\"params\":{";
+        for (size_t i = 0; i < r.params.size(); ++i) {
+            s << (i ? "," : "") << quoted(r.params[i].first) << ":" << r.params[i].second;
+        }
+        s << "},\"exp_bits\":" << EXP_BITS << ",\"mant_bits\":" << MANT_BITS
+          << ",\"rounding\":" << quoted(rounding_policy())
+          << ",\"compiler\":" << quoted(compiler()) << ",\"flags\":" << quoted(HUB_BUILD_CXXFLAGS)
+          << ",\"git\":" << quoted(HUB_BUILD_GIT_HASH)
+          << ",\"time\":" << quoted(timestamp("%Y-%m-%dT%H:%M:%S")) << ",\"cpu\":" << pinned_cpu_
+          << ",\"runs\":" << r.seconds.size() << ",\"iterations\":" << r.iterations << ",\"items\":" << r.items
+          << ",\"median_s\":" << r.median() << ",\"p10_s\":" << r.percentile(10.0) << ",\"p90_s\":" << r.percentile(90.0)
+          << ",\"min_s\":" << (r.seconds.empty() ? 0.0 : r.seconds.front()) << ",\"mean_s\":" << r.mean()
+          << ",\"items_per_s\":" << r.items_per_second();
+        if (!r.counters.empty()) {
+            s << ",\"counters\":{";
+            for (size_t e = 0; e < r.counters.size(); ++e) {
+                s << (e ? "," : "") << quoted(PerfCounters::name(static_cast<PerfEvent>(e))) << ":"
+                  << json_number(r.counters[e]);
+            }
+            s << ",\"ipc\":" << json_number(r.ipc()) << "}";
+        }
+        s << "}";
+        return s.str();
+    }
+
+    // JSON has no NaN; unavailable values are written as null
+    static std::string json_number(double x) {
+        if (!std::isfinite(x)) {
+            return "null";
+        }
+        std::ostringstream s;
+        s << std::setprecision(9) << x;
+        return s.str();
+    }
+
+    void print_header() const {
+        std::cout << "\n===== " << program_ << " benchmarks (E" << EXP_BITS << "M" << MANT_BITS << ", "
+                  << rounding_policy() << ", git " << HUB_BUILD_GIT_HASH << ") =====" << std::endl;
+        std::cout << std::left << std::setw(36) << "case" << " " << std::setw(10) << "type" << std::right
+                  << std::setw(13) << "median" << std::setw(13) << "p10" << std::setw(13) << "p90"
+                  << std::setw(14) << "items/s";
+        if (counters_ && counters_->any_available()) {
+            std::cout << std::setw(7) << "IPC" << std::setw(15) << "br-miss/item" << std::setw(15) << "L1D-miss/item"
+                      << std::setw(15) << "LLC-miss/item";
+        }
+        std::cout << std::endl;
+    }
+
+    static std::string format_counter(double x) {
+        if (!std::isfinite(x)) {
+            return "-";
+        }
+        std::ostringstream o;
+        o << std::setprecision(3) << x;
+        return o.str();
+    }
+
+    static std::string format_seconds(double s) {
+        std::ostringstream o;
+        o << std::setprecision(4);
+        if (s < 1e-6) {
+            o << s * 1e9 << " ns";
+        } else if (s < 1e-3) {
+            o << s * 1e6 << " us";
+        } else if (s < 1.0) {
+            o << s * 1e3 << " ms";
+        } else {
+            o << s << " s";
+        }
+        return o.str();
+    }
+
+    void print_row(const BenchmarkResult& r) const {
+        std::string name = r.name;
+        for (const auto& p : r.params) {
+            std::ostringstream o;
+            o << " " << p.first << "=" << p.second;
+            name += o.str();
+        }
+        std::cout << std::left << std::setw(36) << name << " " << std::setw(10) << r.type << std::right
+                  << std::setw(13) << format_seconds(r.median()) << std::setw(13) << format_seconds(r.percentile(10.0))
+                  << std::setw(13) << format_seconds(r.percentile(90.0))
+                  << std::setw(14) << std::defaultfloat << std::setprecision(4) << r.items_per_second();
+        if (counters_ && counters_->any_available()) {
+            auto per_item = [&](PerfEvent e) { return r.counter(e) / r.items; };
+            std::cout << std::setw(7) << format_counter(r.ipc())
+                      << std::setw(15) << format_counter(per_item(PerfEvent::BranchMisses))
+                      << std::setw(15) << format_counter(per_item(PerfEvent::L1DMisses))
+                      << std::setw(15) << format_counter(per_item(PerfEvent::LLCMisses));
+        }
+        std::cout << std::endl;
+    }
+
+    std::string program_;
+    BenchmarkOptions options_;
+    std::vector<Case> cases_;
+    std::vector<BenchmarkResult> results_;
+    int pinned_cpu_ = -1;
+    std::unique_ptr<PerfCounters> counters_;
+};
+
+#endif // BENCHMARK_HPP
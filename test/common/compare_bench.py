@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+"""Compares benchmark harness results (test/common/benchmark.hpp) of builds.
+
+    python3 compare_bench.py base=configs/E8M23/bench.jsonl lto=configs/E8M23-lto/bench.jsonl ...
+
+The first file is the baseline. Cases are matched on program, case, type and
+parameters; for each one the median time per call of every build is printed
+with its speed-up over the baseline, followed by the geometric mean speed-up
+of each build over the cases it shares with the baseline.
+"""
+
+import json
+import math
+import sys
+
+
+def load(path):
+    results = {}
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if not line:
+                continue
+            r = json.loads(line)
+            params = " ".join("%s=%g" % (k, v) for k, v in r["params"].items())
+            key = (r["program"], (r["case"] + " " + params).strip(), r["type"])
+            # A repeated case keeps its last run
+            results[key] = r["median_s"]
+    return results
+
+
+def format_seconds(s):
+    for scale, unit in ((1.0, "s"), (1e-3, "ms"), (1e-6, "us")):
+        if s >= scale:
+            return "%.4g %s" % (s / scale, unit)
+    return "%.4g ns" % (s * 1e9)
+
+
+def main(argv):
+    if len(argv) < 2 or any("=" not in a for a in argv):
+        sys.stderr.write("Usage: compare_bench.py NAME=FILE.jsonl [NAME=FILE.jsonl ...]\n")
+        return 1
+    builds = [a.split("=", 1) for a in argv]
+    results = [load(path) for _, path in builds]
+    base = results[0]
+
+    header = "%-14s %-36s %-10s" % ("program", "case", "type")
+    for name, _ in builds:
+        header += " %22s" % name
+    print(header)
+    log_speedups = [[] for _ in builds]
+    for key in sorted(base):
+        row = "%-14s %-36s %-10s" % key
+        for i, r in enumerate(results):
+            if key not in r or r[key] <= 0.0:
+                row += " %22s" % "-"
+                continue
+            speedup = base[key] / r[key]
+            log_speedups[i].append(math.log(speedup))
+            row += " %22s" % ("%s (%.2fx)" % (format_seconds(r[key]), speedup))
+        print(row)
+
+    print()
+    for (name, _), logs in zip(builds, log_speedups):
+        if logs:
+            print("%-14s geometric mean speed-up %.3fx over %d cases"
+                  % (name, math.exp(sum(logs) / len(logs)), len(logs)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
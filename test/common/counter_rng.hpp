@@ -0,0 +1,169 @@
+#ifndef COUNTER_RNG_HPP
+#define COUNTER_RNG_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3",
+// SC 2011): a counter-based generator whose output for a 128-bit counter under
+// a 64-bit key is ten rounds of a keyed bijection, with no state carried from
+// one value to the next. PhiloxRandom keys it with a seed and uses (trial,
+// index) as the counter, so the value at (seed, trial, index) is computed
+// directly: inputs generated in parallel, in any order or in any partition are
+// the same as those generated serially.
+//
+//   PhiloxRandom random(seed);
+//   double u = random.uniform(trial, i);                 // one value
+//   random.fill_uniform(trial, 0, n, x.data(), -1.0, 1.0); // x[i] as uniform(trial, i), scaled
+//   pool.parallel_for(0, n, 4096, [&](size_t b, size_t e, size_t) {
+//       random.fill_normal(trial, b, e - b, &y[b]);       // same y for any pool
+//   });
+//
+// The fills work on blocks of kLanes counters in plain loops over arrays, which
+// the compiler turns into SIMD code, and take any element type constructible
+// from double, hub_float included, converting each value once.
+class PhiloxRandom {
+public:
+    static const size_t kLanes = 8;
+
+    explicit PhiloxRandom(uint64_t seed)
+        : key0_(static_cast<uint32_t>(seed)), key1_(static_cast<uint32_t>(seed >> 32)) {}
+
+    // The four 32-bit words for (trial, index)
+    void block(uint64_t trial, uint64_t index, uint32_t out[4]) const {
+        uint32_t c0[kLanes], c1[kLanes], c2[kLanes], c3[kLanes];
+        c0[0] = static_cast<uint32_t>(index);
+        c1[0] = static_cast<uint32_t>(index >> 32);
+        c2[0] = static_cast<uint32_t>(trial);
+        c3[0] = static_cast<uint32_t>(trial >> 32);
+        rounds<1>(c0, c1, c2, c3);
+        out[0] = c0[0];
+        out[1] = c1[0];
+        out[2] = c2[0];
+        out[3] = c3[0];
+    }
+
+    uint64_t bits(uint64_t trial, uint64_t index) const {
+        uint32_t w[4];
+        block(trial, index, w);
+        return join(w[0], w[1]);
+    }
+
+    // Uniform in [0, 1) with 53 random bits
+    double uniform(uint64_t trial, uint64_t index) const {
+        uint32_t w[4];
+        block(trial, index, w);
+        return to_unit(join(w[0], w[1]));
+    }
+
+    // Standard normal, by the Box-Muller transform of the two halves of the block
+    double normal(uint64_t trial, uint64_t index) const {
+        uint32_t w[4];
+        block(trial, index, w);
+        return box_muller(join(w[0], w[1]), join(w[2], w[3]));
+    }
+
+    // out[k] = lo + (hi - lo) * uniform(trial, first + k) for k < n
+    template<typename T>
+    void fill_uniform(uint64_t trial, uint64_t first, size_t n, T* out, double lo = 0.0, double hi = 1.0) const {
+        fill(trial, first, n, out, [lo, hi](uint64_t a, uint64_t) { return lo + (hi - lo) * to_unit(a); });
+    }
+
+    // out[k] = mean + sd * normal(trial, first + k) for k < n
+    template<typename T>
+    void fill_normal(uint64_t trial, uint64_t first, size_t n, T* out, double mean = 0.0, double sd = 1.0) const {
+        fill(trial, first, n, out, [mean, sd](uint64_t a, uint64_t b) { return mean + sd * box_muller(a, b); });
+    }
+
+    // [0, 1) from the top 53 bits
+    static double to_unit(uint64_t x) { return static_cast<double>(x >> 11) * 0x1.0p-53; }
+
+private:
+    static uint64_t join(uint32_t lo, uint32_t hi) { return static_cast<uint64_t>(hi) << 32 | lo; }
+
+    static double box_muller(uint64_t a, uint64_t b) {
+        const double u1 = static_cast<double>((a >> 11) + 1) * 0x1.0p-53; // (0, 1], so the log is finite
+        const double u2 = to_unit(b);
+        return std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+    }
+
+    // Ten Philox rounds on `lanes` counters held as four word arrays
+    template<size_t lanes>
+    void rounds(uint32_t* c0, uint32_t* c1, uint32_t* c2, uint32_t* c3) const {
+        uint32_t k0 = key0_, k1 = key1_;
+        for (int r = 0; r < 10; ++r) {
+            for (size_t l = 0; l < lanes; ++l) {
+                const uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * c0[l];
+                const uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * c2[l];
+                const uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1[l] ^ k0;
+                const uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3[l] ^ k1;
+                c1[l] = static_cast<uint32_t>(p1);
+                c3[l] = static_cast<uint32_t>(p0);
+                c0[l] = n0;
+                c2[l] = n2;
+            }
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+    }
+
+    template<typename T, typename Transform>
+    void fill(uint64_t trial, uint64_t first, size_t n, T* out, Transform transform) const {
+        uint32_t c0[kLanes], c1[kLanes], c2[kLanes], c3[kLanes];
+        double values[kLanes];
+        for (size_t k = 0; k < n; k += kLanes) {
+            for (size_t l = 0; l < kLanes; ++l) {
+                const uint64_t index = first + k + l;
+                c0[l] = static_cast<uint32_t>(index);
+                c1[l] = static_cast<uint32_t>(index >> 32);
+                c2[l] = static_cast<uint32_t>(trial);
+                c3[l] = static_cast<uint32_t>(trial >> 32);
+            }
+            rounds<kLanes>(c0, c1, c2, c3);
+            for (size_t l = 0; l < kLanes; ++l) {
+                values[l] = transform(join(c0[l], c1[l]), join(c2[l], c3[l]));
+            }
+            const size_t count = n - k < kLanes ? n - k : kLanes;
+            for (size_t l = 0; l < count; ++l) {
+                out[k + l] = static_cast<T>(values[l]);
+            }
+        }
+    }
+
+    uint32_t key0_, key1_;
+};
+
+// Random bit generator over one Philox stream, for the <random> distributions:
+// output k of stream `stream` under `seed` is PhiloxRandom(seed).bits(stream, k).
+// Giving every trial (or sample) its own stream makes the values it draws
+// independent of which thread runs it and of the order the trials run in.
+//
+//   pool.parallel_for(0, trials, 64, [&](size_t b, size_t e, size_t) {
+//       for (size_t trial = b; trial < e; ++trial) {
+//           CounterRng rng(seed, trial);
+//           double x = std::uniform_real_distribution<double>(-1.0, 1.0)(rng);
+//           ...
+class CounterRng {
+public:
+    using result_type = uint64_t;
+
+    CounterRng(uint64_t seed, uint64_t stream) : random_(seed), stream_(stream) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() { return random_.bits(stream_, counter_++); }
+
+    void discard(uint64_t n) { counter_ += n; }
+    // Outputs drawn so far, which is also the index of the next one
+    uint64_t counter() const { return counter_; }
+
+private:
+    PhiloxRandom random_;
+    uint64_t stream_;
+    uint64_t counter_ = 0;
+};
+
+#endif // COUNTER_RNG_HPP
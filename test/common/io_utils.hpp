@@ -73,6 +73,7 @@ inline void write_csv(
     const std::string& filename,
     const std::string& data_dir,
     const std::vector<size_t>& matrix_sizes,
+    const std::vector<double>& condition_numbers,
     const std::vector<std::vector<ErrorStats>>& float_trials,
     const std::vector<std::vector<ErrorStats>>& hub_trials,
     const std::vector<ErrorStats>& float_summary,
@@ -88,17 +89,18 @@ inline void write_csv(
     }
 
     // Write header
-    outFile << "Matrix Size,Type,Trial,Average Error,Max Error,Min Error,"
+    outFile << "Matrix Size,Condition Number,Type,Trial,Average Error,Max Error,Min Error,"
             << "Relative Error,Variance,SNR,Signed Average Error,MSE,RMSE,"
             << "Matrix File,B Vector File,X Ref File" << std::endl;
 
     // Write trial data
     for (size_t i = 0; i < matrix_sizes.size(); ++i) {
         size_t size = matrix_sizes[i];
+        double cond = condition_numbers[i];
         
         for (size_t j = 0; j < float_trials[i].size(); ++j) {
             const auto& stats = float_trials[i][j];
-            outFile << size << ",float," << j << ","
+            outFile << size << "," << cond << ",float," << j << ","
                     << stats.avg_error << ","
                     << stats.max_error << ","
                     << stats.min_error << ","
@@ -115,7 +117,7 @@ inline void write_csv(
         
         for (size_t j = 0; j < hub_trials[i].size(); ++j) {
             const auto& stats = hub_trials[i][j];
-            outFile << size << ",hub_float," << j << ","
+            outFile << size << "," << cond << ",hub_float," << j << ","
                     << stats.avg_error << ","
                     << stats.max_error << ","
                     << stats.min_error << ","
@@ -133,14 +135,15 @@ inline void write_csv(
     
     // Write summary section
     outFile << std::endl << "SUMMARY" << std::endl;
-    outFile << "Matrix Size,Type,Average Error,Max Error,Min Error,"
+    outFile << "Matrix Size,Condition Number,Type,Average Error,Max Error,Min Error,"
             << "Relative Error,Variance,SNR,Signed Average Error,MSE,RMSE" << std::endl;
             
     for (size_t i = 0; i < matrix_sizes.size(); ++i) {
         size_t size = matrix_sizes[i];
+        double cond = condition_numbers[i];
         
         const auto& float_stats = float_summary[i];
-        outFile << size << ",float,"
+        outFile << size << "," << cond << ",float,"
                 << float_stats.avg_error << ","
                 << float_stats.max_error << ","
                 << float_stats.min_error << ","
@@ -152,7 +155,7 @@ inline void write_csv(
                 << float_stats.rmse << std::endl;
                 
         const auto& hub_stats = hub_summary[i];
-        outFile << size << ",hub_float,"
+        outFile << size << "," << cond << ",hub_float,"
                 << hub_stats.avg_error << ","
                 << hub_stats.max_error << ","
                 << hub_stats.min_error << ","
@@ -171,7 +174,7 @@ inline void write_csv(
         double mse_improvement = float_stats.mse / hub_stats.mse;
         double rmse_improvement = float_stats.rmse / hub_stats.rmse;
         
-        outFile << size << ",improvement,"
+        outFile << size << "," << cond << ",improvement,"
                 << avg_error_improvement << ",,,"
                 << rel_error_improvement << ","
                 << var_improvement << ","
@@ -1,39 +1,43 @@
 #ifndef MATRIX_HPP
 #define MATRIX_HPP
 
+#include <iostream>
 #include <vector>
 #include <stdexcept>
-#include <random>
+#include <cstdint>
+#include <cmath>
+#include <utility>
+#include "counter_rng.hpp"
+#include "matrix_view.hpp"
 
 // Template class for matrix operations with different numeric types
 template<typename T>
 class Matrix {
 private:
     size_t rows, cols;
-    std::vector<T> data;
+    std::vector<T> values;
 
 public:
-    Matrix(size_t r, size_t c) : rows(r), cols(c), data(r * c) {}
+    Matrix(size_t r, size_t c) : rows(r), cols(c), values(r * c) {}
     
     // Accessor for elements
-    T& operator()(size_t i, size_t j) { return data[i * cols + j]; }
-    const T& operator()(size_t i, size_t j) const { return data[i * cols + j]; }
+    T& operator()(size_t i, size_t j) { return values[i * cols + j]; }
+    const T& operator()(size_t i, size_t j) const { return values[i * cols + j]; }
     
     // Get dimensions
     size_t getRows() const { return rows; }
     size_t getCols() const { return cols; }
+
+    // Row-major storage, and views of it for the column-major TBLAS routines
+    T* data() { return values.data(); }
+    const T* data() const { return values.data(); }
+    MatrixView<T> view() { return MatrixView<T>::row_major(values.data(), rows, cols, cols); }
+    MatrixView<const T> view() const { return MatrixView<const T>::row_major(values.data(), rows, cols, cols); }
     
-    // Fill with random values
-    void randomize(double min, double max) {
-        std::random_device rd;
-        std::mt19937 gen(42);
-        std::uniform_real_distribution<double> dist(min, max);
-        
-        for (size_t i = 0; i < rows; ++i) {
-            for (size_t j = 0; j < cols; ++j) {
-                (*this)(i, j) = static_cast<T>(dist(gen));
-            }
-        }
+    // Fill with values uniform in [min, max); element (i, j) is the Philox
+    // value (seed, trial, i * cols + j), the same for every run
+    void randomize(double min, double max, uint64_t seed = 42, uint64_t trial = 0) {
+        PhiloxRandom(seed).fill_uniform(trial, 0, values.size(), values.data(), min, max);
     }
     
     // Matrix-vector multiplication
@@ -58,19 +62,24 @@ public:
             throw std::runtime_error("Dimension mismatch in matrix-matrix multiplication");
         }
         
+        // ikj order walks both row-major operands contiguously; each result(i, j)
+        // still accumulates its products in ascending k, as in the ijk loop
         Matrix<T> result(rows, other.cols);
         for (size_t i = 0; i < rows; ++i) {
             for (size_t j = 0; j < other.cols; ++j) {
                 result(i, j) = T(0);
-                for (size_t k = 0; k < cols; ++k) {
-                    result(i, j) += (*this)(i, k) * other(k, j);
+            }
+            for (size_t k = 0; k < cols; ++k) {
+                const T aik = (*this)(i, k);
+                for (size_t j = 0; j < other.cols; ++j) {
+                    result(i, j) += aik * other(k, j);
                 }
             }
         }
         return result;
     }
     
-    // LU Decomposition (simplified for benchmark)
+    // LU Decomposition without pivoting, A = L*U (simplified for benchmark)
     std::pair<Matrix<T>, Matrix<T>> lu_decomposition() const {
         if (rows != cols) {
             throw std::runtime_error("LU decomposition requires a square matrix");
@@ -114,18 +123,73 @@ public:
         return {L, U};
     }
     
-    // Solve linear system Ax = b using LU decomposition
+    // LU Decomposition with partial pivoting, P*A = L*U, where row i of P*A is
+    // row perm[i] of A
+    std::pair<Matrix<T>, Matrix<T>> lu_decomposition(std::vector<size_t>& perm) const {
+        if (rows != cols) {
+            throw std::runtime_error("LU decomposition requires a square matrix");
+        }
+        
+        // Right-looking elimination in place; the multipliers end up below the diagonal
+        Matrix<T> LU(*this);
+        perm.resize(rows);
+        for (size_t i = 0; i < rows; ++i) {
+            perm[i] = i;
+        }
+        for (size_t k = 0; k < rows; ++k) {
+            size_t p = k;
+            for (size_t i = k + 1; i < rows; ++i) {
+                if (std::abs(static_cast<double>(LU(i, k))) > std::abs(static_cast<double>(LU(p, k)))) {
+                    p = i;
+                }
+            }
+            if (LU(p, k) == static_cast<T>(0.0)) {
+                throw std::runtime_error("Singular matrix in LU decomposition");
+            }
+            if (p != k) {
+                for (size_t j = 0; j < cols; ++j) {
+                    std::swap(LU(k, j), LU(p, j));
+                }
+                std::swap(perm[k], perm[p]);
+            }
+            for (size_t i = k + 1; i < rows; ++i) {
+                LU(i, k) /= LU(k, k);
+                const T lik = LU(i, k);
+                for (size_t j = k + 1; j < cols; ++j) {
+                    LU(i, j) -= lik * LU(k, j);
+                }
+            }
+        }
+        
+        Matrix<T> L(rows, cols);
+        Matrix<T> U(rows, cols);
+        for (size_t i = 0; i < rows; ++i) {
+            for (size_t j = 0; j < cols; ++j) {
+                if (i > j) {
+                    L(i, j) = LU(i, j);
+                    U(i, j) = static_cast<T>(0.0);
+                } else {
+                    L(i, j) = static_cast<T>(i == j ? 1.0 : 0.0);
+                    U(i, j) = LU(i, j);
+                }
+            }
+        }
+        return {L, U};
+    }
+    
+    // Solve linear system Ax = b using LU decomposition with partial pivoting
     std::vector<T> solve(const std::vector<T>& b) const {
         if (rows != cols || rows != b.size()) {
             throw std::runtime_error("Dimension mismatch in linear system solver");
         }
         
-        auto [L, U] = this->lu_decomposition();
+        std::vector<size_t> perm;
+        auto [L, U] = this->lu_decomposition(perm);
         
-        // Forward substitution (Ly = b)
+        // Forward substitution (Ly = Pb)
         std::vector<T> y(rows);
         for (size_t i = 0; i < rows; ++i) {
-            y[i] = b[i];
+            y[i] = b[perm[i]];
             for (size_t j = 0; j < i; ++j) {
                 y[i] -= L(i, j) * y[j];
             }
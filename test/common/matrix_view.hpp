@@ -0,0 +1,82 @@
+#ifndef MATRIX_VIEW_HPP
+#define MATRIX_VIEW_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+// Storage order of a dense matrix
+enum class Layout { RowMajor, ColMajor };
+
+// Non-owning view of a dense rows x cols matrix stored with leading dimension
+// ld: element (i, j) is data[i * ld + j] in row-major and data[i + j * ld] in
+// column-major layout. Transposing or taking a block only changes the metadata,
+// never the data. A row-major view of A is the column-major view of A' with the
+// same pointer and ld, which is how the TBLAS wrappers in
+// tblas_lapack/TBLAS_view.h hand row-major matrices to column-major routines.
+// T may be const for read-only views.
+template<typename T>
+class MatrixView {
+private:
+    T* ptr = nullptr;
+    size_t rows = 0, cols = 0, ld = 0;
+    Layout layout = Layout::ColMajor;
+
+public:
+    MatrixView() = default;
+
+    MatrixView(T* data, size_t r, size_t c, size_t leading_dimension, Layout l)
+        : ptr(data), rows(r), cols(c), ld(leading_dimension), layout(l) {
+        const size_t min_ld = (layout == Layout::RowMajor) ? cols : rows;
+        if (ld < min_ld && rows > 0 && cols > 0) {
+            throw std::runtime_error("Leading dimension smaller than the matrix");
+        }
+    }
+
+    static MatrixView column_major(T* data, size_t r, size_t c, size_t leading_dimension) {
+        return MatrixView(data, r, c, leading_dimension, Layout::ColMajor);
+    }
+    static MatrixView row_major(T* data, size_t r, size_t c, size_t leading_dimension) {
+        return MatrixView(data, r, c, leading_dimension, Layout::RowMajor);
+    }
+
+    // A view of T converts to a read-only view
+    template<typename U, typename = typename std::enable_if<std::is_same<const U, T>::value && !std::is_same<U, T>::value>::type>
+    MatrixView(const MatrixView<U>& other)
+        : ptr(other.data()), rows(other.getRows()), cols(other.getCols()),
+          ld(other.getLeadingDimension()), layout(other.getLayout()) {}
+
+    T& operator()(size_t i, size_t j) const {
+        return layout == Layout::RowMajor ? ptr[i * ld + j] : ptr[i + j * ld];
+    }
+
+    T* data() const { return ptr; }
+    size_t getRows() const { return rows; }
+    size_t getCols() const { return cols; }
+    size_t getLeadingDimension() const { return ld; }
+    Layout getLayout() const { return layout; }
+    bool isColumnMajor() const { return layout == Layout::ColMajor; }
+
+    // A' over the same storage
+    MatrixView transposed() const {
+        MatrixView t(*this);
+        t.rows = cols;
+        t.cols = rows;
+        t.layout = (layout == Layout::RowMajor) ? Layout::ColMajor : Layout::RowMajor;
+        return t;
+    }
+
+    // The r x c block starting at (i0, j0)
+    MatrixView block(size_t i0, size_t j0, size_t r, size_t c) const {
+        if (i0 + r > rows || j0 + c > cols) {
+            throw std::runtime_error("Matrix view block out of range");
+        }
+        MatrixView b(*this);
+        b.ptr = (r > 0 && c > 0) ? &(*this)(i0, j0) : ptr;
+        b.rows = r;
+        b.cols = c;
+        return b;
+    }
+};
+
+#endif // MATRIX_VIEW_HPP
@@ -0,0 +1,180 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/perf_event.h>)
+#define HUB_HAVE_PERF_EVENT 1
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+#endif
+
+// Hardware events counted by PerfCounters, in the order of their values
+enum class PerfEvent { Cycles, Instructions, BranchMisses, L1DMisses, LLCMisses, Count };
+
+// Hardware performance counters of the calling thread through Linux
+// perf_event_open, counting user-space events only (which perf_event_paranoid
+// 2, the usual default, allows). Each event is opened on its own rather than as
+// a group, so that one the CPU or the hypervisor lacks does not take the
+// others down; when the kernel multiplexes them the counts are scaled by
+// enabled/running time. Events that cannot be opened, and every event off
+// Linux, read as unavailable and the caller reports timings only.
+//
+//   PerfCounters counters;
+//   counters.start();
+//   kernel();
+//   counters.stop();
+//   if (counters.available(PerfEvent::Cycles)) { ... counters.value(PerfEvent::Cycles) ... }
+//
+// Threads already running when start() is called (such as a ThreadPool's) are
+// not counted; measure with one thread to attribute all the work.
+class PerfCounters {
+public:
+    static const size_t event_count = static_cast<size_t>(PerfEvent::Count);
+
+    PerfCounters() {
+        fds_.assign(event_count, -1);
+        values_.assign(event_count, 0.0);
+#ifdef HUB_HAVE_PERF_EVENT
+        for (size_t e = 0; e < event_count; ++e) {
+            fds_[e] = open_event(static_cast<PerfEvent>(e));
+            if (fds_[e] < 0 && error_.empty()) {
+                error_ = std::string(name(static_cast<PerfEvent>(e))) + ": " + std::strerror(errno);
+            }
+        }
+#else
+        error_ = "perf_event_open is not available on this platform";
+#endif
+    }
+
+    ~PerfCounters() {
+#ifdef HUB_HAVE_PERF_EVENT
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // Whether any event could be opened
+    bool any_available() const {
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+    bool available(PerfEvent e) const { return fds_[static_cast<size_t>(e)] >= 0; }
+
+    // Why the first unavailable event could not be opened, empty if all were
+    const std::string& error() const { return error_; }
+
+    // Resets and starts every available event
+    void start() {
+#ifdef HUB_HAVE_PERF_EVENT
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    // Stops the events and reads the counts since start()
+    void stop() {
+#ifdef HUB_HAVE_PERF_EVENT
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+        for (size_t e = 0; e < event_count; ++e) {
+            values_[e] = 0.0;
+            if (fds_[e] < 0) {
+                continue;
+            }
+            // value, time enabled, time running (PERF_FORMAT_TOTAL_TIME_*)
+            uint64_t data[3] = {0, 0, 0};
+            if (read(fds_[e], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) {
+                continue;
+            }
+            values_[e] = static_cast<double>(data[0]);
+            if (data[2] > 0 && data[2] < data[1]) {
+                values_[e] *= static_cast<double>(data[1]) / static_cast<double>(data[2]);
+            }
+        }
+#endif
+    }
+
+    // Count of e between the last start() and stop(); 0 if unavailable
+    double value(PerfEvent e) const { return values_[static_cast<size_t>(e)]; }
+
+    static const char* name(PerfEvent e) {
+        switch (e) {
+        case PerfEvent::Cycles: return "cycles";
+        case PerfEvent::Instructions: return "instructions";
+        case PerfEvent::BranchMisses: return "branch_misses";
+        case PerfEvent::L1DMisses: return "l1d_misses";
+        case PerfEvent::LLCMisses: return "llc_misses";
+        default: return "unknown";
+        }
+    }
+
+private:
+#ifdef HUB_HAVE_PERF_EVENT
+    static int open_event(PerfEvent e) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        switch (e) {
+        case PerfEvent::Cycles:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PerfEvent::Instructions:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PerfEvent::BranchMisses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case PerfEvent::L1DMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        default:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        }
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+#endif
+
+    std::vector<int> fds_;
+    std::vector<double> values_;
+    std::string error_;
+};
+
+#endif // PERF_COUNTERS_HPP
@@ -0,0 +1,471 @@
+#ifndef SPARSE_MATRIX_HPP
+#define SPARSE_MATRIX_HPP
+
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Sparse matrices for the SpMV-bound kernels of iterative solvers. Values are
+// stored in T, column indices as 32-bit integers: with 4-byte values a CSR
+// nonzero costs 8 bytes of memory traffic against 12 for double.
+
+// One (row, col, value) entry of a matrix being assembled
+struct SparseEntry {
+    size_t row;
+    size_t col;
+    double value;
+};
+
+// Compressed sparse row matrix. The entries of a row are sorted by column, so
+// multiply sums each row in column order whatever the thread count.
+template<typename T>
+class CsrMatrix {
+private:
+    size_t rows = 0, cols = 0;
+    std::vector<size_t> row_ptr{0};
+    std::vector<std::uint32_t> col_idx;
+    std::vector<T> values;
+
+    // First row of the chunk t of n, chosen so that each chunk holds about the
+    // same number of nonzeros. The last chunk ends at rows, so that it also
+    // covers any empty rows after the last nonzero.
+    size_t chunk_row(size_t t, size_t n) const {
+        if (t == n) {
+            return rows;
+        }
+        const size_t target = getNonZeros() * t / n;
+        return std::lower_bound(row_ptr.begin(), row_ptr.end(), target) - row_ptr.begin();
+    }
+
+    // y(rows r0:r1) = A(r0:r1, :) * x
+    void multiply_rows(size_t r0, size_t r1, const T* x, T* y) const {
+        for (size_t i = r0; i < r1; ++i) {
+            T sum = T(0);
+            for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k) {
+                sum += values[k] * x[col_idx[k]];
+            }
+            y[i] = sum;
+        }
+    }
+
+    // y += A(r0:r1, :)' * x(r0:r1)
+    void scatter_rows(size_t r0, size_t r1, const T* x, T* y) const {
+        for (size_t i = r0; i < r1; ++i) {
+            const T xi = x[i];
+            for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k) {
+                y[col_idx[k]] += values[k] * xi;
+            }
+        }
+    }
+
+public:
+    CsrMatrix() = default;
+
+    // Assemble from entries in any order; duplicate entries are summed (in
+    // double, before rounding to T) and explicit zeros are kept
+    CsrMatrix(size_t r, size_t c, std::vector<SparseEntry> entries) : rows(r), cols(c) {
+        if (cols > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::runtime_error("Sparse matrix has too many columns for 32-bit indices");
+        }
+        for (const SparseEntry& e : entries) {
+            if (e.row >= rows || e.col >= cols) {
+                throw std::runtime_error("Sparse matrix entry out of range");
+            }
+        }
+        std::sort(entries.begin(), entries.end(), [](const SparseEntry& a, const SparseEntry& b) {
+            return a.row != b.row ? a.row < b.row : a.col < b.col;
+        });
+
+        row_ptr.assign(rows + 1, 0);
+        col_idx.reserve(entries.size());
+        values.reserve(entries.size());
+        for (size_t k = 0; k < entries.size(); ) {
+            double sum = entries[k].value;
+            size_t next = k + 1;
+            while (next < entries.size() && entries[next].row == entries[k].row && entries[next].col == entries[k].col) {
+                sum += entries[next++].value;
+            }
+            col_idx.push_back(static_cast<std::uint32_t>(entries[k].col));
+            values.push_back(static_cast<T>(sum));
+            ++row_ptr[entries[k].row + 1];
+            k = next;
+        }
+        for (size_t i = 0; i < rows; ++i) {
+            row_ptr[i + 1] += row_ptr[i];
+        }
+    }
+
+    // Same structure with the values rounded to T
+    template<typename U>
+    explicit CsrMatrix(const CsrMatrix<U>& other)
+        : rows(other.getRows()), cols(other.getCols()),
+          row_ptr(other.getRowPointers()), col_idx(other.getColumnIndices()) {
+        values.reserve(other.getNonZeros());
+        for (const U& v : other.getValues()) {
+            values.push_back(static_cast<T>(static_cast<double>(v)));
+        }
+    }
+
+    size_t getRows() const { return rows; }
+    size_t getCols() const { return cols; }
+    size_t getNonZeros() const { return values.size(); }
+    const std::vector<size_t>& getRowPointers() const { return row_ptr; }
+    const std::vector<std::uint32_t>& getColumnIndices() const { return col_idx; }
+    const std::vector<T>& getValues() const { return values; }
+
+    // y = A*x. Each row is summed by one thread, so the result does not depend
+    // on the pool size; the rows are split so each thread gets about nnz/threads.
+    void multiply(const T* x, T* y, ThreadPool* pool = nullptr) const {
+        if (pool == nullptr || pool->size() == 1) {
+            multiply_rows(0, rows, x, y);
+            return;
+        }
+        const size_t n = pool->size();
+        pool->parallel_for(0, n, [&](size_t t0, size_t t1, size_t) {
+            for (size_t t = t0; t < t1; ++t) {
+                multiply_rows(chunk_row(t, n), chunk_row(t + 1, n), x, y);
+            }
+        });
+    }
+
+    // y = A'*x. Rows scatter into the output, so each thread accumulates its
+    // rows into a private vector and the vectors are added in thread order: the
+    // result is reproducible for a given pool size, and with a single thread is
+    // that of the serial loop. For results independent of the pool size use
+    // transpose().multiply, which sums each entry in the same order as the
+    // serial loop.
+    void multiply_transpose(const T* x, T* y, ThreadPool* pool = nullptr) const {
+        std::fill(y, y + cols, T(0));
+        if (pool == nullptr || pool->size() == 1) {
+            scatter_rows(0, rows, x, y);
+            return;
+        }
+        const size_t n = pool->size();
+        std::vector<std::vector<T>> partial(n - 1);
+        pool->parallel_for(0, n, [&](size_t t0, size_t t1, size_t) {
+            for (size_t t = t0; t < t1; ++t) {
+                T* out = y;
+                if (t > 0) {
+                    partial[t - 1].assign(cols, T(0));
+                    out = partial[t - 1].data();
+                }
+                scatter_rows(chunk_row(t, n), chunk_row(t + 1, n), x, out);
+            }
+        });
+        pool->parallel_for(0, cols, [&](size_t j0, size_t j1, size_t) {
+            for (const std::vector<T>& p : partial) {
+                for (size_t j = j0; j < j1; ++j) {
+                    y[j] += p[j];
+                }
+            }
+        });
+    }
+
+    std::vector<T> multiply(const std::vector<T>& x, ThreadPool* pool = nullptr) const {
+        if (x.size() != cols) {
+            throw std::runtime_error("Dimension mismatch in sparse matrix-vector multiplication");
+        }
+        std::vector<T> y(rows);
+        multiply(x.data(), y.data(), pool);
+        return y;
+    }
+
+    std::vector<T> multiply_transpose(const std::vector<T>& x, ThreadPool* pool = nullptr) const {
+        if (x.size() != rows) {
+            throw std::runtime_error("Dimension mismatch in sparse matrix-vector multiplication");
+        }
+        std::vector<T> y(cols);
+        multiply_transpose(x.data(), y.data(), pool);
+        return y;
+    }
+
+    // Explicit transpose; the rows of A' come out sorted by column
+    CsrMatrix<T> transpose() const {
+        CsrMatrix<T> t;
+        t.rows = cols;
+        t.cols = rows;
+        t.row_ptr.assign(cols + 1, 0);
+        t.col_idx.resize(getNonZeros());
+        t.values.resize(getNonZeros());
+        for (std::uint32_t j : col_idx) {
+            ++t.row_ptr[j + 1];
+        }
+        for (size_t j = 0; j < cols; ++j) {
+            t.row_ptr[j + 1] += t.row_ptr[j];
+        }
+        std::vector<size_t> next(t.row_ptr.begin(), t.row_ptr.end() - 1);
+        for (size_t i = 0; i < rows; ++i) {
+            for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k) {
+                const size_t dst = next[col_idx[k]]++;
+                t.col_idx[dst] = static_cast<std::uint32_t>(i);
+                t.values[dst] = values[k];
+            }
+        }
+        return t;
+    }
+};
+
+// Blocked ELLPACK matrix: the matrix is tiled into b x b blocks and every block
+// row stores the same number of blocks (the largest count of any block row),
+// each as a dense row-major tile with one column index per block. Short block
+// rows are padded with empty slots that the kernels skip. Suits matrices with a
+// dense block structure (several unknowns per mesh node), where it needs one
+// index per b*b values and the inner loops have a fixed length; on scattered
+// nonzeros the explicit zeros inside the tiles cost more than the indices save.
+//
+// The tiles of a block row are sorted by column, so each row is summed in the
+// same column order as CsrMatrix; the extra terms are products with explicit
+// zeros, which leave the sum unchanged as long as x is finite.
+template<typename T>
+class BlockedEllMatrix {
+public:
+    static constexpr std::uint32_t empty_slot = std::numeric_limits<std::uint32_t>::max();
+    static constexpr size_t max_block_size = 16;
+
+private:
+    size_t rows = 0, cols = 0;
+    size_t block = 1;           // b
+    size_t block_rows = 0;      // ceil(rows / b)
+    size_t width = 0;           // block slots per block row
+    std::vector<std::uint32_t> block_col;  // block_rows x width, first column of each tile or empty_slot
+    std::vector<T> values;                 // block_rows x width tiles of b*b values
+
+    // y(block rows br0:br1) = A * x
+    void multiply_block_rows(size_t br0, size_t br1, const T* x, T* y) const {
+        const size_t bb = block * block;
+        T sum[max_block_size];
+        for (size_t br = br0; br < br1; ++br) {
+            const size_t r0 = br * block;
+            const size_t nr = std::min(block, rows - r0);
+            std::fill(sum, sum + block, T(0));
+            for (size_t s = br * width; s < (br + 1) * width; ++s) {
+                const std::uint32_t c0 = block_col[s];
+                if (c0 == empty_slot) {
+                    break; // padding comes last
+                }
+                const size_t nc = std::min(block, cols - c0);
+                const T* tile = &values[s * bb];
+                const T* xs = &x[c0];
+                for (size_t r = 0; r < nr; ++r) {
+                    for (size_t c = 0; c < nc; ++c) {
+                        sum[r] += tile[r * block + c] * xs[c];
+                    }
+                }
+            }
+            std::copy(sum, sum + nr, &y[r0]);
+        }
+    }
+
+    // y += A(block rows br0:br1, :)' * x
+    void scatter_block_rows(size_t br0, size_t br1, const T* x, T* y) const {
+        const size_t bb = block * block;
+        for (size_t br = br0; br < br1; ++br) {
+            const size_t r0 = br * block;
+            const size_t nr = std::min(block, rows - r0);
+            for (size_t s = br * width; s < (br + 1) * width; ++s) {
+                const std::uint32_t c0 = block_col[s];
+                if (c0 == empty_slot) {
+                    break;
+                }
+                const size_t nc = std::min(block, cols - c0);
+                const T* tile = &values[s * bb];
+                for (size_t r = 0; r < nr; ++r) {
+                    const T xr = x[r0 + r];
+                    for (size_t c = 0; c < nc; ++c) {
+                        y[c0 + c] += tile[r * block + c] * xr;
+                    }
+                }
+            }
+        }
+    }
+
+public:
+    BlockedEllMatrix() = default;
+
+    BlockedEllMatrix(const CsrMatrix<T>& a, size_t block_size)
+        : rows(a.getRows()), cols(a.getCols()), block(block_size) {
+        if (block == 0 || block > max_block_size) {
+            throw std::runtime_error("Blocked-ELL block size must be between 1 and 16");
+        }
+        if (cols >= empty_slot) {
+            throw std::runtime_error("Sparse matrix has too many columns for 32-bit indices");
+        }
+        const std::vector<size_t>& row_ptr = a.getRowPointers();
+        const std::vector<std::uint32_t>& col_idx = a.getColumnIndices();
+        const std::vector<T>& a_values = a.getValues();
+        block_rows = (rows + block - 1) / block;
+
+        // Sorted block columns of each block row
+        std::vector<std::vector<std::uint32_t>> tiles(block_rows);
+        for (size_t br = 0; br < block_rows; ++br) {
+            std::vector<std::uint32_t>& t = tiles[br];
+            for (size_t i = br * block; i < std::min(rows, (br + 1) * block); ++i) {
+                for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k) {
+                    t.push_back(static_cast<std::uint32_t>(col_idx[k] / block));
+                }
+            }
+            std::sort(t.begin(), t.end());
+            t.erase(std::unique(t.begin(), t.end()), t.end());
+            width = std::max(width, t.size());
+        }
+
+        const size_t bb = block * block;
+        block_col.assign(block_rows * width, empty_slot);
+        values.assign(block_rows * width * bb, T(0));
+        for (size_t br = 0; br < block_rows; ++br) {
+            const std::vector<std::uint32_t>& t = tiles[br];
+            for (size_t s = 0; s < t.size(); ++s) {
+                block_col[br * width + s] = static_cast<std::uint32_t>(t[s] * block);
+            }
+            for (size_t i = br * block; i < std::min(rows, (br + 1) * block); ++i) {
+                for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k) {
+                    const std::uint32_t bc = static_cast<std::uint32_t>(col_idx[k] / block);
+                    const size_t s = std::lower_bound(t.begin(), t.end(), bc) - t.begin();
+                    values[(br * width + s) * bb + (i - br * block) * block + col_idx[k] % block] = a_values[k];
+                }
+            }
+        }
+    }
+
+    size_t getRows() const { return rows; }
+    size_t getCols() const { return cols; }
+    size_t getBlockSize() const { return block; }
+    size_t getWidth() const { return width; }
+
+    // Values held, explicit zeros and padding included
+    size_t getStoredValues() const { return values.size(); }
+
+    // y = A*x; each row is summed by one thread, as in CsrMatrix
+    void multiply(const T* x, T* y, ThreadPool* pool = nullptr) const {
+        if (pool == nullptr || pool->size() == 1) {
+            multiply_block_rows(0, block_rows, x, y);
+            return;
+        }
+        pool->parallel_for(0, block_rows, [&](size_t br0, size_t br1, size_t) {
+            multiply_block_rows(br0, br1, x, y);
+        });
+    }
+
+    // y = A'*x, reduced from per-thread vectors as CsrMatrix::multiply_transpose
+    void multiply_transpose(const T* x, T* y, ThreadPool* pool = nullptr) const {
+        std::fill(y, y + cols, T(0));
+        if (pool == nullptr || pool->size() == 1) {
+            scatter_block_rows(0, block_rows, x, y);
+            return;
+        }
+        std::vector<std::vector<T>> partial(pool->size() - 1);
+        pool->parallel_for(0, block_rows, [&](size_t br0, size_t br1, size_t t) {
+            T* out = y;
+            if (t > 0) {
+                partial[t - 1].assign(cols, T(0));
+                out = partial[t - 1].data();
+            }
+            scatter_block_rows(br0, br1, x, out);
+        });
+        pool->parallel_for(0, cols, [&](size_t j0, size_t j1, size_t) {
+            for (const std::vector<T>& p : partial) {
+                if (p.empty()) {
+                    continue; // thread had no block rows
+                }
+                for (size_t j = j0; j < j1; ++j) {
+                    y[j] += p[j];
+                }
+            }
+        });
+    }
+
+    std::vector<T> multiply(const std::vector<T>& x, ThreadPool* pool = nullptr) const {
+        if (x.size() != cols) {
+            throw std::runtime_error("Dimension mismatch in sparse matrix-vector multiplication");
+        }
+        std::vector<T> y(rows);
+        multiply(x.data(), y.data(), pool);
+        return y;
+    }
+
+    std::vector<T> multiply_transpose(const std::vector<T>& x, ThreadPool* pool = nullptr) const {
+        if (x.size() != rows) {
+            throw std::runtime_error("Dimension mismatch in sparse matrix-vector multiplication");
+        }
+        std::vector<T> y(cols);
+        multiply_transpose(x.data(), y.data(), pool);
+        return y;
+    }
+};
+
+// Read a Matrix Market coordinate file (real, integer or pattern values; general,
+// symmetric or skew-symmetric storage) into a CSR matrix. Symmetric files store
+// one triangle, which is mirrored. Complex and dense array files are rejected.
+template<typename T>
+CsrMatrix<T> read_matrix_market(std::istream& in) {
+    std::string line;
+    if (!std::getline(in, line)) {
+        throw std::runtime_error("Matrix Market: empty input");
+    }
+    std::transform(line.begin(), line.end(), line.begin(), [](unsigned char ch) { return std::tolower(ch); });
+    std::istringstream banner(line);
+    std::string tag, object, format, field, symmetry;
+    banner >> tag >> object >> format >> field >> symmetry;
+    if (tag != "%%matrixmarket" || object != "matrix") {
+        throw std::runtime_error("Matrix Market: missing %%MatrixMarket matrix header");
+    }
+    if (format != "coordinate") {
+        throw std::runtime_error("Matrix Market: only coordinate format is supported, not " + format);
+    }
+    const bool pattern = (field == "pattern");
+    if (!pattern && field != "real" && field != "integer" && field != "double") {
+        throw std::runtime_error("Matrix Market: unsupported field " + field);
+    }
+    const bool symmetric = (symmetry == "symmetric");
+    const bool skew = (symmetry == "skew-symmetric");
+    if (!symmetric && !skew && symmetry != "general") {
+        throw std::runtime_error("Matrix Market: unsupported symmetry " + symmetry);
+    }
+
+    // Comments run up to the size line
+    while (std::getline(in, line) && (line.empty() || line[0] == '%')) {
+    }
+    size_t rows = 0, cols = 0, count = 0;
+    std::istringstream size_line(line);
+    if (!(size_line >> rows >> cols >> count)) {
+        throw std::runtime_error("Matrix Market: bad size line");
+    }
+
+    std::vector<SparseEntry> entries;
+    entries.reserve((symmetric || skew) ? 2 * count : count);
+    for (size_t k = 0; k < count; ++k) {
+        size_t i = 0, j = 0;
+        double v = 1.0;
+        if (!(in >> i >> j) || (!pattern && !(in >> v))) {
+            throw std::runtime_error("Matrix Market: expected " + std::to_string(count) +
+                                     " entries, read " + std::to_string(k));
+        }
+        if (i == 0 || j == 0 || i > rows || j > cols) {
+            throw std::runtime_error("Matrix Market: entry index out of range");
+        }
+        entries.push_back({i - 1, j - 1, v});
+        if ((symmetric || skew) && i != j) {
+            entries.push_back({j - 1, i - 1, skew ? -v : v});
+        }
+    }
+    return CsrMatrix<T>(rows, cols, std::move(entries));
+}
+
+template<typename T>
+CsrMatrix<T> read_matrix_market(const std::string& filename) {
+    std::ifstream in(filename);
+    if (!in.is_open()) {
+        throw std::runtime_error("Failed to open file: " + filename);
+    }
+    return read_matrix_market<T>(in);
+}
+
+#endif // SPARSE_MATRIX_HPP
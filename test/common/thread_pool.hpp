@@ -0,0 +1,213 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads. parallel_for splits an index range into one
+// contiguous chunk per thread and blocks until every chunk is done; the calling
+// thread runs chunk 0, so a pool of size 1 starts no threads at all. The grained
+// overload of parallel_for balances work of uneven cost by work stealing, and
+// parallel_reduce builds on it a reduction whose result does not depend on the
+// number of threads or on the schedule.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads = default_threads()) {
+        threads = std::max<size_t>(threads, 1);
+        for (size_t i = 1; i < threads; ++i) {
+            workers_.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        start_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of threads taking part in parallel_for, including the caller
+    size_t size() const { return workers_.size() + 1; }
+
+    static size_t default_threads() {
+        return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    // Call fn(chunk_begin, chunk_end, thread_index) for each chunk of [begin, end)
+    template<typename F>
+    void parallel_for(size_t begin, size_t end, F&& fn) {
+        const size_t count = end > begin ? end - begin : 0;
+        const size_t threads = size();
+        auto run_chunk = [&](size_t t) {
+            size_t chunk_begin = begin + count * t / threads;
+            size_t chunk_end = begin + count * (t + 1) / threads;
+            if (chunk_begin < chunk_end) {
+                fn(chunk_begin, chunk_end, t);
+            }
+        };
+        if (threads == 1 || count == 0) {
+            run_chunk(0);
+            return;
+        }
+        run_on_all(run_chunk);
+    }
+
+    // Call fn(chunk_begin, chunk_end, thread_index) for each chunk of `grain`
+    // indices of [begin, end). Every thread starts on a contiguous share of the
+    // chunks and, when it runs out, steals the upper half of the chunks another
+    // thread has left, so a thread may run any number of chunks. Per-thread
+    // state indexed by thread_index is safe; per-chunk results must be keyed by
+    // the chunk, as parallel_reduce does.
+    template<typename F>
+    void parallel_for(size_t begin, size_t end, size_t grain, F&& fn) {
+        grain = std::max<size_t>(grain, 1);
+        const size_t count = end > begin ? end - begin : 0;
+        const size_t chunks = (count + grain - 1) / grain;
+        const size_t threads = std::min(size(), chunks);
+        auto run_chunks = [&](size_t c0, size_t c1, size_t t) {
+            for (size_t c = c0; c < c1; ++c) {
+                fn(begin + c * grain, std::min(begin + (c + 1) * grain, end), t);
+            }
+        };
+        if (threads <= 1) {
+            run_chunks(0, chunks, 0);
+            return;
+        }
+
+        std::vector<Share> shares(size());
+        for (size_t t = 0; t < threads; ++t) {
+            shares[t].next = chunks * t / threads;
+            shares[t].last = chunks * (t + 1) / threads;
+        }
+        run_on_all([&](size_t t) {
+            for (;;) {
+                size_t c = 0;
+                bool have = false;
+                {
+                    std::lock_guard<std::mutex> lock(shares[t].mutex);
+                    if (shares[t].next < shares[t].last) {
+                        c = shares[t].next++;
+                        have = true;
+                    }
+                }
+                if (have) {
+                    run_chunks(c, c + 1, t);
+                } else if (!steal(shares, t)) {
+                    return;
+                }
+            }
+        });
+    }
+
+    // map(chunk_begin, chunk_end, thread_index) -> R over the chunks of `grain`
+    // indices of [begin, end), run as the grained parallel_for; the partial
+    // results are then folded in chunk order, init first, with combine(R, R).
+    // The chunks depend only on the range and the grain, so the result is the
+    // same for any pool size and schedule, floating-point sums included.
+    template<typename R, typename Map, typename Combine>
+    R parallel_reduce(size_t begin, size_t end, size_t grain, R init, Map&& map, Combine&& combine) {
+        grain = std::max<size_t>(grain, 1);
+        const size_t count = end > begin ? end - begin : 0;
+        std::vector<R> partial((count + grain - 1) / grain, init);
+        parallel_for(begin, end, grain, [&](size_t b, size_t e, size_t t) {
+            partial[(b - begin) / grain] = map(b, e, t);
+        });
+        for (const R& p : partial) {
+            init = combine(init, p);
+        }
+        return init;
+    }
+
+private:
+    // Chunks [next, last) not yet started by one thread of the grained parallel_for
+    struct Share {
+        std::mutex mutex;
+        size_t next = 0;
+        size_t last = 0;
+    };
+
+    // Moves the upper half of another thread's remaining chunks to thread t;
+    // false once every other thread has run out
+    static bool steal(std::vector<Share>& shares, size_t t) {
+        for (size_t k = 1; k < shares.size(); ++k) {
+            Share& victim = shares[(t + k) % shares.size()];
+            size_t first, last;
+            {
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (victim.next >= victim.last) {
+                    continue;
+                }
+                first = victim.next + (victim.last - victim.next) / 2;
+                last = victim.last;
+                victim.last = first;
+            }
+            std::lock_guard<std::mutex> lock(shares[t].mutex);
+            shares[t].next = first;
+            shares[t].last = last;
+            return true;
+        }
+        return false;
+    }
+
+    // Runs task(thread_index) on every thread of the pool, the caller being
+    // thread 0, and waits for all of them
+    void run_on_all(const std::function<void(size_t)>& task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task_ = task;
+            pending_ = workers_.size();
+            ++generation_;
+        }
+        start_.notify_all();
+        task(0);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return pending_ == 0; });
+        task_ = nullptr;
+    }
+
+    void worker_loop(size_t index) {
+        size_t seen = 0;
+        for (;;) {
+            std::function<void(size_t)> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                start_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_) {
+                    return;
+                }
+                seen = generation_;
+                task = task_;
+            }
+            task(index);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --pending_;
+            }
+            done_.notify_one();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    std::function<void(size_t)> task_;
+    size_t generation_ = 0;
+    size_t pending_ = 0;
+    bool stop_ = false;
+};
+
+#endif // THREAD_POOL_HPP
@@ -0,0 +1,210 @@
+#ifndef TRIAL_SCHEDULER_HPP
+#define TRIAL_SCHEDULER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <exception>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+#include "thread_pool.hpp"
+
+// Running mean and sample variance of one metric (Welford's update)
+class RunningStats {
+public:
+    void add(double x) {
+        ++n;
+        const double delta = x - m;
+        m += delta / static_cast<double>(n);
+        m2 += delta * (x - m);
+    }
+
+    size_t count() const { return n; }
+    double mean() const { return m; }
+    double variance() const { return n > 1 ? m2 / static_cast<double>(n - 1) : 0.0; }
+    double stddev() const { return std::sqrt(variance()); }
+
+    // Half-width of the two-sided confidence interval on the mean, from
+    // Student's t with count() - 1 degrees of freedom; infinite below 2 samples
+    double half_width(double confidence) const {
+        if (n < 2) {
+            return std::numeric_limits<double>::infinity();
+        }
+        return student_t_quantile(0.5 + 0.5 * confidence, static_cast<double>(n - 1)) *
+               stddev() / std::sqrt(static_cast<double>(n));
+    }
+
+    // Standard normal quantile (Acklam's rational approximation, |error| < 1.2e-9)
+    static double normal_quantile(double p) {
+        static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                                   1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+        static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                                   6.680131188771972e+01, -1.328068155288572e+01};
+        static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                   -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+        static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                                   3.754408661907416e+00};
+        const double p_low = 0.02425;
+        if (p < p_low) {
+            const double q = std::sqrt(-2.0 * std::log(p));
+            return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+                   ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+        }
+        if (p > 1.0 - p_low) {
+            return -normal_quantile(1.0 - p);
+        }
+        const double q = p - 0.5;
+        const double r = q * q;
+        return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+               (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+    }
+
+    // Student's t quantile from the Cornish-Fisher expansion around the normal
+    // one; within 0.5% of the exact value from 5 degrees of freedom on at 95%
+    static double student_t_quantile(double p, double dof) {
+        const double z = normal_quantile(p);
+        const double z2 = z * z;
+        const double g1 = (z2 + 1.0) * z / 4.0;
+        const double g2 = ((5.0 * z2 + 16.0) * z2 + 3.0) * z / 96.0;
+        const double g3 = (((3.0 * z2 + 19.0) * z2 + 17.0) * z2 - 15.0) * z / 384.0;
+        return z + g1 / dof + g2 / (dof * dof) + g3 / (dof * dof * dof);
+    }
+
+private:
+    size_t n = 0;
+    double m = 0.0;
+    double m2 = 0.0;
+};
+
+// Required precision of one metric's mean: trials continue until the confidence
+// interval half-width is at most max(absolute_width, relative_width * |mean|).
+// With both widths 0 the metric is only tracked; use that for heavy-tailed
+// metrics whose mean would take far too many trials to pin down.
+struct MetricTarget {
+    std::string name;
+    double relative_width = 0.0;
+    double absolute_width = 0.0;
+};
+
+// Runs independent trials in batches until every metric's mean is known to the
+// requested precision. Trials of a batch run in parallel on the pool, but their
+// results are accepted in trial order and the stopping rule is only checked
+// between batches, whose size does not depend on the pool; so for trials that
+// depend only on their index (seed them from it) the trials run, the results
+// and the statistics are the same for any number of threads.
+//
+//   AdaptiveTrialScheduler scheduler({{"SNR", 0.0, 0.1}, {"RMSE", 0.02}, {"max"}}, options, &pool);
+//   auto results = scheduler.run<Stats>(
+//       [&](size_t trial, Stats& out) { out = run_trial(trial); return true; },
+//       [](const Stats& s) { return std::vector<double>{s.snr, s.rmse, s.max_error}; });
+//
+// A trial that returns false or throws is skipped (it still counts against
+// max_trials); the exception is reported through failure_message().
+class AdaptiveTrialScheduler {
+public:
+    struct Options {
+        size_t min_trials = 10;       // Never stop before this many accepted trials
+        size_t max_trials = 1000;     // Stop after this many trials, converged or not
+        size_t batch_size = 8;        // Trials started between stopping checks
+        double confidence = 0.95;     // Confidence level of the intervals
+    };
+
+    AdaptiveTrialScheduler(std::vector<MetricTarget> targets, Options options, ThreadPool* pool = nullptr)
+        : targets_(std::move(targets)), options_(options), pool_(pool), stats_(targets_.size()) {
+        options_.batch_size = std::max<size_t>(options_.batch_size, 1);
+        options_.min_trials = std::max<size_t>(options_.min_trials, 2);
+    }
+
+    // Calls trial(index, result) for index = 0, 1, ... and feeds metrics(result),
+    // one value per target, to the statistics. Returns the accepted results in
+    // trial order, with their indices in trial_indices().
+    template<typename Result, typename Trial, typename Metrics>
+    std::vector<Result> run(Trial&& trial, Metrics&& metrics) {
+        std::vector<Result> results;
+        stats_.assign(targets_.size(), RunningStats());
+        indices_.clear();
+        failure_.clear();
+        trials_run_ = 0;
+        converged_ = false;
+
+        while (trials_run_ < options_.max_trials && !converged_) {
+            const size_t first = trials_run_;
+            const size_t count = std::min(options_.batch_size, options_.max_trials - first);
+            std::vector<Result> batch(count);
+            std::vector<char> accepted(count, 0);
+            std::vector<std::string> errors(count);
+            auto run_range = [&](size_t b, size_t e, size_t) {
+                for (size_t i = b; i < e; ++i) {
+                    try {
+                        accepted[i] = trial(first + i, batch[i]) ? 1 : 0;
+                    } catch (const std::exception& ex) {
+                        errors[i] = ex.what();
+                    }
+                }
+            };
+            if (pool_ != nullptr) {
+                pool_->parallel_for(0, count, run_range);
+            } else {
+                run_range(0, count, 0);
+            }
+
+            for (size_t i = 0; i < count; ++i) {
+                if (!accepted[i]) {
+                    if (failure_.empty() && !errors[i].empty()) {
+                        failure_ = "trial " + std::to_string(first + i) + ": " + errors[i];
+                    }
+                    continue;
+                }
+                const std::vector<double> values = metrics(batch[i]);
+                for (size_t k = 0; k < stats_.size() && k < values.size(); ++k) {
+                    stats_[k].add(values[k]);
+                }
+                indices_.push_back(first + i);
+                results.push_back(std::move(batch[i]));
+            }
+            trials_run_ += count;
+            converged_ = results.size() >= options_.min_trials && all_within_target();
+        }
+        return results;
+    }
+
+    // Whether the last run stopped because every interval reached its target
+    bool converged() const { return converged_; }
+    size_t trials_run() const { return trials_run_; }
+    size_t trials_accepted() const { return indices_.size(); }
+    const std::vector<size_t>& trial_indices() const { return indices_; }
+    const std::string& failure_message() const { return failure_; }
+
+    const std::vector<MetricTarget>& targets() const { return targets_; }
+    const RunningStats& statistics(size_t metric) const { return stats_[metric]; }
+    double half_width(size_t metric) const { return stats_[metric].half_width(options_.confidence); }
+    double confidence() const { return options_.confidence; }
+
+private:
+    bool all_within_target() const {
+        for (size_t k = 0; k < targets_.size(); ++k) {
+            if (targets_[k].relative_width <= 0.0 && targets_[k].absolute_width <= 0.0) {
+                continue;
+            }
+            const double target = std::max(targets_[k].absolute_width,
+                                           targets_[k].relative_width * std::fabs(stats_[k].mean()));
+            if (!(half_width(k) <= target)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<MetricTarget> targets_;
+    Options options_;
+    ThreadPool* pool_;
+    std::vector<RunningStats> stats_;
+    std::vector<size_t> indices_;
+    std::string failure_;
+    size_t trials_run_ = 0;
+    bool converged_ = false;
+};
+
+#endif // TRIAL_SCHEDULER_HPP
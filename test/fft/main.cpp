@@ -1,11 +1,17 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
-#include <random>
 #include <iomanip>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include "fft.hpp"
 #include "../common/error_stats.hpp"
 #include "../common/io_utils.hpp"
+#include "../common/trial_scheduler.hpp"
+#include "../common/benchmark.hpp"
+#include "../common/counter_rng.hpp"
 #include "../../src/hub_float.hpp"
 
 // Helper struct to hold separate real and imaginary errors for float and hub_float
@@ -16,23 +22,19 @@ struct SeparatedStats {
     ErrorStats hub_stats_im;
 };
 
-SeparatedStats run_fft_test(unsigned int N, std::mt19937& gen, const std::string& data_dir = "", int trial_num = -1) {
-    std::vector<double> data_re_double(N), data_im_double(N);
-    std::vector<float> data_re_float(N), data_im_float(N);
-    std::vector<hub_float> data_re_hub(N), data_im_hub(N);
-
-    // Generate random input data
-    std::uniform_real_distribution<double> dist(-1.0, 1.0);
-    for (unsigned int i = 0; i < N; ++i) {
-        double value = dist(gen);
-        data_re_double[i] = value;
-        //std::cout << "Generated value: " << value << std::endl;
-        data_im_double[i] = 0.0;
-        data_re_float[i] = static_cast<float>(value);
-        data_im_float[i] = 0.0f;
-        data_re_hub[i] = hub_float(value);
-        data_im_hub[i] = hub_float(0.0);
-    }
+// The input of each trial is the Philox stream (42:N, seed), so trials can run
+// in any order
+SeparatedStats run_fft_test(unsigned int N, std::uint64_t seed, const std::string& data_dir = "", int trial_num = -1) {
+    const PhiloxRandom random(std::uint64_t(42) << 32 | N);
+
+    std::vector<double> data_re_double(N), data_im_double(N, 0.0);
+    std::vector<float> data_re_float(N), data_im_float(N, 0.0f);
+    std::vector<hub_float> data_re_hub(N), data_im_hub(N, hub_float(0.0));
+
+    // Generate random input data, each type rounding the same double values
+    random.fill_uniform(seed, 0, N, data_re_double.data(), -1.0, 1.0);
+    random.fill_uniform(seed, 0, N, data_re_float.data(), -1.0, 1.0);
+    random.fill_uniform(seed, 0, N, data_re_hub.data(), -1.0, 1.0);
 
     // Save input data for Mathematica if requested
     if (!data_dir.empty() && trial_num >= 0) {
@@ -85,12 +87,88 @@ SeparatedStats run_fft_test(unsigned int N, std::mt19937& gen, const std::string
     return out;
 }
 
-int main() {
+// Throughput of the FFT in each type, about 5*N*log2(N) flops per transform.
+// Each iteration copies the input into the work arrays first.
+template<typename T>
+void add_fft_benchmark(BenchmarkHarness& harness, const char* type, unsigned int N) {
+    std::vector<T> input(N), re(N), im(N);
+    PhiloxRandom(N).fill_uniform(0, 0, N, input.data(), -1.0, 1.0);
+    harness.add("fft", type, {{"n", N}}, [input, re, im, N]() mutable {
+        std::copy(input.begin(), input.end(), re.begin());
+        std::fill(im.begin(), im.end(), T(0));
+        fft(re.data(), im.data(), N);
+        do_not_optimize(re[0]);
+    }, 5.0 * N * std::log2(static_cast<double>(N)));
+}
+
+void run_benchmarks(const BenchmarkOptions& options) {
+    BenchmarkHarness harness("fft", options);
+    for (unsigned int N : {256u, 1024u, 4096u}) {
+        add_fft_benchmark<float>(harness, "float", N);
+        add_fft_benchmark<double>(harness, "double", N);
+        add_fft_benchmark<hub_float>(harness, "hub_float", N);
+    }
+    harness.run();
+}
+
+int main(int argc, char* argv[]) {
+    // Trials run in parallel on every core unless --threads says otherwise;
+    // the results do not depend on the thread count
+    size_t threads = ThreadPool::default_threads();
+    AdaptiveTrialScheduler::Options options;
+    options.min_trials = 16;
+    options.max_trials = 1000;
+    options.batch_size = 16;
+    // --bench times the transforms through the benchmark harness instead
+    BenchmarkOptions bench_options;
+    bool bench = false;
+    bool usage = !bench_options.parse(argc, argv);
+    for (int i = 1; i < argc && !usage; i++) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--max-trials") == 0 && i + 1 < argc) {
+            options.max_trials = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--bench") == 0) {
+            bench = true;
+        } else {
+            usage = true;
+        }
+    }
+    if (usage) {
+        std::cerr << "Usage: " << argv[0] << " [--threads N] [--max-trials N]\n"
+                  << "       " << argv[0] << " --bench " << BenchmarkOptions::usage() << std::endl;
+        return 1;
+    }
+    if (bench) {
+        run_benchmarks(bench_options);
+        return 0;
+    }
+    ThreadPool pool(threads);
+
     std::cout << std::fixed << std::setprecision(10);
     
     // FFT sizes to test (powers of 2)
     const std::vector<unsigned int> fft_sizes = {128, 256, 512, 1024, 2048, 4096};
-    const int num_trials = 1000;  // Number of trials per FFT size
+
+    // Each size runs until the 95% confidence intervals on the mean SNR (to
+    // 0.1 dB) and RMSE (to 1%) of every type and part are met. The relative
+    // error is dominated by outputs near zero and is only tracked
+    const char* part_names[] = {"float real", "float imag", "hub real", "hub imag"};
+    std::vector<MetricTarget> targets;
+    for (const char* part : part_names) {
+        targets.push_back({std::string(part) + " SNR", 0.0, 0.1});
+        targets.push_back({std::string(part) + " RMSE", 0.01, 0.0});
+        targets.push_back({std::string(part) + " rel error"});
+    }
+    auto metrics = [](const SeparatedStats& stats) {
+        std::vector<double> values;
+        for (const ErrorStats* part : {&stats.float_stats_re, &stats.float_stats_im, &stats.hub_stats_re, &stats.hub_stats_im}) {
+            values.push_back(part->snr);
+            values.push_back(part->rmse);
+            values.push_back(part->relative_error);
+        }
+        return values;
+    };
     
     std::cout << "FFT Benchmark: hub_float vs float precision comparison\n";
     std::cout << "----------------------------------------------------------\n";
@@ -98,9 +176,6 @@ int main() {
     std::cout << "\nSize\tType\t\tPart\tAvg Error\tMax Error\tMin Error\tRel Error\tSNR (dB)\n";
     std::cout << "-------------------------------------------------------------------------------------\n";
     
-    // Use fixed seed for reproducibility
-    std::mt19937 gen(42);
-    
     // Create timestamp for this run
     std::string timestamp = get_timestamp();
     
@@ -110,6 +185,8 @@ int main() {
     
     // Vectors to store all trial results for CSV output
     std::vector<std::vector<SeparatedStats>> trials_results(fft_sizes.size());
+    size_t total_trials = 0;
+    auto start = std::chrono::steady_clock::now();
     
     for (size_t size_idx = 0; size_idx < fft_sizes.size(); ++size_idx) {
         unsigned int size = fft_sizes[size_idx];
@@ -118,18 +195,20 @@ int main() {
         ErrorStats float_stats_re_accum, float_stats_im_accum;
         ErrorStats hub_stats_re_accum, hub_stats_im_accum;
         
-        // Reserve space for this FFT size's trial results
-        trials_results[size_idx].reserve(num_trials);
+        // Seeded by trial, reproducible for any thread count. Save only the
+        // first 5 trials of each size to avoid excessive files
+        AdaptiveTrialScheduler scheduler(targets, options, &pool);
+        trials_results[size_idx] = scheduler.run<SeparatedStats>(
+            [&](size_t trial, SeparatedStats& stats) {
+                bool save_data = (trial < 5);
+                stats = run_fft_test(size, trial, save_data ? data_dir : "", save_data ? static_cast<int>(trial) : -1);
+                return true;
+            },
+            metrics);
+        total_trials += scheduler.trials_run();
+        const size_t num_trials = trials_results[size_idx].size();
         
-        for (int trial = 0; trial < num_trials; ++trial) {
-            // Run the FFT test for this size
-            // Save only a subset of results to avoid excessive files
-            bool save_data = (trial < 5);  // Save only first 5 trials of each size
-            SeparatedStats stats = run_fft_test(size, gen, save_data ? data_dir : "", save_data ? trial : -1);
-            
-            // Store individual trial results
-            trials_results[size_idx].push_back(stats);
-            
+        for (const SeparatedStats& stats : trials_results[size_idx]) {
             // Accumulate statistics for real and imaginary parts
             float_stats_re_accum.avg_error += stats.float_stats_re.avg_error;
             float_stats_re_accum.max_error = std::max(float_stats_re_accum.max_error, stats.float_stats_re.max_error);
@@ -210,9 +289,23 @@ int main() {
                 << hub_stats_im_accum.relative_error << "\t"
                 << hub_stats_im_accum.snr << std::endl;
 
+        // Widest SNR interval among the types and parts, in dB
+        double snr_half_width = 0.0;
+        for (size_t k = 0; k < targets.size(); k += 3) {
+            snr_half_width = std::max(snr_half_width, scheduler.half_width(k));
+        }
+        std::cout << size << "\t" << num_trials << " trials"
+                  << (scheduler.converged() ? "" : " (max trials reached)")
+                  << ", SNR 95% CI +/- " << std::setprecision(3) << snr_half_width << " dB"
+                  << std::setprecision(10) << std::endl;
+
         std::cout << "-------------------------------------------------------------------------------------\n";
     }
     
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << total_trials << " trials in " << std::setprecision(2) << seconds << " s on "
+              << pool.size() << " thread(s)" << std::endl;
+
     // Write results to CSV file with timestamp
     std::string csv_filename = "fft_benchmark_" + timestamp + ".csv";
     std::ofstream csv_file(csv_filename);
@@ -223,7 +316,7 @@ int main() {
     for (size_t size_idx = 0; size_idx < fft_sizes.size(); ++size_idx) {
         unsigned int size = fft_sizes[size_idx];
         
-        for (int trial = 0; trial < num_trials; ++trial) {
+        for (size_t trial = 0; trial < trials_results[size_idx].size(); ++trial) {
             const SeparatedStats& stats = trials_results[size_idx][trial];
             
             csv_file << size << ",float,real," << trial << ","
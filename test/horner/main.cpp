@@ -4,7 +4,11 @@
 #include <random>
 #include <ctime>
 #include <iomanip>
+#include <cstring>
 #include "hub_float.hpp"  // Include the hub_float class
+#include "../common/benchmark.hpp"
+#include "../common/counter_rng.hpp"
+#include "../common/thread_pool.hpp"
 
 // Standard Horner's rule implementation using a single template parameter
 template<typename T>
@@ -32,83 +36,147 @@ std::vector<T> generateRandomCoefficients(int count, double min, double max) {
     return coefficients;
 }
 
-int main() {
-    // Seed the random number generator
-    std::mt19937 gen(static_cast<unsigned int>(time(nullptr)));
-    
-    std::cout << "=== Testing Horner's Rule with Random Coefficients ===" << std::endl;
-    
-    // Set parameters for random generation
-    const int degree = 10;           // polynomial degree
-    const double min_coef = -100.0;  // minimum coefficient value
-    const double max_coef = 100.0;   // maximum coefficient value
-    const double min_eval = -10.0;   // minimum evaluation point
-    const double max_eval = 10.0;    // maximum evaluation point
-    const int num_trials = 100000;     // number of trials to run
-    
-    // Counters for which type is more accurate
+// Tallies of the accuracy comparison over a range of trials
+struct TrialTotals {
     int float_wins = 0;
     int hub_float_wins = 0;
     int ties = 0;
-    double total_float_error = 0.0;
-    double total_hub_error = 0.0;
-    
-    // Distributions for random generation
-    std::uniform_real_distribution<double> coef_dist(min_coef, max_coef);
-    std::uniform_real_distribution<double> eval_dist(min_eval, max_eval);
-    
-    // Run multiple trials
-    for (int trial = 0; trial < num_trials; ++trial) {
-        // Generate random coefficients for this trial
-        std::vector<double> random_double_coeffs;
-        for (int i = 0; i <= degree; ++i) {
-            random_double_coeffs.push_back(coef_dist(gen));
-        }
-        
-        // Convert to other types
-        std::vector<float> random_float_coeffs;
-        std::vector<hub_float> random_hub_coeffs;
-        
-        for (const auto& coef : random_double_coeffs) {
-            random_float_coeffs.push_back(static_cast<float>(coef));
-            random_hub_coeffs.push_back(hub_float(coef));
-        }
-        
-        // Generate random evaluation point
-        const double eval_point = eval_dist(gen);
-        
-        // Evaluate with different types
-        double random_result_double = horner(random_double_coeffs, eval_point);
-        float random_result_float = horner(random_float_coeffs, static_cast<float>(eval_point));
-        hub_float random_result_hub = horner(random_hub_coeffs, hub_float(eval_point));
-        
-        // Calculate the direct value for verification (using double precision)
-        double direct_result = 0.0;
-        for (size_t i = 0; i < random_double_coeffs.size(); i++) {
-            direct_result += random_double_coeffs[i] * std::pow(eval_point, random_double_coeffs.size() - 1 - i);
+    double float_error = 0.0;
+    double hub_error = 0.0;
+
+    TrialTotals& operator+=(const TrialTotals& other) {
+        float_wins += other.float_wins;
+        hub_float_wins += other.hub_float_wins;
+        ties += other.ties;
+        float_error += other.float_error;
+        hub_error += other.hub_error;
+        return *this;
+    }
+};
+
+// One random polynomial evaluated at one random point in float and hub_float,
+// both compared against double. The trial draws from its own stream, so its
+// outcome depends only on the seed and the trial index.
+void run_trial(uint64_t seed, uint64_t trial, int degree, TrialTotals& totals) {
+    CounterRng gen(seed, trial);
+    std::uniform_real_distribution<double> coef_dist(-100.0, 100.0);
+    std::uniform_real_distribution<double> eval_dist(-10.0, 10.0);
+
+    std::vector<double> double_coeffs;
+    std::vector<float> float_coeffs;
+    std::vector<hub_float> hub_coeffs;
+    for (int i = 0; i <= degree; ++i) {
+        const double coef = coef_dist(gen);
+        double_coeffs.push_back(coef);
+        float_coeffs.push_back(static_cast<float>(coef));
+        hub_coeffs.push_back(hub_float(coef));
+    }
+    const double eval_point = eval_dist(gen);
+
+    const double result_double = horner(double_coeffs, eval_point);
+    const float result_float = horner(float_coeffs, static_cast<float>(eval_point));
+    const hub_float result_hub = horner(hub_coeffs, hub_float(eval_point));
+
+    const double float_error = std::abs(static_cast<double>(result_float) - result_double);
+    const double hub_error = std::abs(static_cast<double>(result_hub) - result_double);
+    totals.float_error += float_error;
+    totals.hub_error += hub_error;
+    if (float_error < hub_error) {
+        totals.float_wins++;
+    } else if (hub_error < float_error) {
+        totals.hub_float_wins++;
+    } else {
+        totals.ties++;
+    }
+}
+
+// Throughput of Horner's rule in each type: a polynomial of the given degree
+// evaluated at 1024 points per iteration
+template<typename T>
+void add_horner_benchmark(BenchmarkHarness& harness, const char* type, int degree) {
+    std::mt19937 gen(static_cast<unsigned int>(degree));
+    std::uniform_real_distribution<double> coef_dist(-100.0, 100.0);
+    std::uniform_real_distribution<double> eval_dist(-10.0, 10.0);
+    std::vector<T> coefficients, points(1024);
+    for (int i = 0; i <= degree; ++i) {
+        coefficients.push_back(T(coef_dist(gen)));
+    }
+    for (T& x : points) {
+        x = T(eval_dist(gen));
+    }
+    harness.add("horner", type, {{"degree", degree}, {"points", points.size()}}, [coefficients, points] {
+        for (const T& x : points) {
+            do_not_optimize(horner(coefficients, x));
         }
-        
-        // Calculate absolute errors
-        double float_error = std::abs(static_cast<double>(random_result_float) - random_result_double);
-        double hub_error = std::abs(static_cast<double>(random_result_hub) - random_result_double);
-        
-        total_float_error += float_error;
-        total_hub_error += hub_error;
-        
-        // Compare which one is more accurate
-        if (float_error < hub_error) {
-            float_wins++;
-        } else if (hub_error < float_error) {
-            hub_float_wins++;
+    }, static_cast<double>(points.size()));
+}
+
+int main(int argc, char* argv[]) {
+    // --bench times the evaluation through the benchmark harness instead.
+    // --threads spreads the trials over a pool and --seed fixes the random
+    // polynomials; the results depend on the seed only, not on the threads.
+    BenchmarkOptions bench_options;
+    bool usage = !bench_options.parse(argc, argv);
+    bool bench = false;
+    size_t threads = ThreadPool::default_threads();
+    uint64_t seed = static_cast<uint64_t>(time(nullptr));
+    for (int i = 1; i < argc && !usage; ++i) {
+        if (std::strcmp(argv[i], "--bench") == 0) {
+            bench = true;
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
         } else {
-            ties++;
+            usage = true;
         }
-        
-        // Print progress every 100 trials
-        if ((trial + 1) % 100 == 0) {
-            std::cout << "Completed " << (trial + 1) << " trials..." << std::endl;
+    }
+    if (usage) {
+        std::cerr << "Usage: " << argv[0] << " [--threads N] [--seed N] [--bench " << BenchmarkOptions::usage() << "]"
+                  << std::endl;
+        return 1;
+    }
+    if (bench) {
+        BenchmarkHarness harness("horner", bench_options);
+        for (int degree : {10, 100}) {
+            add_horner_benchmark<float>(harness, "float", degree);
+            add_horner_benchmark<double>(harness, "double", degree);
+            add_horner_benchmark<hub_float>(harness, "hub_float", degree);
         }
+        harness.run();
+        return 0;
+    }
+
+    std::cout << "=== Testing Horner's Rule with Random Coefficients ===" << std::endl;
+
+    const int degree = 10;              // polynomial degree
+    const uint64_t num_trials = 100000; // number of trials to run
+    const uint64_t progress_step = 10000;
+    ThreadPool pool(threads);
+    std::cout << "Seed " << seed << ", " << pool.size() << " threads" << std::endl;
+
+    // Trials are summed per chunk of 256 and the chunks in order, so the totals
+    // are the same for any number of threads
+    TrialTotals totals;
+    for (uint64_t first = 0; first < num_trials; first += progress_step) {
+        const uint64_t last = std::min(first + progress_step, num_trials);
+        totals += pool.parallel_reduce(first, last, 256, TrialTotals(),
+            [&](size_t b, size_t e, size_t) {
+                TrialTotals chunk;
+                for (size_t trial = b; trial < e; ++trial) {
+                    run_trial(seed, trial, degree, chunk);
+                }
+                return chunk;
+            },
+            [](TrialTotals a, const TrialTotals& b) { return a += b; });
+        std::cout << "Completed " << last << " trials..." << std::endl;
     }
+
+    const int float_wins = totals.float_wins;
+    const int hub_float_wins = totals.hub_float_wins;
+    const int ties = totals.ties;
+    const double total_float_error = totals.float_error;
+    const double total_hub_error = totals.hub_error;
     
     // Print the results
     std::cout << "\n=== Results after " << num_trials << " trials ===" << std::endl;
@@ -0,0 +1,171 @@
+#include "inference_bench.h"
+#include "hub_float.hpp"
+#include "half.hpp"
+#include "../common/thread_pool.hpp"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using namespace Neural;
+using half = half_float::half;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct BenchResult {
+        std::string type;
+        double warmupSeconds = 0.0;
+        double seconds = 0.0;
+        std::vector<double> passSeconds; // per timed pass
+        size_t images = 0;               // images processed in the timed passes
+        std::vector<double> layerSeconds; // summed over all threads and timed batches
+        size_t batches = 0;              // timed batches
+    };
+
+    template<typename T>
+    BenchResult benchmark(const char* type, const LayeredNetwork& reference, const Matrix& images,
+                          const InferenceBenchConfig& config, ThreadPool& pool) {
+        const LayeredNetwork_t<T> network = LayeredNetwork_t<T>::FromDouble(reference);
+        const size_t layerCount = network.layers.size();
+        const size_t inputCount = network.InputCount();
+        const size_t imageCount = images.size();
+        const size_t batchCount = (imageCount + config.batchSize - 1) / config.batchSize;
+
+        // Convert the inputs once, outside of the timed region
+        Vector_t<T> inputs(imageCount * inputCount);
+        for (size_t i = 0; i < imageCount; ++i) {
+            for (size_t j = 0; j < inputCount; ++j) {
+                inputs[i * inputCount + j] = static_cast<T>(images[i][j]);
+            }
+        }
+
+        std::vector<std::vector<Vector_t<T>>> activations(pool.size(), std::vector<Vector_t<T>>(layerCount));
+        std::vector<std::vector<double>> layerSeconds(pool.size(), std::vector<double>(layerCount, 0.0));
+
+        auto pass = [&](bool timeLayers) {
+            pool.parallel_for(0, batchCount, [&](size_t first, size_t last, size_t thread) {
+                auto& buffers = activations[thread];
+                for (size_t b = first; b < last; ++b) {
+                    size_t start = b * config.batchSize;
+                    size_t count = std::min(config.batchSize, imageCount - start);
+                    const T* x = inputs.data() + start * inputCount;
+                    for (size_t l = 0; l < layerCount; ++l) {
+                        const Layer_t<T>& layer = network.layers[l];
+                        buffers[l].resize(count * layer.outputCount);
+                        auto begin = Clock::now();
+                        layer.Forward(x, count, buffers[l].data());
+                        if (timeLayers) {
+                            layerSeconds[thread][l] += std::chrono::duration<double>(Clock::now() - begin).count();
+                        }
+                        x = buffers[l].data();
+                    }
+                }
+            });
+        };
+
+        BenchResult result;
+        result.type = type;
+
+        auto begin = Clock::now();
+        for (int p = 0; p < config.warmupPasses; ++p) {
+            pass(false);
+        }
+        result.warmupSeconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+        for (int p = 0; p < config.passes; ++p) {
+            begin = Clock::now();
+            pass(true);
+            result.passSeconds.push_back(std::chrono::duration<double>(Clock::now() - begin).count());
+            result.seconds += result.passSeconds.back();
+        }
+        result.images = imageCount * config.passes;
+        result.batches = batchCount * config.passes;
+
+        result.layerSeconds.assign(layerCount, 0.0);
+        for (const auto& perThread : layerSeconds) {
+            for (size_t l = 0; l < layerCount; ++l) {
+                result.layerSeconds[l] += perThread[l];
+            }
+        }
+        return result;
+    }
+
+    double perSecond(double count, double seconds) {
+        return seconds > 0.0 ? count / seconds : 0.0;
+    }
+}
+
+void Neural::RunInferenceBenchmark(const LayeredNetwork& network, const Matrix& images,
+                                   const InferenceBenchConfig& config) {
+    ThreadPool pool(config.threads);
+    const double warmupImages = static_cast<double>(images.size()) * config.warmupPasses;
+
+    std::cout << "\n==== Inference Benchmark ====" << std::endl;
+    std::cout << "Images: " << images.size() << ", batch size: " << config.batchSize
+              << ", threads: " << pool.size() << ", warm-up passes: " << config.warmupPasses
+              << ", timed passes: " << config.passes << std::endl;
+
+    std::vector<BenchResult> results;
+    results.push_back(benchmark<double>("double", network, images, config, pool));
+    results.push_back(benchmark<half>("half", network, images, config, pool));
+    results.push_back(benchmark<hub_float>("hub_float", network, images, config, pool));
+
+    const double doubleRate = perSecond(results[0].images, results[0].seconds);
+    for (const auto& r : results) {
+        double rate = perSecond(r.images, r.seconds);
+        std::cout << "\n" << r.type << ": " << std::fixed << std::setprecision(1) << rate << " images/s"
+                  << " (warm-up " << perSecond(warmupImages, r.warmupSeconds) << " images/s"
+                  << ", slowdown vs double " << std::setprecision(2) << (rate > 0.0 ? doubleRate / rate : 0.0) << "x)"
+                  << std::endl;
+        for (size_t l = 0; l < r.layerSeconds.size(); ++l) {
+            const Layer_t<double>& layer = network.layers[l];
+            std::cout << "  layer " << l << " (" << layer.inputCount << "x" << layer.outputCount << "): "
+                      << std::setprecision(3) << 1e6 * r.layerSeconds[l] / r.batches << " us/batch" << std::endl;
+        }
+    }
+
+    // Per-image times of each pass, in the format shared with the other programs
+    std::cout << std::endl;
+    BenchmarkHarness harness("neural", config.harness);
+    for (const auto& r : results) {
+        std::vector<double> perImage;
+        for (double s : r.passSeconds) {
+            perImage.push_back(s / static_cast<double>(images.size()));
+        }
+        harness.add_samples("inference", r.type,
+                            {{"batch", static_cast<double>(config.batchSize)},
+                             {"threads", static_cast<double>(pool.size())}},
+                            perImage, images.size());
+    }
+    harness.run();
+
+    if (config.outputFile.empty()) {
+        return;
+    }
+    std::ofstream out(config.outputFile);
+    if (!out.is_open()) {
+        std::cerr << "Failed to open file: " << config.outputFile << std::endl;
+        return;
+    }
+    // One "all" row per type with the whole-network figures, then one row per layer
+    out << "type,batch_size,threads,layer,shape,images,seconds,images_per_sec,"
+        << "warmup_seconds,warmup_images_per_sec,us_per_batch" << std::endl;
+    out << std::setprecision(9);
+    for (const auto& r : results) {
+        out << r.type << "," << config.batchSize << "," << pool.size() << ",all,"
+            << network.InputCount() << "x" << network.OutputCount() << ","
+            << r.images << "," << r.seconds << "," << perSecond(r.images, r.seconds) << ","
+            << r.warmupSeconds << "," << perSecond(warmupImages, r.warmupSeconds) << ","
+            << 1e6 * r.seconds / r.batches * pool.size() << std::endl;
+        for (size_t l = 0; l < r.layerSeconds.size(); ++l) {
+            const Layer_t<double>& layer = network.layers[l];
+            out << r.type << "," << config.batchSize << "," << pool.size() << "," << l << ","
+                << layer.inputCount << "x" << layer.outputCount << ","
+                << r.images << "," << r.layerSeconds[l] << "," << perSecond(r.images, r.layerSeconds[l]) << ",,,"
+                << 1e6 * r.layerSeconds[l] / r.batches << std::endl;
+        }
+    }
+    std::cout << "\nResults written to " << config.outputFile << std::endl;
+}
@@ -0,0 +1,26 @@
+#if !defined(INFERENCE_BENCH_H)
+#define INFERENCE_BENCH_H
+
+#include "neural.h"
+#include "../common/benchmark.hpp"
+#include <string>
+
+namespace Neural {
+    struct InferenceBenchConfig {
+        size_t batchSize = 100;
+        size_t threads = 1;
+        int warmupPasses = 1;    // untimed passes over the images before measuring
+        int passes = 3;          // timed passes over the images
+        std::string outputFile;  // CSV results, empty to skip
+        BenchmarkOptions harness; // --bench-* options of the shared JSON-lines record
+    };
+
+    // Measure inference throughput of a network converted to double, half and
+    // hub_float. Batches are distributed over the threads; each type reports
+    // warm-up and steady-state images/second and the mean time per layer per batch.
+    // The per-pass times are also recorded through the shared benchmark harness.
+    void RunInferenceBenchmark(const LayeredNetwork& network, const Matrix& images,
+                               const InferenceBenchConfig& config);
+}
+
+#endif
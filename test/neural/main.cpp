@@ -21,12 +21,19 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "hub_float.hpp"
 #include "half.hpp"  // Added include for half-precision floating point
 #include "mnist_loader.h"
+#include "mixed_precision.h"
+#include "inference_bench.h"
+#include "model_file.h"
 #include <iomanip>
 #include <iostream>
 #include <algorithm>
 #include <random>
 #include <chrono>
 #include <cmath>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 
 using namespace Neural;
 using half = half_float::half;  // Create an alias for easier use
@@ -34,6 +41,8 @@ using half = half_float::half;  // Create an alias for easier use
 namespace {
     const int EPOCHS = 5;
     const double LEARNING_RATE = 0.1;
+    // Mini-batch updates use the mean gradient, so the step is scaled by the batch size
+    const double BATCH_LEARNING_RATE = 1.0;
     const int BATCH_SIZE = 100;
     const int HIDDEN_NEURONS = 128;
     
@@ -95,6 +104,112 @@ namespace {
         return 100.0 * static_cast<double>(correct) / static_cast<double>(total);
     }
 
+    // Batched accuracy of a layered or mixed-precision network whose inputs and
+    // outputs are of type T. Batches of BATCH_SIZE images are spread over the
+    // pool, if given; only the count of correct predictions is combined.
+    template<typename T, typename Network>
+    double calculateBatchedAccuracy(const Network& network, const Matrix& inputs, const Matrix& targets,
+                                    ThreadPool* pool) {
+        const size_t inputCount = network.InputCount();
+        const size_t outputCount = network.OutputCount();
+        const size_t total = inputs.size();
+        const size_t batches = (total + BATCH_SIZE - 1) / BATCH_SIZE;
+
+        auto countCorrect = [&](size_t firstBatch, size_t lastBatch, size_t) {
+            size_t correct = 0;
+            Vector_t<T> batch;
+            std::vector<Vector_t<T>> activations;
+            for (size_t start = firstBatch * BATCH_SIZE; start < std::min(lastBatch * BATCH_SIZE, total);
+                 start += BATCH_SIZE) {
+                size_t count = std::min(static_cast<size_t>(BATCH_SIZE), total - start);
+                batch.resize(count * inputCount);
+                for (size_t b = 0; b < count; ++b) {
+                    for (size_t j = 0; j < inputCount; ++j) {
+                        batch[b * inputCount + j] = static_cast<T>(inputs[start + b][j]);
+                    }
+                }
+
+                network.PredictBatch(batch.data(), count, activations);
+                const Vector_t<T>& output = activations.back();
+
+                for (size_t b = 0; b < count; ++b) {
+                    auto first = output.begin() + b * outputCount;
+                    size_t predicted_class = std::max_element(first, first + outputCount) - first;
+                    const auto& target = targets[start + b];
+                    size_t actual_class = std::max_element(target.begin(), target.end()) - target.begin();
+                    if (predicted_class == actual_class) {
+                        correct++;
+                    }
+                }
+            }
+            return correct;
+        };
+
+        const size_t correct = pool != nullptr
+            ? pool->parallel_reduce(0, batches, 1, static_cast<size_t>(0), countCorrect, std::plus<size_t>())
+            : countCorrect(0, batches, 0);
+        return 100.0 * static_cast<double>(correct) / static_cast<double>(total);
+    }
+
+    // Batched accuracy for layered networks
+    template<typename T>
+    double calculateAccuracy(const LayeredNetwork_t<T>& network, const Matrix& inputs, const Matrix& targets,
+                             ThreadPool* pool = nullptr) {
+        return calculateBatchedAccuracy<T>(network, inputs, targets, pool);
+    }
+
+    // Batched accuracy for mixed-precision networks
+    double calculateAccuracy(const MixedNetwork& network, const Matrix& inputs, const Matrix& targets,
+                             ThreadPool* pool = nullptr) {
+        return calculateBatchedAccuracy<double>(network, inputs, targets, pool);
+    }
+
+    // Raw output (pre-activation) RMSE of a layered network against the double reference
+    template<typename T>
+    double calculateLayeredRMSE(const LayeredNetwork_t<T>& network, const LayeredNetwork& reference,
+                                const Matrix& inputs, int max_samples = 1000) {
+        double total_squared_diff = 0.0;
+        size_t total_values = 0;
+        size_t num_samples = std::min(static_cast<size_t>(max_samples), inputs.size());
+        for (size_t i = 0; i < num_samples; ++i) {
+            Vector_t<T> input(inputs[i].size());
+            for (size_t j = 0; j < inputs[i].size(); ++j) {
+                input[j] = static_cast<T>(inputs[i][j]);
+            }
+            Vector_t<T> output = network.PredictRaw(input);
+            Vector ref = reference.PredictRaw(inputs[i]);
+            for (size_t j = 0; j < ref.size(); ++j) {
+                double diff = static_cast<double>(output[j]) - ref[j];
+                total_squared_diff += diff * diff;
+            }
+            total_values += ref.size();
+        }
+        return std::sqrt(total_squared_diff / total_values);
+    }
+
+    // Parse a comma separated list of layer widths, e.g. "128,64"
+    std::vector<size_t> parseWidths(const std::string& text) {
+        std::vector<size_t> widths;
+        std::stringstream ss(text);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            if (!item.empty()) {
+                widths.push_back(static_cast<size_t>(std::stoul(item)));
+            }
+        }
+        return widths;
+    }
+
+    // Returns false for an unknown activation name
+    bool parseActivation(const std::string& name, Activation& activation) {
+        if (name == "sigmoid") activation = Activation::Sigmoid;
+        else if (name == "relu") activation = Activation::Relu;
+        else if (name == "tanh") activation = Activation::Tanh;
+        else if (name == "identity") activation = Activation::Identity;
+        else return false;
+        return true;
+    }
+
     // Calculate RMSE between two output vectors
     template<typename T1, typename T2>
     double calculateRMSE(const Vector_t<T1>& output1, const Vector_t<T2>& output2) {
@@ -268,7 +383,316 @@ void compareRawOutputs(
 template<typename T>
 void show_weights(const Network_t<T>& network);
 
-int main() {
+// Mini-batch training in type T with the data-parallel trainer; returns the weights as doubles
+template<typename T>
+LayeredNetwork trainParallel(LayeredNetwork&& initial, const MNISTLoader& train_data,
+                             const MNISTLoader& test_data, size_t threads) {
+    ParallelTrainer_t<T> trainer = ParallelTrainer_t<T>::Create(
+        LayeredNetwork_t<T>::FromDouble(initial), threads);
+    std::cout << "Data-parallel training with " << trainer.pool->size() << " threads, batch size "
+              << BATCH_SIZE << std::endl;
+
+    std::vector<size_t> indices(train_data.images.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    std::default_random_engine rng(std::chrono::system_clock::now().time_since_epoch().count());
+    const T lr = static_cast<T>(BATCH_LEARNING_RATE);
+
+    for (int epoch = 0; epoch < EPOCHS; ++epoch) {
+        auto start = std::chrono::steady_clock::now();
+        std::shuffle(indices.begin(), indices.end(), rng);
+        for (size_t first = 0; first < indices.size(); first += BATCH_SIZE) {
+            size_t count = std::min(static_cast<size_t>(BATCH_SIZE), indices.size() - first);
+            trainer.TrainBatch(train_data.images, train_data.labels, indices.data() + first, count, lr);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double test_accuracy = calculateAccuracy(trainer.network, test_data.images, test_data.labels,
+                                                 trainer.pool.get());
+        std::cout << "Epoch " << epoch + 1 << "/" << EPOCHS
+                  << " completed in " << seconds << " s. Test accuracy: " << test_accuracy << "%" << std::endl;
+    }
+
+    LayeredNetwork trained;
+    for (const auto& layer : trainer.network.layers) {
+        trained.layers.push_back(Layer_t<double>::FromLayer(layer));
+    }
+    return trained;
+}
+
+// Train a network with an arbitrary list of hidden layers and compare precisions.
+// threads == 0 trains with per-sample SGD on the calling thread; otherwise the
+// data-parallel mini-batch trainer is used, in hub_float if hubTraining is set.
+LayeredNetwork runLayered(const MNISTLoader& train_data, const MNISTLoader& test_data,
+                          const std::vector<size_t>& hiddenWidths, Activation hiddenActivation,
+                          size_t threads, bool hubTraining) {
+    std::vector<size_t> widths;
+    widths.push_back(784);
+    widths.insert(widths.end(), hiddenWidths.begin(), hiddenWidths.end());
+    widths.push_back(10);
+
+    LayeredNetwork initial = CreateLayeredNetwork(widths, hiddenActivation, Activation::Sigmoid, Rand);
+
+    std::cout << "Training layered network:";
+    for (size_t w : widths) {
+        std::cout << " " << w;
+    }
+    std::cout << (hubTraining && threads > 0 ? " (hub_float)" : " (double)") << std::endl;
+
+    LayeredNetwork doubleNetwork;
+    if (threads > 0) {
+        doubleNetwork = hubTraining
+            ? trainParallel<hub_float>(std::move(initial), train_data, test_data, threads)
+            : trainParallel<double>(std::move(initial), train_data, test_data, threads);
+    } else {
+        LayeredTrainer trainer = LayeredTrainer::Create(std::move(initial));
+
+        std::vector<size_t> indices(train_data.images.size());
+        std::iota(indices.begin(), indices.end(), 0);
+        std::default_random_engine rng(std::chrono::system_clock::now().time_since_epoch().count());
+
+        for (int epoch = 0; epoch < EPOCHS; ++epoch) {
+            std::shuffle(indices.begin(), indices.end(), rng);
+            for (size_t idx : indices) {
+                trainer.Train(train_data.images[idx], train_data.labels[idx], LEARNING_RATE);
+            }
+
+            double test_accuracy = calculateAccuracy(trainer.network, test_data.images, test_data.labels);
+            std::cout << "Epoch " << epoch + 1 << "/" << EPOCHS
+                      << " completed. Test accuracy: " << test_accuracy << "%" << std::endl;
+        }
+        doubleNetwork = std::move(trainer.network);
+    }
+
+    LayeredNetwork_t<half> halfNetwork = LayeredNetwork_t<half>::FromDouble(doubleNetwork);
+    LayeredNetwork_t<hub_float> hubNetwork = LayeredNetwork_t<hub_float>::FromDouble(doubleNetwork);
+
+    ThreadPool pool(std::max(threads, static_cast<size_t>(1)));
+    std::cout << "\nTesting with different precision types..." << std::endl;
+    std::cout << "Double precision accuracy: "
+              << calculateAccuracy(doubleNetwork, test_data.images, test_data.labels, &pool) << "%" << std::endl;
+    std::cout << "Half precision accuracy: "
+              << calculateAccuracy(halfNetwork, test_data.images, test_data.labels, &pool) << "%" << std::endl;
+    std::cout << "hub_float precision accuracy: "
+              << calculateAccuracy(hubNetwork, test_data.images, test_data.labels, &pool) << "%" << std::endl;
+
+    std::cout << "\nRaw output RMSE (half-Double): " << std::scientific
+              << calculateLayeredRMSE(halfNetwork, doubleNetwork, test_data.images) << "\n";
+    std::cout << "Raw output RMSE (hub_float-Double): " << std::scientific
+              << calculateLayeredRMSE(hubNetwork, doubleNetwork, test_data.images) << std::endl;
+    return doubleNetwork;
+}
+
+// Storage cost of a network's weights and biases in bits
+size_t weightBits(const LayeredNetwork& network, const std::vector<LayerPrecision>& precisions) {
+    size_t bits = 0;
+    for (size_t l = 0; l < network.layers.size(); l++) {
+        const Layer_t<double>& layer = network.layers[l];
+        bits += (layer.weights.size() + layer.biases.size()) * FormatBits(precisions[l].weights);
+    }
+    return bits;
+}
+
+void printPrecisionResult(const LayeredNetwork& network, const std::vector<LayerPrecision>& precisions,
+                          double accuracy) {
+    const std::vector<LayerPrecision> reference(network.layers.size(),
+        LayerPrecision{NumericFormat::Double, NumericFormat::Double, NumericFormat::Double});
+    std::cout << std::fixed << std::setprecision(2) << "  accuracy " << accuracy << "%"
+              << ", weight storage " << (100.0 * weightBits(network, precisions) / weightBits(network, reference))
+              << "% of double" << std::endl;
+    for (size_t l = 0; l < precisions.size(); l++) {
+        std::cout << "  layer " << l << " (" << network.layers[l].inputCount << "x" << network.layers[l].outputCount
+                  << "): " << DescribePrecision(precisions[l]) << std::endl;
+    }
+}
+
+// Evaluate a trained network under per-layer format assignments (weights:activations:accumulator).
+// With a sweep tolerance, greedily choose the cheapest format for each layer and role, in order,
+// that keeps the test accuracy within the tolerance of the double network.
+void runMixedPrecision(const LayeredNetwork& network, const MNISTLoader& test_data,
+                       const std::vector<std::vector<LayerPrecision>>& configurations,
+                       bool sweep, double tolerance, size_t threads) {
+    const size_t layerCount = network.layers.size();
+    ThreadPool pool(std::max(threads, static_cast<size_t>(1)));
+    auto evaluate = [&](const std::vector<LayerPrecision>& precisions) {
+        MixedNetwork mixed = MixedNetwork::FromDouble(network, precisions);
+        return calculateAccuracy(mixed, test_data.images, test_data.labels, &pool);
+    };
+
+    std::cout << "\n==== Mixed-Precision Inference ====" << std::endl;
+    for (const auto& configuration : configurations) {
+        std::vector<LayerPrecision> precisions;
+        for (size_t l = 0; l < layerCount; l++) {
+            precisions.push_back(configuration[std::min(l, configuration.size() - 1)]);
+        }
+        std::cout << "Configuration:" << std::endl;
+        printPrecisionResult(network, precisions, evaluate(precisions));
+    }
+
+    if (!sweep) {
+        return;
+    }
+
+    const LayerPrecision full{NumericFormat::Double, NumericFormat::Double, NumericFormat::Double};
+    std::vector<LayerPrecision> precisions(layerCount, full);
+    const double baseline = evaluate(precisions);
+    std::cout << "\nSweep (tolerance " << tolerance << " points below " << baseline << "%):" << std::endl;
+
+    std::vector<NumericFormat> candidates = {
+        NumericFormat::Half, NumericFormat::Hub, NumericFormat::Float, NumericFormat::Double
+    };
+    std::stable_sort(candidates.begin(), candidates.end(), [](NumericFormat a, NumericFormat b) {
+        return FormatBits(a) < FormatBits(b);
+    });
+
+    double accuracy = baseline;
+    for (size_t l = 0; l < layerCount; l++) {
+        NumericFormat LayerPrecision::* roles[] = {
+            &LayerPrecision::weights, &LayerPrecision::activations, &LayerPrecision::accumulator
+        };
+        for (auto role : roles) {
+            for (NumericFormat format : candidates) {
+                if (format == NumericFormat::Double) {
+                    break;
+                }
+                std::vector<LayerPrecision> trial = precisions;
+                trial[l].*role = format;
+                double trialAccuracy = evaluate(trial);
+                if (trialAccuracy >= baseline - tolerance) {
+                    precisions = trial;
+                    accuracy = trialAccuracy;
+                    break;
+                }
+            }
+        }
+    }
+    printPrecisionResult(network, precisions, accuracy);
+}
+
+// Save the hub_float conversion of a trained network as a packed model file
+void saveModel(const std::string& path, const LayeredNetwork& network) {
+    if (SaveModel(path, LayeredNetwork_t<hub_float>::FromDouble(network))) {
+        std::cout << "\nSaved E" << EXP_BITS << "M" << MANT_BITS << " model to " << path << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // --layers 128,64 trains a network with the given hidden layer widths instead
+    // of the default single hidden layer; --activation selects the hidden activation.
+    // --precision evaluates the trained network with per-layer formats and may be
+    // repeated; --precision-sweep searches for the cheapest per-layer formats.
+    // --bench-inference skips training and measures inference throughput instead.
+    // --save-model writes the trained network as a packed hub_float model file;
+    // --load-model evaluates a saved model instead of training.
+    // --threads trains with the data-parallel mini-batch trainer (in hub_float with
+    // --train-type hub) and sets the inference benchmark thread count.
+    std::vector<size_t> hiddenWidths;
+    Activation hiddenActivation = Activation::Sigmoid;
+    std::vector<std::vector<LayerPrecision>> precisionConfigurations;
+    bool precisionSweep = false;
+    double sweepTolerance = 0.5;
+    bool benchInference = false;
+    InferenceBenchConfig benchConfig;
+    std::string saveModelPath;
+    std::string loadModelPath;
+    size_t threads = 0;
+    bool hubTraining = false;
+    bool usage = !benchConfig.harness.parse(argc, argv);
+    // std::stoul, std::stod and std::stoi throw on malformed or out-of-range numbers
+    try {
+        for (int i = 1; i < argc && !usage; ++i) {
+            if (std::strcmp(argv[i], "--layers") == 0 && i + 1 < argc) {
+                hiddenWidths = parseWidths(argv[++i]);
+            } else if (std::strcmp(argv[i], "--activation") == 0 && i + 1 < argc) {
+                usage = !parseActivation(argv[++i], hiddenActivation);
+            } else if (std::strcmp(argv[i], "--precision") == 0 && i + 1 < argc) {
+                std::vector<LayerPrecision> precisions;
+                usage = !ParsePrecisions(argv[++i], precisions);
+                precisionConfigurations.push_back(precisions);
+            } else if (std::strcmp(argv[i], "--precision-sweep") == 0 && i + 1 < argc) {
+                precisionSweep = true;
+                sweepTolerance = std::stod(argv[++i]);
+            } else if (std::strcmp(argv[i], "--bench-inference") == 0) {
+                benchInference = true;
+            } else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+                benchConfig.batchSize = std::max(static_cast<size_t>(std::stoul(argv[++i])), static_cast<size_t>(1));
+            } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+                threads = static_cast<size_t>(std::stoul(argv[++i]));
+            } else if (std::strcmp(argv[i], "--train-type") == 0 && i + 1 < argc) {
+                std::string type = argv[++i];
+                hubTraining = type == "hub";
+                usage = !hubTraining && type != "double";
+            } else if (std::strcmp(argv[i], "--passes") == 0 && i + 1 < argc) {
+                benchConfig.passes = std::max(std::stoi(argv[++i]), 1);
+            } else if (std::strcmp(argv[i], "--bench-output") == 0 && i + 1 < argc) {
+                benchConfig.outputFile = argv[++i];
+            } else if (std::strcmp(argv[i], "--save-model") == 0 && i + 1 < argc) {
+                saveModelPath = argv[++i];
+            } else if (std::strcmp(argv[i], "--load-model") == 0 && i + 1 < argc) {
+                loadModelPath = argv[++i];
+            } else {
+                usage = true;
+            }
+        }
+    } catch (const std::logic_error&) {
+        usage = true;
+    }
+    // Only the data-parallel trainer has a hub_float version
+    if (hubTraining && threads == 0) {
+        usage = true;
+    }
+    if (usage) {
+        std::cerr << "Usage: " << argv[0] << " [--layers W1,W2,...] [--activation sigmoid|relu|tanh|identity]\n"
+                  << "       [--precision W[:A[:ACC]],...] [--precision-sweep TOLERANCE]\n"
+                  << "       [--bench-inference [--batch N] [--threads N] [--passes N] [--bench-output FILE]\n"
+                  << "        " << BenchmarkOptions::usage() << "]\n"
+                  << "       [--save-model FILE | --load-model FILE]\n"
+                  << "       [--threads N [--train-type double|hub]]\n"
+                  << "Formats: double, float, half, hub" << std::endl;
+        return 1;
+    }
+    const bool mixedPrecision = !precisionConfigurations.empty() || precisionSweep;
+    benchConfig.threads = std::max(threads, static_cast<size_t>(1));
+
+    // Data-parallel training needs a layered network; use the default topology
+    if (threads > 0 && hiddenWidths.empty() && !benchInference) {
+        hiddenWidths.push_back(HIDDEN_NEURONS);
+    }
+
+    ModelFile model;
+    if (!loadModelPath.empty()) {
+        if (!model.Open(loadModelPath)) {
+            return 1;
+        }
+        std::cout << "Loaded model " << loadModelPath << ": E" << model.ExpBits() << "M" << model.MantBits()
+                  << ", " << model.LayerCount() << " layers";
+        for (size_t l = 0; l < model.LayerCount(); ++l) {
+            std::cout << (l == 0 ? " " : ",") << model.LayerInfo(l).inputCount << "x" << model.LayerInfo(l).outputCount;
+        }
+        std::cout << std::endl;
+    }
+
+    if (benchInference) {
+        // Throughput does not depend on the weight values, so the network is not trained
+        MNISTLoader bench_data;
+        if (!bench_data.load("t10k-images-idx3-ubyte", "t10k-labels-idx1-ubyte")) {
+            std::cerr << "Error loading test data" << std::endl;
+            return 1;
+        }
+        std::vector<size_t> widths;
+        widths.push_back(784);
+        if (hiddenWidths.empty()) {
+            widths.push_back(HIDDEN_NEURONS);
+        } else {
+            widths.insert(widths.end(), hiddenWidths.begin(), hiddenWidths.end());
+        }
+        widths.push_back(10);
+        LayeredNetwork network = loadModelPath.empty()
+            ? CreateLayeredNetwork(widths, hiddenActivation, Activation::Sigmoid, Rand)
+            : model.ToNetwork<double>();
+        RunInferenceBenchmark(network, bench_data.images, benchConfig);
+        return 0;
+    }
+
     std::cout << "Loading MNIST dataset..." << std::endl;
     
     MNISTLoader train_data;
@@ -288,6 +712,37 @@ int main() {
     
     std::cout << "Training data: " << train_data.images.size() << " samples" << std::endl;
     std::cout << "Test data: " << test_data.images.size() << " samples" << std::endl;
+
+    if (!loadModelPath.empty()) {
+        // Decoded values are exact, so the double network computes with the stored HUB weights
+        LayeredNetwork network = model.ToNetwork<double>();
+        std::cout << "Double accuracy with stored weights: "
+                  << calculateAccuracy(network, test_data.images, test_data.labels) << "%" << std::endl;
+        if (model.MatchesBuildFormat()) {
+            std::cout << "hub_float precision accuracy: "
+                      << calculateAccuracy(model.ToNetwork<hub_float>(), test_data.images, test_data.labels)
+                      << "%" << std::endl;
+        } else {
+            std::cout << "Model format differs from this build (E" << EXP_BITS << "M" << MANT_BITS
+                      << "), skipping hub_float evaluation" << std::endl;
+        }
+        if (mixedPrecision) {
+            runMixedPrecision(network, test_data, precisionConfigurations, precisionSweep, sweepTolerance, threads);
+        }
+        return 0;
+    }
+
+    if (!hiddenWidths.empty()) {
+        LayeredNetwork network = runLayered(train_data, test_data, hiddenWidths, hiddenActivation,
+                                            threads, hubTraining);
+        if (!saveModelPath.empty()) {
+            saveModel(saveModelPath, network);
+        }
+        if (mixedPrecision) {
+            runMixedPrecision(network, test_data, precisionConfigurations, precisionSweep, sweepTolerance, threads);
+        }
+        return 0;
+    }
     
     // Create neural network (784 inputs for 28x28 images, hidden layer, 10 outputs for digits 0-9)
     Trainer trainer = Trainer::Create(784, HIDDEN_NEURONS, 10, Rand);
@@ -407,6 +862,15 @@ int main() {
     // Add this new code to compare raw outputs with RMSE calculations
     compareRawOutputs(doubleNetwork, halfNetwork, hubNetwork, test_data.images, test_data.labels, 5);
 
+    if (!saveModelPath.empty()) {
+        saveModel(saveModelPath, LayeredNetwork::FromNetwork(doubleNetwork));
+    }
+
+    if (mixedPrecision) {
+        runMixedPrecision(LayeredNetwork::FromNetwork(doubleNetwork), test_data,
+                          precisionConfigurations, precisionSweep, sweepTolerance, threads);
+    }
+
     return 0;
 }
 
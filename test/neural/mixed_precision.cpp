@@ -0,0 +1,124 @@
+#include "mixed_precision.h"
+#include <sstream>
+
+using namespace Neural;
+using half = half_float::half;
+
+const char* Neural::FormatName(NumericFormat format) {
+    switch (format) {
+        case NumericFormat::Double: return "double";
+        case NumericFormat::Float: return "float";
+        case NumericFormat::Half: return "half";
+        case NumericFormat::Hub: return "hub";
+    }
+    return "unknown";
+}
+
+bool Neural::ParseFormat(const std::string& name, NumericFormat& format) {
+    if (name == "double") { format = NumericFormat::Double; return true; }
+    if (name == "float") { format = NumericFormat::Float; return true; }
+    if (name == "half") { format = NumericFormat::Half; return true; }
+    if (name == "hub" || name == "hub_float") { format = NumericFormat::Hub; return true; }
+    return false;
+}
+
+int Neural::FormatBits(NumericFormat format) {
+    switch (format) {
+        case NumericFormat::Double: return 64;
+        case NumericFormat::Float: return 32;
+        case NumericFormat::Half: return 16;
+        case NumericFormat::Hub: return 1 + EXP_BITS + MANT_BITS;
+    }
+    return 0;
+}
+
+bool Neural::ParsePrecisions(const std::string& text, std::vector<LayerPrecision>& precisions) {
+    precisions.clear();
+    std::stringstream layers(text);
+    std::string entry;
+    while (std::getline(layers, entry, ',')) {
+        std::vector<NumericFormat> roles;
+        std::stringstream parts(entry);
+        std::string name;
+        while (std::getline(parts, name, ':')) {
+            NumericFormat format;
+            if (!ParseFormat(name, format)) {
+                return false;
+            }
+            roles.push_back(format);
+        }
+        if (roles.empty() || roles.size() > 3) {
+            return false;
+        }
+        LayerPrecision precision;
+        precision.weights = roles[0];
+        precision.activations = roles.size() > 1 ? roles[1] : roles[0];
+        precision.accumulator = roles.size() > 2 ? roles[2] : roles[0];
+        precisions.push_back(precision);
+    }
+    return !precisions.empty();
+}
+
+std::string Neural::DescribePrecision(const LayerPrecision& precision) {
+    std::string text = FormatName(precision.weights);
+    text += ":";
+    text += FormatName(precision.activations);
+    text += ":";
+    text += FormatName(precision.accumulator);
+    return text;
+}
+
+namespace {
+    // Resolve the formats one template argument at a time
+    template<typename W, typename A>
+    std::unique_ptr<MixedLayerBase> makeWithAccumulator(const Layer_t<double>& layer, NumericFormat accumulator) {
+        switch (accumulator) {
+            case NumericFormat::Double: return std::make_unique<MixedLayer<W, A, double>>(layer);
+            case NumericFormat::Float: return std::make_unique<MixedLayer<W, A, float>>(layer);
+            case NumericFormat::Half: return std::make_unique<MixedLayer<W, A, half>>(layer);
+            case NumericFormat::Hub: return std::make_unique<MixedLayer<W, A, hub_float>>(layer);
+        }
+        return nullptr;
+    }
+
+    template<typename W>
+    std::unique_ptr<MixedLayerBase> makeWithActivations(const Layer_t<double>& layer, const LayerPrecision& precision) {
+        switch (precision.activations) {
+            case NumericFormat::Double: return makeWithAccumulator<W, double>(layer, precision.accumulator);
+            case NumericFormat::Float: return makeWithAccumulator<W, float>(layer, precision.accumulator);
+            case NumericFormat::Half: return makeWithAccumulator<W, half>(layer, precision.accumulator);
+            case NumericFormat::Hub: return makeWithAccumulator<W, hub_float>(layer, precision.accumulator);
+        }
+        return nullptr;
+    }
+}
+
+std::unique_ptr<MixedLayerBase> Neural::MakeMixedLayer(const Layer_t<double>& layer, const LayerPrecision& precision) {
+    switch (precision.weights) {
+        case NumericFormat::Double: return makeWithActivations<double>(layer, precision);
+        case NumericFormat::Float: return makeWithActivations<float>(layer, precision);
+        case NumericFormat::Half: return makeWithActivations<half>(layer, precision);
+        case NumericFormat::Hub: return makeWithActivations<hub_float>(layer, precision);
+    }
+    return nullptr;
+}
+
+void MixedNetwork::PredictBatch(const double* inputs, size_t batchSize, std::vector<Vector>& activations) const {
+    activations.resize(layers.size());
+    const double* x = inputs;
+    for (size_t l = 0; l < layers.size(); l++) {
+        activations[l].resize(batchSize * layers[l]->OutputCount());
+        layers[l]->Forward(x, batchSize, activations[l].data());
+        x = activations[l].data();
+    }
+}
+
+MixedNetwork MixedNetwork::FromDouble(const LayeredNetwork& network, const std::vector<LayerPrecision>& precisions) {
+    MixedNetwork mixed;
+    for (size_t l = 0; l < network.layers.size(); l++) {
+        const LayerPrecision& precision = precisions[std::min(l, precisions.size() - 1)];
+        mixed.layers.push_back(MakeMixedLayer(network.layers[l], precision));
+        mixed.precisions.push_back(precision);
+    }
+    return mixed;
+}
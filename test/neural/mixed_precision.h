@@ -0,0 +1,129 @@
+#if !defined(MIXED_PRECISION_H)
+#define MIXED_PRECISION_H
+
+#include "neural.h"
+#include "hub_float.hpp"
+#include "half.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Neural {
+    // Numeric formats that can be assigned to a tensor role of a layer.
+    // The hub_float format is the one selected at build time (EXP_BITS/MANT_BITS).
+    enum class NumericFormat {
+        Double,
+        Float,
+        Half,
+        Hub
+    };
+
+    // Formats used by one layer for each tensor role
+    struct LayerPrecision {
+        NumericFormat weights;
+        NumericFormat activations;
+        NumericFormat accumulator;
+    };
+
+    const char* FormatName(NumericFormat format);
+    bool ParseFormat(const std::string& name, NumericFormat& format);
+    int FormatBits(NumericFormat format);
+
+    // Parse "W[:A[:ACC]]" entries separated by commas, one per layer,
+    // e.g. "hub,half:half:float". Omitted roles take the weight format.
+    bool ParsePrecisions(const std::string& text, std::vector<LayerPrecision>& precisions);
+    std::string DescribePrecision(const LayerPrecision& precision);
+
+    // Batch conversion kernel used at layer boundaries
+    template<typename To, typename From>
+    void ConvertBatch(const From* input, size_t count, To* output) {
+        for (size_t i = 0; i < count; i++) {
+            output[i] = static_cast<To>(static_cast<double>(input[i]));
+        }
+    }
+
+    // Type-erased layer. Activations cross layer boundaries as doubles, which
+    // represent every supported format exactly, and are converted to the
+    // layer's own activation and accumulator types on entry and exit.
+    struct MixedLayerBase {
+        virtual ~MixedLayerBase() = default;
+        virtual size_t InputCount() const = 0;
+        virtual size_t OutputCount() const = 0;
+        virtual void Forward(const double* input, size_t batchSize, double* output) const = 0;
+    };
+
+    // Round an exact double result to T the way T's own arithmetic operators do
+    template<typename T>
+    inline T RoundResult(double x) {
+        return static_cast<T>(x);
+    }
+
+    template<>
+    inline hub_float RoundResult<hub_float>(double x) {
+        return hub_float(hub_float::quantize(x));
+    }
+
+    // Weights and biases are stored in W, inputs and outputs are rounded to A,
+    // and the dot products, bias addition and activation function are evaluated
+    // in Acc. Each product and bias sum is formed in double from the W value and
+    // rounded once to Acc, so a W wider than Acc is not rounded to Acc first.
+    // When Acc holds every W value this matches plain Acc arithmetic.
+    template<typename W, typename A, typename Acc>
+    struct MixedLayer : MixedLayerBase {
+        Layer_t<W> parameters;
+
+        explicit MixedLayer(const Layer_t<double>& layer) : parameters(Layer_t<W>::FromLayer(layer)) {}
+
+        size_t InputCount() const override { return parameters.inputCount; }
+        size_t OutputCount() const override { return parameters.outputCount; }
+
+        void Forward(const double* input, size_t batchSize, double* output) const override {
+            const size_t inputCount = parameters.inputCount;
+            const size_t outputCount = parameters.outputCount;
+            Vector_t<A> x(batchSize * inputCount);
+            Vector_t<Acc> xAcc(batchSize * inputCount);
+            Vector_t<Acc> y(outputCount);
+
+            ConvertBatch(input, x.size(), x.data());
+            ConvertBatch(x.data(), x.size(), xAcc.data());
+            // Same loop order as Layer_t::Forward
+            for (size_t b = 0; b < batchSize; b++) {
+                const Acc* xb = xAcc.data() + b * inputCount;
+                for (size_t c = 0; c < outputCount; c++) {
+                    y[c] = Acc(0);
+                }
+                for (size_t r = 0; r < inputCount; r++) {
+                    const double xr = static_cast<double>(xb[r]);
+                    const W* w = &parameters.weights[r * outputCount];
+                    for (size_t c = 0; c < outputCount; c++) {
+                        y[c] += RoundResult<Acc>(xr * static_cast<double>(w[c]));
+                    }
+                }
+                for (size_t c = 0; c < outputCount; c++) {
+                    const Acc sum = RoundResult<Acc>(static_cast<double>(y[c]) + static_cast<double>(parameters.biases[c]));
+                    output[b * outputCount + c] = static_cast<double>(static_cast<A>(static_cast<double>(
+                        activate(parameters.activation, sum))));
+                }
+            }
+        }
+    };
+
+    std::unique_ptr<MixedLayerBase> MakeMixedLayer(const Layer_t<double>& layer, const LayerPrecision& precision);
+
+    // Network whose layers may each use different formats
+    struct MixedNetwork {
+        std::vector<std::unique_ptr<MixedLayerBase>> layers;
+        std::vector<LayerPrecision> precisions;
+
+        size_t InputCount() const { return layers.empty() ? 0 : layers.front()->InputCount(); }
+        size_t OutputCount() const { return layers.empty() ? 0 : layers.back()->OutputCount(); }
+
+        void PredictBatch(const double* inputs, size_t batchSize, std::vector<Vector>& activations) const;
+
+        // Build from a double network. If fewer precisions than layers are
+        // given, the last one is used for the remaining layers.
+        static MixedNetwork FromDouble(const LayeredNetwork& network, const std::vector<LayerPrecision>& precisions);
+    };
+}
+
+#endif
@@ -0,0 +1,268 @@
+#include "model_file.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace Neural;
+
+namespace {
+    const char MAGIC[8] = {'H', 'U', 'B', 'M', 'O', 'D', 'E', 'L'};
+    const uint32_t VERSION = 1;
+    const size_t HEADER_SIZE = 32;
+    const size_t LAYER_ENTRY_SIZE = 32;
+
+    // Exponent bias of the hub_float format of this build
+#ifdef ORIGINAL_IEE_BIAS
+    const int BUILD_BIAS = (1 << (EXP_BITS - 1)) - 1;
+#else
+    const int BUILD_BIAS = (1 << (EXP_BITS - 1));
+#endif
+
+    void putU32(std::vector<uint8_t>& out, size_t pos, uint32_t v) {
+        for (int i = 0; i < 4; i++) out[pos + i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+
+    void putU64(std::vector<uint8_t>& out, size_t pos, uint64_t v) {
+        for (int i = 0; i < 8; i++) out[pos + i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+
+    uint32_t getU32(const uint8_t* p) {
+        uint32_t v = 0;
+        for (int i = 0; i < 4; i++) v |= static_cast<uint32_t>(p[i]) << (8 * i);
+        return v;
+    }
+
+    uint64_t getU64(const uint8_t* p) {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; i++) v |= static_cast<uint64_t>(p[i]) << (8 * i);
+        return v;
+    }
+
+    // Append width bits of value to an LSB-first bit stream starting at byte base
+    void writeBits(std::vector<uint8_t>& out, size_t base, uint64_t bitOffset, int width, uint64_t value) {
+        for (int written = 0; written < width; ) {
+            size_t byte = base + static_cast<size_t>((bitOffset + written) / 8);
+            int shift = static_cast<int>((bitOffset + written) % 8);
+            int count = std::min(8 - shift, width - written);
+            uint8_t chunk = static_cast<uint8_t>((value >> written) & ((1u << count) - 1));
+            out[byte] |= static_cast<uint8_t>(chunk << shift);
+            written += count;
+        }
+    }
+
+    uint64_t readBits(const uint8_t* stream, uint64_t bitOffset, int width) {
+        uint64_t value = 0;
+        for (int read = 0; read < width; ) {
+            uint8_t byte = stream[(bitOffset + read) / 8];
+            int shift = static_cast<int>((bitOffset + read) % 8);
+            int count = std::min(8 - shift, width - read);
+            value |= static_cast<uint64_t>((byte >> shift) & ((1u << count) - 1)) << read;
+            read += count;
+        }
+        return value;
+    }
+
+    size_t alignUp(size_t n) {
+        return (n + 7) & ~static_cast<size_t>(7);
+    }
+}
+
+bool Neural::SaveModel(const std::string& path, const LayeredNetwork_t<hub_float>& network) {
+    const int width = 1 + EXP_BITS + MANT_BITS;
+    const size_t layerCount = network.layers.size();
+
+    // Lay out the header, layer table and packed data
+    size_t dataStart = alignUp(HEADER_SIZE + layerCount * LAYER_ENTRY_SIZE);
+    std::vector<uint64_t> offsets(layerCount);
+    size_t end = dataStart;
+    for (size_t l = 0; l < layerCount; l++) {
+        const Layer_t<hub_float>& layer = network.layers[l];
+        offsets[l] = end;
+        uint64_t values = layer.weights.size() + layer.biases.size();
+        end = alignUp(end + static_cast<size_t>((values * width + 7) / 8));
+    }
+
+    std::vector<uint8_t> out(end, 0);
+    std::memcpy(out.data(), MAGIC, sizeof(MAGIC));
+    putU32(out, 8, VERSION);
+    putU32(out, 12, EXP_BITS);
+    putU32(out, 16, MANT_BITS);
+    putU32(out, 20, static_cast<uint32_t>(BUILD_BIAS));
+    putU32(out, 24, static_cast<uint32_t>(layerCount));
+
+    for (size_t l = 0; l < layerCount; l++) {
+        const Layer_t<hub_float>& layer = network.layers[l];
+        size_t entry = HEADER_SIZE + l * LAYER_ENTRY_SIZE;
+        putU32(out, entry, static_cast<uint32_t>(layer.inputCount));
+        putU32(out, entry + 4, static_cast<uint32_t>(layer.outputCount));
+        putU32(out, entry + 8, static_cast<uint32_t>(layer.activation));
+        putU64(out, entry + 16, offsets[l]);
+        putU64(out, entry + 24, layer.weights.size() + layer.biases.size());
+
+        uint64_t bit = 0;
+        for (const hub_float& w : layer.weights) {
+            writeBits(out, offsets[l], bit, width, w.toBits());
+            bit += width;
+        }
+        for (const hub_float& b : layer.biases) {
+            writeBits(out, offsets[l], bit, width, b.toBits());
+            bit += width;
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file: " << path << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()));
+    return static_cast<bool>(file);
+}
+
+double Neural::DecodeHubBits(uint64_t bits, int expBits, int mantBits, int bias) {
+    const uint64_t expMask = (1ULL << expBits) - 1;
+    const uint64_t fracMask = (1ULL << mantBits) - 1;
+    int sign = static_cast<int>((bits >> (expBits + mantBits)) & 0x1);
+    uint64_t customExp = (bits >> mantBits) & expMask;
+    uint64_t customFrac = bits & fracMask;
+
+    // Same special encodings as the hub_float raw-bits constructor
+    if (customExp == 0 && customFrac == 0) {
+        return sign ? -0.0 : 0.0;
+    }
+    if (customExp == (1ULL << (expBits - 1)) && customFrac == 0) {
+        return sign ? -1.0 : 1.0;
+    }
+    if (customExp == expMask && customFrac == fracMask) {
+        return sign ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+    }
+
+    const int shift = 52 - mantBits;
+    int64_t doubleExp = static_cast<int64_t>(customExp) + 1023 - bias;
+    uint64_t doubleFrac = (customFrac << shift) | (1ULL << (shift - 1));
+    uint64_t doubleBits = (static_cast<uint64_t>(sign) << 63) |
+                          (static_cast<uint64_t>(doubleExp) << 52) |
+                          doubleFrac;
+    double value;
+    std::memcpy(&value, &doubleBits, sizeof(value));
+    return value;
+}
+
+ModelFile::~ModelFile() {
+    Close();
+}
+
+void ModelFile::Close() {
+    if (data != nullptr) {
+        munmap(const_cast<uint8_t*>(data), size);
+    }
+    data = nullptr;
+    size = 0;
+    layerInfo.clear();
+    decoded.clear();
+}
+
+bool ModelFile::Open(const std::string& path) {
+    Close();
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open file: " << path << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < HEADER_SIZE) {
+        std::cerr << "Invalid model file: " << path << std::endl;
+        close(fd);
+        return false;
+    }
+    void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Failed to map file: " << path << std::endl;
+        return false;
+    }
+    data = static_cast<const uint8_t*>(mapped);
+    size = static_cast<size_t>(st.st_size);
+
+    if (std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0 || getU32(data + 8) != VERSION) {
+        std::cerr << "Unsupported model file: " << path << std::endl;
+        Close();
+        return false;
+    }
+    expBits = static_cast<int>(getU32(data + 12));
+    mantBits = static_cast<int>(getU32(data + 16));
+    bias = static_cast<int32_t>(getU32(data + 20));
+    size_t layerCount = getU32(data + 24);
+    // Every exponent field decodes to 2^(field - bias), which must be a normal
+    // double exponent for DecodeHubBits: -bias >= -1022, 2^expBits - 1 - bias <= 1023
+    if (expBits < 2 || expBits > 11 || mantBits < 1 || mantBits > 51 ||
+        bias > 1022 || bias < (1 << expBits) - 1024 ||
+        layerCount > (size - HEADER_SIZE) / LAYER_ENTRY_SIZE) {
+        std::cerr << "Invalid model file: " << path << std::endl;
+        Close();
+        return false;
+    }
+
+    const int width = 1 + expBits + mantBits;
+    for (size_t l = 0; l < layerCount; l++) {
+        const uint8_t* entry = data + HEADER_SIZE + l * LAYER_ENTRY_SIZE;
+        ModelLayerInfo info;
+        info.inputCount = getU32(entry);
+        info.outputCount = getU32(entry + 4);
+        const uint32_t activation = getU32(entry + 8);
+        info.activation = static_cast<Activation>(activation);
+        info.offset = getU64(entry + 16);
+        info.valueCount = getU64(entry + 24);
+        // Both counts are below 2^32, so the expected count cannot wrap in 64 bits;
+        // valueCount is bounded by the bits left in the file before it is multiplied
+        const uint64_t expectedCount = static_cast<uint64_t>(info.inputCount) * info.outputCount + info.outputCount;
+        if (activation > static_cast<uint32_t>(Activation::Identity) ||
+            info.valueCount != expectedCount || info.offset > size ||
+            info.valueCount > (static_cast<uint64_t>(size - info.offset) * 8) / width ||
+            (l > 0 && info.inputCount != layerInfo.back().outputCount)) {
+            std::cerr << "Invalid model file: " << path << std::endl;
+            Close();
+            return false;
+        }
+        layerInfo.push_back(info);
+    }
+    decoded.resize(layerCount);
+    return true;
+}
+
+bool ModelFile::MatchesBuildFormat() const {
+    return expBits == EXP_BITS && mantBits == MANT_BITS && bias == BUILD_BIAS;
+}
+
+const Layer_t<double>& ModelFile::GetLayer(size_t l) const {
+    if (!decoded[l]) {
+        const ModelLayerInfo& info = layerInfo[l];
+        const int width = 1 + expBits + mantBits;
+        const uint8_t* stream = data + info.offset;
+
+        auto layer = std::make_unique<Layer_t<double>>();
+        layer->inputCount = info.inputCount;
+        layer->outputCount = info.outputCount;
+        layer->activation = info.activation;
+        layer->weights.resize(info.inputCount * info.outputCount);
+        layer->biases.resize(info.outputCount);
+
+        uint64_t bit = 0;
+        for (double& w : layer->weights) {
+            w = DecodeHubBits(readBits(stream, bit, width), expBits, mantBits, bias);
+            bit += width;
+        }
+        for (double& b : layer->biases) {
+            b = DecodeHubBits(readBits(stream, bit, width), expBits, mantBits, bias);
+            bit += width;
+        }
+        decoded[l] = std::move(layer);
+    }
+    return *decoded[l];
+}
@@ -0,0 +1,97 @@
+#if !defined(MODEL_FILE_H)
+#define MODEL_FILE_H
+
+#include "neural.h"
+#include "hub_float.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+    Quantized model files
+
+    A model file stores a layered network with every weight and bias packed as a
+    raw HUB bit pattern of 1 + expBits + mantBits bits. All integers are little-endian.
+
+    Header (32 bytes):
+        char     magic[8]      "HUBMODEL"
+        uint32_t version       1
+        uint32_t expBits
+        uint32_t mantBits
+        int32_t  bias          exponent bias of the format
+        uint32_t layerCount
+        uint32_t reserved
+
+    Layer table (layerCount entries of 32 bytes):
+        uint32_t inputCount
+        uint32_t outputCount
+        uint32_t activation    Neural::Activation
+        uint32_t reserved
+        uint64_t offset        byte offset of the packed values from the start of the file
+        uint64_t valueCount    inputCount * outputCount weights followed by outputCount biases
+
+    Packed values are stored LSB-first: value i occupies stream bits
+    [i * width, (i + 1) * width), where stream bit k is bit (k % 8) of byte k / 8.
+    Each layer's data starts on an 8-byte boundary.
+*/
+namespace Neural {
+    struct ModelLayerInfo {
+        size_t inputCount;
+        size_t outputCount;
+        Activation activation;
+        uint64_t offset;
+        uint64_t valueCount;
+    };
+
+    // Write a hub_float network using the format of this build (EXP_BITS/MANT_BITS)
+    bool SaveModel(const std::string& path, const LayeredNetwork_t<hub_float>& network);
+
+    // Decode a raw HUB bit pattern of any format to the double it represents
+    double DecodeHubBits(uint64_t bits, int expBits, int mantBits, int bias);
+
+    // Read-only view of a model file. The file is memory-mapped and each layer is
+    // decoded on first access, so opening a model only reads its header.
+    class ModelFile {
+    public:
+        ModelFile() = default;
+        ~ModelFile();
+        ModelFile(const ModelFile&) = delete;
+        ModelFile& operator=(const ModelFile&) = delete;
+
+        bool Open(const std::string& path);
+        void Close();
+
+        int ExpBits() const { return expBits; }
+        int MantBits() const { return mantBits; }
+        int Bias() const { return bias; }
+        size_t LayerCount() const { return layerInfo.size(); }
+        const ModelLayerInfo& LayerInfo(size_t l) const { return layerInfo[l]; }
+
+        // True if the stored format is the hub_float format of this build
+        bool MatchesBuildFormat() const;
+
+        // Decoded layer values (exact, since every HUB format fits in a double)
+        const Layer_t<double>& GetLayer(size_t l) const;
+
+        template<typename T>
+        LayeredNetwork_t<T> ToNetwork() const {
+            LayeredNetwork_t<T> network;
+            for (size_t l = 0; l < LayerCount(); l++) {
+                network.layers.push_back(Layer_t<T>::FromLayer(GetLayer(l)));
+            }
+            return network;
+        }
+
+    private:
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        int expBits = 0;
+        int mantBits = 0;
+        int bias = 0;
+        std::vector<ModelLayerInfo> layerInfo;
+        mutable std::vector<std::unique_ptr<Layer_t<double>>> decoded;
+    };
+}
+
+#endif
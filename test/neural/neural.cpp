@@ -145,3 +145,25 @@ void Trainer::Train(const Vector& input, const Vector& y, double lr) {
         network.biasesHidden[c] -= lr * gradHidden[c];
     }
 }
+
+/* layered network */
+
+LayeredNetwork Neural::CreateLayeredNetwork(const std::vector<size_t>& widths,
+                                            Activation hiddenActivation,
+                                            Activation outputActivation,
+                                            std::function<double()> rand) {
+    LayeredNetwork network;
+    for (size_t l = 0; l + 1 < widths.size(); l++) {
+        Layer_t<double> layer;
+        layer.inputCount = widths[l];
+        layer.outputCount = widths[l + 1];
+        layer.activation = (l + 2 == widths.size()) ? outputActivation : hiddenActivation;
+        layer.weights.reserve(layer.inputCount * layer.outputCount);
+        for (size_t i = 0; i < layer.inputCount * layer.outputCount; i++) {
+            layer.weights.push_back(rand() - 0.5);
+        }
+        layer.biases = Vector(layer.outputCount);
+        network.layers.push_back(std::move(layer));
+    }
+    return network;
+}
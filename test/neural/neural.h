@@ -20,7 +20,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #if !defined(NEURAL_H)
 #define NEURAL_H
 
+#include "../common/thread_pool.hpp"
 #include <functional>
+#include <memory>
 #include <vector>
 
 namespace Neural {
@@ -94,6 +96,136 @@ namespace Neural {
         static Trainer Create(size_t inputCount, size_t hiddenCount, size_t outputCount, std::function<double()> rand);
         void Train(const Vector& input, const Vector& output, double lr);
     };
+
+    enum class Activation {
+        Sigmoid,
+        Relu,
+        Tanh,
+        Identity
+    };
+
+    // Dense layer: weights are stored row-major as inputCount x outputCount
+    // (weights[r * outputCount + c]), matching the layout of Network_t.
+    template<typename T>
+    struct Layer_t {
+        size_t inputCount;
+        size_t outputCount;
+        Activation activation;
+        Vector_t<T> weights;
+        Vector_t<T> biases;
+
+        // Compute batchSize rows of output (row-major, batchSize x outputCount)
+        // from batchSize rows of input (row-major, batchSize x inputCount).
+        void Forward(const T* input, size_t batchSize, T* output, bool applyActivation = true) const;
+
+        template<typename U>
+        static Layer_t<T> FromLayer(const Layer_t<U>& other) {
+            Layer_t<T> layer;
+            layer.inputCount = other.inputCount;
+            layer.outputCount = other.outputCount;
+            layer.activation = other.activation;
+            layer.weights.resize(other.weights.size());
+            for (size_t i = 0; i < other.weights.size(); i++) {
+                layer.weights[i] = static_cast<T>(static_cast<double>(other.weights[i]));
+            }
+            layer.biases.resize(other.biases.size());
+            for (size_t i = 0; i < other.biases.size(); i++) {
+                layer.biases[i] = static_cast<T>(static_cast<double>(other.biases[i]));
+            }
+            return layer;
+        }
+    };
+
+    // Feed-forward network made of an arbitrary number of dense layers.
+    template<typename T>
+    struct LayeredNetwork_t {
+        std::vector<Layer_t<T>> layers;
+
+        size_t InputCount() const { return layers.empty() ? 0 : layers.front().inputCount; }
+        size_t OutputCount() const { return layers.empty() ? 0 : layers.back().outputCount; }
+
+        Vector_t<T> Predict(const Vector_t<T>& input) const;
+
+        // Batched forward pass. inputs holds batchSize rows of InputCount() values;
+        // activations[l] receives the batchSize x layers[l].outputCount output of layer l
+        // and is resized as needed, so it can be reused across calls.
+        void PredictBatch(const T* inputs, size_t batchSize, std::vector<Vector_t<T>>& activations) const;
+
+        // Same as Predict, but the last layer's activation function is not applied
+        Vector_t<T> PredictRaw(const Vector_t<T>& input) const;
+
+        // Convert from a double-based network to a custom type network
+        static LayeredNetwork_t<T> FromDouble(const LayeredNetwork_t<double>& doubleNetwork) {
+            LayeredNetwork_t<T> network;
+            network.layers.reserve(doubleNetwork.layers.size());
+            for (const auto& layer : doubleNetwork.layers) {
+                network.layers.push_back(Layer_t<T>::FromLayer(layer));
+            }
+            return network;
+        }
+
+        // Express a single hidden layer network as a two layer sigmoid network
+        static LayeredNetwork_t<T> FromNetwork(const Network_t<T>& net) {
+            LayeredNetwork_t<T> network;
+            network.layers.push_back(Layer_t<T>{net.inputCount, net.hiddenCount, Activation::Sigmoid,
+                                                net.weightsHidden, net.biasesHidden});
+            network.layers.push_back(Layer_t<T>{net.hiddenCount, net.outputCount, Activation::Sigmoid,
+                                                net.weightsOutput, net.biasesOutput});
+            return network;
+        }
+    };
+
+    using LayeredNetwork = LayeredNetwork_t<double>;
+
+    // Create a randomly initialised network. widths lists every layer width,
+    // starting with the input count and ending with the output count.
+    LayeredNetwork CreateLayeredNetwork(const std::vector<size_t>& widths,
+                                        Activation hiddenActivation,
+                                        Activation outputActivation,
+                                        std::function<double()> rand);
+
+    // Per-sample SGD trainer for layered networks (MSE loss)
+    template<typename T>
+    struct LayeredTrainer_t {
+        LayeredNetwork_t<T> network;
+        std::vector<Vector_t<T>> activations;
+        std::vector<Vector_t<T>> deltas;
+        static LayeredTrainer_t<T> Create(LayeredNetwork_t<T>&& network);
+        void Train(const Vector_t<T>& input, const Vector_t<T>& y, T lr);
+    };
+
+    using LayeredTrainer = LayeredTrainer_t<double>;
+
+    // Data-parallel mini-batch SGD trainer for layered networks (MSE loss).
+    // Each mini-batch is cut into shards of ShardSize consecutive samples. Shards are
+    // processed concurrently, each into its own gradient buffers, and the buffers are
+    // summed in shard order before a single weight update. The shard size does not
+    // depend on the thread count, so results are identical for any number of threads.
+    template<typename T>
+    struct ParallelTrainer_t {
+        static constexpr size_t ShardSize = 10;
+
+        struct Shard {
+            std::vector<Vector_t<T>> weightGradients;
+            std::vector<Vector_t<T>> biasGradients;
+            std::vector<Vector_t<T>> activations;
+            std::vector<Vector_t<T>> deltas;
+            Vector_t<T> input;
+        };
+
+        LayeredNetwork_t<T> network;
+        std::vector<Shard> shards;
+        std::unique_ptr<ThreadPool> pool;
+
+        static ParallelTrainer_t<T> Create(LayeredNetwork_t<T>&& network, size_t threads);
+
+        // One SGD step on the samples inputs[indices[0..count)], using the mean gradient
+        void TrainBatch(const Matrix& inputs, const Matrix& targets, const size_t* indices, size_t count, T lr);
+
+    private:
+        Shard createShard() const;
+        void accumulate(Shard& shard, const Vector& input, const Vector& target) const;
+    };
 }
 
 // Template implementation
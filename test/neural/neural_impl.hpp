@@ -20,6 +20,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #if !defined(NEURAL_IMPL_HPP)
 #define NEURAL_IMPL_HPP
 
+#include <algorithm>
 #include <cmath>
 #include <hub_float.hpp>
 
@@ -37,6 +38,29 @@ namespace Neural {
             double exp_val = std::exp(-double(f));
             return hub_float(1.0) / (hub_float(1.0) + hub_float(exp_val));
         }
+
+        template<typename T>
+        T activate(Activation activation, T x) {
+            switch (activation) {
+                case Activation::Sigmoid: return sigmoid(x);
+                case Activation::Relu: return x > T(0) ? x : T(0);
+                case Activation::Tanh: return T(std::tanh(static_cast<double>(x)));
+                case Activation::Identity: break;
+            }
+            return x;
+        }
+
+        // Derivative of the activation function, expressed in terms of its output y
+        template<typename T>
+        T activationPrime(Activation activation, T y) {
+            switch (activation) {
+                case Activation::Sigmoid: return y * (T(1) - y);
+                case Activation::Relu: return y > T(0) ? T(1) : T(0);
+                case Activation::Tanh: return T(1) - y * y;
+                case Activation::Identity: break;
+            }
+            return T(1);
+        }
     }
 
     // Generic implementations for all other types
@@ -96,6 +120,217 @@ namespace Neural {
         
         return raw_output;
     }
+
+    /* layered network */
+
+    template<typename T>
+    void Layer_t<T>::Forward(const T* input, size_t batchSize, T* output, bool applyActivation) const {
+        // Accumulate one input row at a time so the weights are streamed row by row.
+        // Each output still sums its terms in input order, exactly like Network_t::Predict.
+        for (size_t b = 0; b < batchSize; b++) {
+            const T* x = input + b * inputCount;
+            T* y = output + b * outputCount;
+            for (size_t c = 0; c < outputCount; c++) {
+                y[c] = T(0);
+            }
+            for (size_t r = 0; r < inputCount; r++) {
+                const T xr = x[r];
+                const T* w = &weights[r * outputCount];
+                for (size_t c = 0; c < outputCount; c++) {
+                    y[c] += xr * w[c];
+                }
+            }
+            for (size_t c = 0; c < outputCount; c++) {
+                y[c] = applyActivation ? activate(activation, y[c] + biases[c]) : y[c] + biases[c];
+            }
+        }
+    }
+
+    template<typename T>
+    void LayeredNetwork_t<T>::PredictBatch(const T* inputs, size_t batchSize, std::vector<Vector_t<T>>& activations) const {
+        activations.resize(layers.size());
+        const T* x = inputs;
+        for (size_t l = 0; l < layers.size(); l++) {
+            activations[l].resize(batchSize * layers[l].outputCount);
+            layers[l].Forward(x, batchSize, activations[l].data());
+            x = activations[l].data();
+        }
+    }
+
+    template<typename T>
+    Vector_t<T> LayeredNetwork_t<T>::Predict(const Vector_t<T>& input) const {
+        std::vector<Vector_t<T>> activations;
+        PredictBatch(input.data(), 1, activations);
+        return activations.back();
+    }
+
+    template<typename T>
+    Vector_t<T> LayeredNetwork_t<T>::PredictRaw(const Vector_t<T>& input) const {
+        std::vector<Vector_t<T>> activations(layers.size());
+        const T* x = input.data();
+        for (size_t l = 0; l < layers.size(); l++) {
+            activations[l].resize(layers[l].outputCount);
+            layers[l].Forward(x, 1, activations[l].data(), l + 1 < layers.size());
+            x = activations[l].data();
+        }
+        return activations.back();
+    }
+
+    template<typename T>
+    LayeredTrainer_t<T> LayeredTrainer_t<T>::Create(LayeredNetwork_t<T>&& network) {
+        LayeredTrainer_t<T> trainer;
+        trainer.activations.resize(network.layers.size());
+        trainer.deltas.resize(network.layers.size());
+        for (size_t l = 0; l < network.layers.size(); l++) {
+            trainer.activations[l].resize(network.layers[l].outputCount);
+            trainer.deltas[l].resize(network.layers[l].outputCount);
+        }
+        trainer.network = std::move(network);
+        return trainer;
+    }
+
+    template<typename T>
+    void LayeredTrainer_t<T>::Train(const Vector_t<T>& input, const Vector_t<T>& y, T lr) {
+        auto& layers = network.layers;
+        network.PredictBatch(input.data(), 1, activations);
+
+        const size_t last = layers.size() - 1;
+        for (size_t c = 0; c < layers[last].outputCount; c++) {
+            const T out = activations[last][c];
+            deltas[last][c] = (out - y[c]) * activationPrime(layers[last].activation, out);
+        }
+
+        for (size_t l = layers.size(); l-- > 0; ) {
+            Layer_t<T>& layer = layers[l];
+            const T* x = (l == 0) ? input.data() : activations[l - 1].data();
+
+            // Propagate the error to the previous layer before its weights change
+            if (l > 0) {
+                for (size_t r = 0; r < layer.inputCount; r++) {
+                    T sum = T(0);
+                    for (size_t c = 0; c < layer.outputCount; c++) {
+                        sum += deltas[l][c] * layer.weights[r * layer.outputCount + c];
+                    }
+                    deltas[l - 1][r] = sum * activationPrime(layers[l - 1].activation, x[r]);
+                }
+            }
+
+            for (size_t r = 0; r < layer.inputCount; r++) {
+                for (size_t c = 0; c < layer.outputCount; c++) {
+                    layer.weights[r * layer.outputCount + c] -= lr * deltas[l][c] * x[r];
+                }
+            }
+
+            for (size_t c = 0; c < layer.outputCount; c++) {
+                layer.biases[c] -= lr * deltas[l][c];
+            }
+        }
+    }
+
+    /* data-parallel trainer */
+
+    template<typename T>
+    ParallelTrainer_t<T> ParallelTrainer_t<T>::Create(LayeredNetwork_t<T>&& network, size_t threads) {
+        ParallelTrainer_t<T> trainer;
+        trainer.network = std::move(network);
+        trainer.pool = std::make_unique<ThreadPool>(threads);
+        return trainer;
+    }
+
+    template<typename T>
+    typename ParallelTrainer_t<T>::Shard ParallelTrainer_t<T>::createShard() const {
+        Shard shard;
+        for (const auto& layer : network.layers) {
+            shard.weightGradients.emplace_back(layer.weights.size());
+            shard.biasGradients.emplace_back(layer.biases.size());
+            shard.activations.emplace_back(layer.outputCount);
+            shard.deltas.emplace_back(layer.outputCount);
+        }
+        shard.input.resize(network.InputCount());
+        return shard;
+    }
+
+    // Add the gradient of one sample to the shard's buffers
+    template<typename T>
+    void ParallelTrainer_t<T>::accumulate(Shard& shard, const Vector& input, const Vector& y) const {
+        const auto& layers = network.layers;
+        for (size_t i = 0; i < input.size(); i++) {
+            shard.input[i] = static_cast<T>(input[i]);
+        }
+        network.PredictBatch(shard.input.data(), 1, shard.activations);
+
+        auto& deltas = shard.deltas;
+        const size_t last = layers.size() - 1;
+        for (size_t c = 0; c < layers[last].outputCount; c++) {
+            const T out = shard.activations[last][c];
+            deltas[last][c] = (out - static_cast<T>(y[c])) * activationPrime(layers[last].activation, out);
+        }
+
+        for (size_t l = layers.size(); l-- > 0; ) {
+            const Layer_t<T>& layer = layers[l];
+            const T* x = (l == 0) ? shard.input.data() : shard.activations[l - 1].data();
+
+            if (l > 0) {
+                for (size_t r = 0; r < layer.inputCount; r++) {
+                    T sum = T(0);
+                    for (size_t c = 0; c < layer.outputCount; c++) {
+                        sum += deltas[l][c] * layer.weights[r * layer.outputCount + c];
+                    }
+                    deltas[l - 1][r] = sum * activationPrime(layers[l - 1].activation, x[r]);
+                }
+            }
+
+            Vector_t<T>& weightGradients = shard.weightGradients[l];
+            for (size_t r = 0; r < layer.inputCount; r++) {
+                for (size_t c = 0; c < layer.outputCount; c++) {
+                    weightGradients[r * layer.outputCount + c] += deltas[l][c] * x[r];
+                }
+            }
+
+            for (size_t c = 0; c < layer.outputCount; c++) {
+                shard.biasGradients[l][c] += deltas[l][c];
+            }
+        }
+    }
+
+    template<typename T>
+    void ParallelTrainer_t<T>::TrainBatch(const Matrix& inputs, const Matrix& targets,
+                                          const size_t* indices, size_t count, T lr) {
+        const size_t shardCount = (count + ShardSize - 1) / ShardSize;
+        while (shards.size() < shardCount) {
+            shards.push_back(createShard());
+        }
+
+        pool->parallel_for(0, shardCount, [&](size_t first, size_t last, size_t) {
+            for (size_t s = first; s < last; s++) {
+                Shard& shard = shards[s];
+                for (auto& g : shard.weightGradients) std::fill(g.begin(), g.end(), T(0));
+                for (auto& g : shard.biasGradients) std::fill(g.begin(), g.end(), T(0));
+                const size_t end = std::min(count, (s + 1) * ShardSize);
+                for (size_t i = s * ShardSize; i < end; i++) {
+                    accumulate(shard, inputs[indices[i]], targets[indices[i]]);
+                }
+            }
+        });
+
+        // Reduce in shard order and apply; parameters are split across threads
+        const T scale = lr / static_cast<T>(static_cast<double>(count));
+        auto update = [&](Vector_t<T>& params, std::vector<Vector_t<T>> Shard::* gradients, size_t l) {
+            pool->parallel_for(0, params.size(), [&](size_t first, size_t last, size_t) {
+                for (size_t i = first; i < last; i++) {
+                    T sum = (shards[0].*gradients)[l][i];
+                    for (size_t s = 1; s < shardCount; s++) {
+                        sum += (shards[s].*gradients)[l][i];
+                    }
+                    params[i] -= scale * sum;
+                }
+            });
+        };
+        for (size_t l = 0; l < network.layers.size(); l++) {
+            update(network.layers[l].weights, &Shard::weightGradients, l);
+            update(network.layers[l].biases, &Shard::biasGradients, l);
+        }
+    }
 }
 
 #endif // NEURAL_IMPL_HPP
@@ -0,0 +1,413 @@
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <iomanip>
+#include <fstream>
+#include "hub_float.hpp"
+#include "../common/io_utils.hpp"
+#include "../common/sparse_matrix.hpp"
+#include "../common/thread_pool.hpp"
+#include "../tblas_lapack/Krylov.h"
+
+// 5-point Laplacian on an n x n grid with Dirichlet boundaries
+std::vector<SparseEntry> laplacian_2d(size_t n) {
+    std::vector<SparseEntry> entries;
+    entries.reserve(5 * n * n);
+    for (size_t y = 0; y < n; ++y) {
+        for (size_t x = 0; x < n; ++x) {
+            const size_t i = y * n + x;
+            entries.push_back({i, i, 4.0});
+            if (x > 0) entries.push_back({i, i - 1, -1.0});
+            if (x + 1 < n) entries.push_back({i, i + 1, -1.0});
+            if (y > 0) entries.push_back({i, i - n, -1.0});
+            if (y + 1 < n) entries.push_back({i, i + n, -1.0});
+        }
+    }
+    return entries;
+}
+
+// Same stencil with dofs unknowns per grid node coupled by random dense
+// dofs x dofs blocks, the structure of a vector-valued PDE discretization
+std::vector<SparseEntry> block_laplacian_2d(size_t n, size_t dofs, std::mt19937& gen) {
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<SparseEntry> entries;
+    entries.reserve(5 * n * n * dofs * dofs);
+    auto add_block = [&](size_t node_i, size_t node_j, double scale) {
+        for (size_t r = 0; r < dofs; ++r) {
+            for (size_t c = 0; c < dofs; ++c) {
+                entries.push_back({node_i * dofs + r, node_j * dofs + c, scale * dist(gen)});
+            }
+        }
+    };
+    for (size_t y = 0; y < n; ++y) {
+        for (size_t x = 0; x < n; ++x) {
+            const size_t i = y * n + x;
+            add_block(i, i, 4.0);
+            if (x > 0) add_block(i, i - 1, 1.0);
+            if (x + 1 < n) add_block(i, i + 1, 1.0);
+            if (y > 0) add_block(i, i - n, 1.0);
+            if (y + 1 < n) add_block(i, i + n, 1.0);
+        }
+    }
+    return entries;
+}
+
+// Upwind 5-point convection-diffusion -u'' + c.grad(u) on an n x n grid, with
+// cell Peclet number peclet in both directions: nonsymmetric
+std::vector<SparseEntry> convection_diffusion_2d(size_t n, double peclet) {
+    std::vector<SparseEntry> entries;
+    entries.reserve(5 * n * n);
+    for (size_t y = 0; y < n; ++y) {
+        for (size_t x = 0; x < n; ++x) {
+            const size_t i = y * n + x;
+            entries.push_back({i, i, 4.0 + 2.0 * peclet});
+            if (x > 0) entries.push_back({i, i - 1, -1.0 - peclet});
+            if (x + 1 < n) entries.push_back({i, i + 1, -1.0});
+            if (y > 0) entries.push_back({i, i - n, -1.0 - peclet});
+            if (y + 1 < n) entries.push_back({i, i + n, -1.0});
+        }
+    }
+    return entries;
+}
+
+// Best time per call of fn over a few runs of enough calls to take ~0.1 s
+template<typename F>
+double time_per_call(F&& fn) {
+    auto seconds_for = [&](size_t calls) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t c = 0; c < calls; ++c) fn();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    size_t calls = 1;
+    while (seconds_for(calls) < 0.02 && calls < (1u << 20)) calls *= 2;
+    calls *= 4;
+    double best = 0.0;
+    for (int run = 0; run < 3; ++run) {
+        double seconds = seconds_for(calls) / calls;
+        if (run == 0 || seconds < best) best = seconds;
+    }
+    return best;
+}
+
+// max|y - ref| / max|ref|
+template<typename T>
+double relative_error(const std::vector<T>& y, const std::vector<double>& ref) {
+    double err = 0.0, scale = 0.0;
+    for (size_t i = 0; i < ref.size(); ++i) {
+        err = std::max(err, std::fabs(static_cast<double>(y[i]) - ref[i]));
+        scale = std::max(scale, std::fabs(ref[i]));
+    }
+    return scale > 0.0 ? err / scale : err;
+}
+
+// Times CSR and blocked-ELL products with A and A' in type T and reports their
+// error against the double products of the unrounded data
+template<typename T>
+void bench_spmv(const char* type, const std::string& name, const CsrMatrix<double>& A,
+                const std::vector<double>& x, const std::vector<double>& xt,
+                const std::vector<double>& ref, const std::vector<double>& ref_t,
+                size_t block, ThreadPool& pool, std::ofstream& csv) {
+    CsrMatrix<T> A_t(A);
+    BlockedEllMatrix<T> E_t(A_t, block);
+    std::vector<T> x_t(x.size()), xt_t(xt.size());
+    for (size_t i = 0; i < x.size(); ++i) x_t[i] = static_cast<T>(x[i]);
+    for (size_t i = 0; i < xt.size(); ++i) xt_t[i] = static_cast<T>(xt[i]);
+    std::vector<T> y(A.getRows()), y_t(A.getCols()), y_ell(A.getRows());
+
+    const double nnz = static_cast<double>(A.getNonZeros());
+    struct Kernel {
+        const char* name;
+        double seconds;
+        double error;
+    };
+    Kernel kernels[3];
+    kernels[0].name = "csr";
+    kernels[0].seconds = time_per_call([&] { A_t.multiply(x_t.data(), y.data(), &pool); });
+    kernels[0].error = relative_error(y, ref);
+    kernels[1].name = "csr_transpose";
+    kernels[1].seconds = time_per_call([&] { A_t.multiply_transpose(xt_t.data(), y_t.data(), &pool); });
+    kernels[1].error = relative_error(y_t, ref_t);
+    kernels[2].name = "blocked_ell";
+    kernels[2].seconds = time_per_call([&] { E_t.multiply(x_t.data(), y_ell.data(), &pool); });
+    kernels[2].error = relative_error(y_ell, ref);
+    const bool same = std::equal(y.begin(), y.end(), y_ell.begin(), [](const T& a, const T& b) {
+        return static_cast<double>(a) == static_cast<double>(b);
+    });
+
+    for (const Kernel& k : kernels) {
+        std::cout << std::setw(11) << name << std::setw(11) << type << std::setw(15) << k.name
+                  << std::setw(12) << std::setprecision(4) << k.seconds * 1e3
+                  << std::setw(12) << 2.0 * nnz / k.seconds * 1e-9
+                  << std::setw(12) << std::setprecision(3) << k.error << std::endl;
+        csv << name << "," << type << "," << k.name << "," << A.getRows() << "," << A.getNonZeros() << ","
+            << std::setprecision(9) << k.seconds << "," << k.error << std::endl;
+    }
+    if (!same) {
+        std::cout << "  note: blocked-ELL and CSR products differ in " << type << std::endl;
+    }
+    std::cout << "  blocked-ELL " << block << "x" << block << ": " << E_t.getWidth() << " tiles per block row, "
+              << std::setprecision(3) << E_t.getStoredValues() / nnz << " stored values per nonzero" << std::endl;
+}
+
+void run_matrix(const std::string& name, const CsrMatrix<double>& A, size_t block, ThreadPool& pool,
+                std::ofstream& csv) {
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<double> x(A.getCols()), xt(A.getRows());
+    for (double& v : x) v = dist(gen);
+    for (double& v : xt) v = dist(gen);
+    const std::vector<double> ref = A.multiply(x);
+    const std::vector<double> ref_t = A.multiply_transpose(xt);
+
+    std::cout << "\n" << name << ": " << A.getRows() << " x " << A.getCols() << ", "
+              << A.getNonZeros() << " nonzeros" << std::endl;
+    bench_spmv<float>("float", name, A, x, xt, ref, ref_t, block, pool, csv);
+    bench_spmv<double>("double", name, A, x, xt, ref, ref_t, block, pool, csv);
+    bench_spmv<hub_float>("hub_float", name, A, x, xt, ref, ref_t, block, pool, csv);
+}
+
+// The threaded products must write every entry of y, empty rows included, and
+// give the serial result. y starts filled with a sentinel.
+bool check_products(const std::string& name, const CsrMatrix<double>& A, ThreadPool& pool) {
+    const double sentinel = -777.0;
+    std::vector<double> x(A.getCols()), xt(A.getRows());
+    for (size_t i = 0; i < x.size(); ++i) x[i] = 1.0 + static_cast<double>(i);
+    for (size_t i = 0; i < xt.size(); ++i) xt[i] = 1.0 - static_cast<double>(i);
+    const BlockedEllMatrix<double> E(A, 2);
+    std::vector<double> serial(A.getRows(), sentinel), serial_t(A.getCols(), sentinel);
+    A.multiply(x.data(), serial.data());
+    A.multiply_transpose(xt.data(), serial_t.data());
+    bool ok = std::find(serial.begin(), serial.end(), sentinel) == serial.end()
+        && std::find(serial_t.begin(), serial_t.end(), sentinel) == serial_t.end();
+    auto compare = [&](const char* kernel, const std::vector<double>& y, const std::vector<double>& ref) {
+        if (y != ref) {
+            std::cout << "  " << name << ": threaded " << kernel << " differs from the serial product" << std::endl;
+            ok = false;
+        }
+    };
+    std::vector<double> y(A.getRows(), sentinel), y_t(A.getCols(), sentinel), y_ell(A.getRows(), sentinel);
+    A.multiply(x.data(), y.data(), &pool);
+    A.multiply_transpose(xt.data(), y_t.data(), &pool);
+    E.multiply(x.data(), y_ell.data(), &pool);
+    compare("csr", y, serial);
+    compare("csr_transpose", y_t, serial_t);
+    compare("blocked_ell", y_ell, serial);
+    std::cout << std::setw(16) << name << ": " << (ok ? "ok" : "FAILED") << std::endl;
+    return ok;
+}
+
+// --check: products of matrices with empty rows on a 4-thread pool
+bool run_checks() {
+    ThreadPool pool(4);
+    const std::vector<SparseEntry> top = {{0, 0, 1.0}, {1, 1, 2.0}, {2, 2, 3.0}};
+    const std::vector<SparseEntry> middle = {{0, 0, 1.0}, {0, 5, 2.0}, {5, 0, 3.0}, {5, 5, 4.0}};
+    const std::vector<SparseEntry> bottom = {{4, 1, 1.0}, {5, 2, 2.0}};
+    bool ok = check_products("trailing empty", CsrMatrix<double>(6, 6, top), pool);
+    ok &= check_products("middle empty", CsrMatrix<double>(6, 6, middle), pool);
+    ok &= check_products("leading empty", CsrMatrix<double>(6, 6, bottom), pool);
+    ok &= check_products("no nonzeros", CsrMatrix<double>(6, 6, {}), pool);
+    ok &= check_products("laplace2d", CsrMatrix<double>(32 * 32, 32 * 32, laplacian_2d(32)), pool);
+    std::cout << (ok ? "All checks passed" : "Some checks FAILED") << std::endl;
+    return ok;
+}
+
+// Solves A*x = b with CG or GMRES(restart) in vector type T and inner-product
+// type TA, starting from x = 0, and reports the iterations and time to reach
+// tol. The residual is that of the problem the solver sees, A and b rounded to
+// T, and is computed in double like the forward error
+template<typename T, typename TA, typename Op>
+void bench_krylov(const char* type, const char* dots, const std::string& problem, bool cg, size_t restart,
+                  size_t n, const Op& op, const CsrMatrix<double>& A, const std::vector<double>& b,
+                  const std::vector<double>& x_true, std::ofstream& csv) {
+    const double tol = 1e-7;
+    const size_t max_iterations = 5000;
+    std::vector<T> b_t(n), x(n);
+    for (size_t i = 0; i < n; ++i) b_t[i] = static_cast<T>(b[i]);
+
+    // Best of a few runs
+    size_t iterations = 0;
+    int info = 0;
+    double seconds = 0.0;
+    for (int run = 0; run < 3; ++run) {
+        std::fill(x.begin(), x.end(), T(0));
+        auto start = std::chrono::steady_clock::now();
+        if (cg) {
+            info = RNP::ConjugateGradient<T, TA>(n, op, b_t.data(), x.data(), tol, max_iterations, &iterations);
+        } else {
+            info = RNP::GMRES<T, TA>(n, op, b_t.data(), x.data(), restart, tol, max_iterations, &iterations);
+        }
+        double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (run == 0 || t < seconds) seconds = t;
+    }
+
+    const CsrMatrix<double> A_solved{CsrMatrix<T>(A)};
+    std::vector<double> xd(n), b_solved(n);
+    for (size_t i = 0; i < n; ++i) {
+        xd[i] = static_cast<double>(x[i]);
+        b_solved[i] = static_cast<double>(b_t[i]);
+    }
+    std::vector<double> r = A_solved.multiply(xd);
+    double rnorm = 0.0, bnorm = 0.0, enorm = 0.0, xnorm = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        rnorm += (b_solved[i] - r[i]) * (b_solved[i] - r[i]);
+        bnorm += b_solved[i] * b_solved[i];
+        enorm += (xd[i] - x_true[i]) * (xd[i] - x_true[i]);
+        xnorm += x_true[i] * x_true[i];
+    }
+    const double relres = std::sqrt(rnorm / bnorm);
+    const double error = std::sqrt(enorm / xnorm);
+    const char* status = (info == 0) ? "converged" : (info < 0 ? "max iterations" : "breakdown");
+
+    std::cout << std::setw(11) << problem << std::setw(7) << (cg ? "CG" : "GMRES")
+              << std::setw(11) << type << std::setw(8) << dots
+              << std::setw(7) << iterations << std::setw(11) << std::setprecision(4) << seconds
+              << std::setw(12) << std::setprecision(3) << relres << std::setw(12) << error
+              << "  " << status << std::endl;
+    csv << problem << "," << (cg ? "cg" : "gmres") << "," << type << "," << dots << "," << iterations << ","
+        << std::setprecision(9) << seconds << "," << relres << "," << error << "," << info << std::endl;
+}
+
+// Calls solve(b, x_true) for a random x_true and b = A*x_true
+template<typename Solve>
+void run_krylov_problem(const CsrMatrix<double>& A, Solve solve) {
+    std::mt19937 gen(11);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<double> x_true(A.getCols());
+    for (double& v : x_true) v = dist(gen);
+    const std::vector<double> b = A.multiply(x_true);
+    solve(b, x_true);
+}
+
+template<typename T, typename TA>
+void bench_krylov_sparse(const char* type, const char* dots, const std::string& problem, bool cg, size_t restart,
+                         const CsrMatrix<double>& A, const std::vector<double>& b,
+                         const std::vector<double>& x_true, ThreadPool& pool, std::ofstream& csv) {
+    CsrMatrix<T> A_t(A);
+    auto op = [&](const T* x, T* y) { A_t.multiply(x, y, &pool); };
+    bench_krylov<T, TA>(type, dots, problem, cg, restart, A.getRows(), op, A, b, x_true, csv);
+}
+
+template<typename T, typename TA>
+void bench_krylov_dense(const char* type, const char* dots, const std::string& problem, bool cg, size_t restart,
+                        const CsrMatrix<double>& A, const std::vector<double>& b,
+                        const std::vector<double>& x_true, std::ofstream& csv) {
+    const size_t n = A.getRows();
+    std::vector<T> a(n * n, T(0));
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t k = A.getRowPointers()[i]; k < A.getRowPointers()[i + 1]; ++k) {
+            a[i + A.getColumnIndices()[k] * n] = static_cast<T>(A.getValues()[k]);
+        }
+    }
+    RNP::DenseOperator<T> op(n, a.data(), n);
+    bench_krylov<T, TA>(type, dots, problem, cg, restart, n, op, A, b, x_true, csv);
+}
+
+void run_krylov_test(const std::string& data_dir, const std::string& mtx_file, ThreadPool& pool) {
+    std::string csv_file = data_dir + "/krylov.csv";
+    std::ofstream csv(csv_file);
+    csv << "problem,solver,type,inner_products,iterations,seconds,relative_residual,forward_error,info" << std::endl;
+
+    std::cout << "===== KRYLOV SOLVERS TO ||r|| <= 1e-7 ||b|| (" << pool.size() << " threads) =====" << std::endl;
+    std::cout << std::setw(11) << "problem" << std::setw(7) << "solver" << std::setw(11) << "type"
+              << std::setw(8) << "dots" << std::setw(7) << "iters" << std::setw(11) << "time (s)"
+              << std::setw(12) << "residual" << std::setw(12) << "fwd error" << std::endl;
+
+    const size_t restart = 30;
+    auto sparse = [&](const std::string& problem, const CsrMatrix<double>& A, bool cg) {
+        run_krylov_problem(A, [&](const std::vector<double>& b, const std::vector<double>& x_true) {
+            bench_krylov_sparse<float, float>("float", "float", problem, cg, restart, A, b, x_true, pool, csv);
+            bench_krylov_sparse<float, double>("float", "double", problem, cg, restart, A, b, x_true, pool, csv);
+            bench_krylov_sparse<double, double>("double", "double", problem, cg, restart, A, b, x_true, pool, csv);
+            bench_krylov_sparse<hub_float, hub_float>("hub_float", "hub", problem, cg, restart, A, b, x_true, pool, csv);
+            bench_krylov_sparse<hub_float, double>("hub_float", "double", problem, cg, restart, A, b, x_true, pool, csv);
+        });
+    };
+    auto dense = [&](const std::string& problem, const CsrMatrix<double>& A, bool cg) {
+        run_krylov_problem(A, [&](const std::vector<double>& b, const std::vector<double>& x_true) {
+            bench_krylov_dense<float, float>("float", "float", problem, cg, restart, A, b, x_true, csv);
+            bench_krylov_dense<float, double>("float", "double", problem, cg, restart, A, b, x_true, csv);
+            bench_krylov_dense<double, double>("double", "double", problem, cg, restart, A, b, x_true, csv);
+            bench_krylov_dense<hub_float, hub_float>("hub_float", "hub", problem, cg, restart, A, b, x_true, csv);
+            bench_krylov_dense<hub_float, double>("hub_float", "double", problem, cg, restart, A, b, x_true, csv);
+        });
+    };
+
+    if (!mtx_file.empty()) {
+        CsrMatrix<double> A = read_matrix_market<double>(mtx_file);
+        if (A.getRows() != A.getCols()) {
+            throw std::runtime_error("Krylov solvers need a square matrix");
+        }
+        sparse("mtx", A, true);
+        sparse("mtx", A, false);
+    } else {
+        sparse("laplace2d", CsrMatrix<double>(256 * 256, 256 * 256, laplacian_2d(256)), true);
+        sparse("convdiff", CsrMatrix<double>(128 * 128, 128 * 128, convection_diffusion_2d(128, 0.5)), false);
+        dense("dense_lap", CsrMatrix<double>(32 * 32, 32 * 32, laplacian_2d(32)), true);
+    }
+    std::cout << "\nResults written to " << csv_file << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t threads = ThreadPool::default_threads();
+    std::string mtx_file;
+    bool krylov = false;
+    bool check = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--krylov") == 0) {
+            krylov = true;
+        } else if (std::strcmp(argv[i], "--check") == 0) {
+            check = true;
+        } else if (argv[i][0] != '-' && mtx_file.empty()) {
+            mtx_file = argv[i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--threads N] [--krylov | --check] [matrix.mtx]" << std::endl;
+            return 1;
+        }
+    }
+    if (check) {
+        return run_checks() ? 0 : 1;
+    }
+    ThreadPool pool(threads);
+
+    std::string timestamp = get_timestamp();
+    std::string data_dir = "sparse_results_" + timestamp;
+    ensure_directory_exists(data_dir);
+    if (krylov) {
+        try {
+            run_krylov_test(data_dir, mtx_file, pool);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    std::string csv_file = data_dir + "/spmv.csv";
+    std::ofstream csv(csv_file);
+    csv << "matrix,type,kernel,rows,nonzeros,seconds,relative_error" << std::endl;
+
+    std::cout << "===== SPARSE MATRIX-VECTOR PRODUCTS (" << pool.size() << " threads) =====" << std::endl;
+    std::cout << std::setw(11) << "matrix" << std::setw(11) << "type" << std::setw(15) << "kernel"
+              << std::setw(12) << "time (ms)" << std::setw(12) << "GFLOP/s" << std::setw(12) << "rel error" << std::endl;
+    try {
+        if (!mtx_file.empty()) {
+            run_matrix("mtx", read_matrix_market<double>(mtx_file), 4, pool, csv);
+        } else {
+            std::mt19937 gen(1);
+            run_matrix("laplace2d", CsrMatrix<double>(512 * 512, 512 * 512, laplacian_2d(512)), 4, pool, csv);
+            run_matrix("block4", CsrMatrix<double>(4 * 128 * 128, 4 * 128 * 128, block_laplacian_2d(128, 4, gen)), 4, pool, csv);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "\nResults written to " << csv_file << std::endl;
+    return 0;
+}
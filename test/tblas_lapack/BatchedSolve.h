@@ -0,0 +1,204 @@
+#ifndef _RNP_BATCHED_SOLVE_H_
+#define _RNP_BATCHED_SOLVE_H_
+
+#include "TBLAS.h"
+#include <utility>
+#include <vector>
+
+// Batched solver for many small independent systems A_s*X_s = B_s.
+//
+// Interleaved layout: the systems are stored element by element, so that
+// consecutive memory holds the same element of consecutive systems. With a lane
+// stride ld >= batch, element (i,j) of system s is
+//   a[(i+j*n)*ld + s]   for the n x n matrices
+//   b[(i+j*n)*ld + s]   for the n x nRHS right-hand sides
+// A power of two ld maps the rows of the arrays onto the same cache sets; padding
+// it by a few elements avoids that.
+// The systems are solved in groups of _BatchedLaneOps<T>::W lanes. Each group is
+// copied to a contiguous buffer with the same interleaving, and every operation of the
+// factorization becomes a fixed-length loop over the lanes of the group, which
+// the compiler turns into SIMD instructions so that each vector lane works on its
+// own system. Groups are spread over the TBLAS thread pool (see SetThreadCount).
+//
+// Each system is solved with partial pivoting by the same operations, in the same
+// order, as RNP::LinearSolve, so the solutions have the same values.
+
+namespace RNP{
+
+// Fixed-length lane loops; the restrict qualifiers let them vectorize at -O2.
+// A group row is 32 bytes wide (8 floats, 4 doubles), which keeps a 32x32 group
+// within the L1 cache; wider groups measured slower.
+template <class T>
+struct _BatchedLaneOps{
+	static const size_t W = (sizeof(T) < 32) ? 32/sizeof(T) : 1;
+	// y += x*t
+	static void Axpy(T *__restrict y, const T *__restrict x, const T *__restrict t){
+		for(size_t l = 0; l < W; ++l){ y[l] += x[l]*t[l]; }
+	}
+	// y -= x*t
+	static void Axmy(T *__restrict y, const T *__restrict x, const T *__restrict t){
+		for(size_t l = 0; l < W; ++l){ y[l] -= x[l]*t[l]; }
+	}
+	static void Mul(T *__restrict y, const T *__restrict t){
+		for(size_t l = 0; l < W; ++l){ y[l] *= t[l]; }
+	}
+	static void Div(T *__restrict y, const T *__restrict t){
+		for(size_t l = 0; l < W; ++l){ y[l] /= t[l]; }
+	}
+	static void Neg(T *__restrict y, const T *__restrict x){
+		for(size_t l = 0; l < W; ++l){ y[l] = -x[l]; }
+	}
+};
+
+// LU factorization and solve of one group in a contiguous buffer: element (i,j)
+// of lane l at wa[(i+j*n)*W + l]. info[l] is set as in BatchedLinearSolve.
+template <class T>
+void _BatchedSolveGroup(size_t n, size_t nRHS, T *wa, T *wb, int *info){
+	typedef typename RNP::TBLAS::_RealOrComplexChooser<T>::real_type real_type;
+	typedef _BatchedLaneOps<T> ops;
+	const size_t W = ops::W;
+	size_t piv[W];
+	real_type pmax[W];
+	T t[W];
+	for(size_t l = 0; l < W; ++l){ info[l] = 0; }
+	for(size_t k = 0; k < n; ++k){
+		T *ak = &wa[k*n*W];
+		// Pivot search: the first row of largest magnitude, as MaximumIndex
+		for(size_t l = 0; l < W; ++l){
+			piv[l] = k;
+			pmax[l] = RNP::TBLAS::_RealOrComplexChooser<T>::_abs1(ak[k*W+l]);
+		}
+		for(size_t i = k+1; i < n; ++i){
+			for(size_t l = 0; l < W; ++l){
+				const real_type cur = RNP::TBLAS::_RealOrComplexChooser<T>::_abs1(ak[i*W+l]);
+				if(cur > pmax[l]){ piv[l] = i; pmax[l] = cur; }
+			}
+		}
+		// Row interchanges differ per lane
+		for(size_t l = 0; l < W; ++l){
+			const size_t p = piv[l];
+			if(p == k){ continue; }
+			for(size_t j = 0; j < n; ++j){
+				std::swap(wa[(k+j*n)*W+l], wa[(p+j*n)*W+l]);
+			}
+			for(size_t j = 0; j < nRHS; ++j){
+				std::swap(wb[(k+j*n)*W+l], wb[(p+j*n)*W+l]);
+			}
+		}
+		for(size_t l = 0; l < W; ++l){
+			const T akk = ak[k*W+l];
+			if(T(0) == akk){
+				if(0 == info[l]){ info[l] = (int)k+1; }
+				t[l] = T(0); // the column below is zero as well
+			}else{
+				t[l] = T(1)/akk;
+			}
+		}
+		for(size_t i = k+1; i < n; ++i){
+			ops::Mul(&ak[i*W], t);
+		}
+		// Rank-1 update of the trailing matrix
+		for(size_t j = k+1; j < n; ++j){
+			T *aj = &wa[j*n*W];
+			ops::Neg(t, &aj[k*W]);
+			for(size_t i = k+1; i < n; ++i){
+				ops::Axpy(&aj[i*W], &ak[i*W], t);
+			}
+		}
+	}
+
+	// Forward and back substitution, L unit lower and U upper triangular
+	for(size_t j = 0; j < nRHS; ++j){
+		T *bj = &wb[j*n*W];
+		for(size_t k = 0; k < n; ++k){
+			const T *ak = &wa[k*n*W];
+			for(size_t l = 0; l < W; ++l){ t[l] = bj[k*W+l]; }
+			for(size_t i = k+1; i < n; ++i){
+				ops::Axmy(&bj[i*W], t, &ak[i*W]);
+			}
+		}
+		for(size_t k = n; k-- > 0; ){
+			const T *ak = &wa[k*n*W];
+			ops::Div(&bj[k*W], &ak[k*W]);
+			for(size_t l = 0; l < W; ++l){ t[l] = bj[k*W+l]; }
+			for(size_t i = 0; i < k; ++i){
+				ops::Axmy(&bj[i*W], t, &ak[i*W]);
+			}
+		}
+	}
+}
+
+// Solves the batch systems A_s*X_s = B_s in the interleaved layout above. A is
+// overwritten by the LU factors and B by X. info[s] receives 0, or the 1-based
+// index of the first exactly zero pivot of system s, in which case its X is not
+// meaningful.
+template <class T>
+void BatchedLinearSolve(size_t n, size_t nRHS, size_t batch, T *a, size_t ld, T *b, int *info){
+	if(0 == n || 0 == batch){ return; }
+	const size_t W = _BatchedLaneOps<T>::W;
+	auto groups = [&](size_t s0, size_t s1){
+		std::vector<T> wa(n*n*W), wb(n*nRHS*W);
+		int ginfo[_BatchedLaneOps<T>::W];
+		for(size_t g = s0; g < s1; g += W){
+			const size_t lanes = (s1-g < W) ? s1-g : W;
+			if(lanes < W){ // the missing lanes of a partial group solve I*x = 0
+				for(size_t e = 0; e < n*n; ++e){
+					for(size_t l = lanes; l < W; ++l){ wa[e*W+l] = T(0); }
+				}
+				for(size_t e = 0; e < n*n; e += n+1){
+					for(size_t l = lanes; l < W; ++l){ wa[e*W+l] = T(1); }
+				}
+				for(size_t e = 0; e < n*nRHS; ++e){
+					for(size_t l = lanes; l < W; ++l){ wb[e*W+l] = T(0); }
+				}
+			}
+			for(size_t e = 0; e < n*n; ++e){
+				for(size_t l = 0; l < lanes; ++l){ wa[e*W+l] = a[e*ld+g+l]; }
+			}
+			for(size_t e = 0; e < n*nRHS; ++e){
+				for(size_t l = 0; l < lanes; ++l){ wb[e*W+l] = b[e*ld+g+l]; }
+			}
+			_BatchedSolveGroup(n, nRHS, &wa[0], &wb[0], ginfo);
+			for(size_t e = 0; e < n*n; ++e){
+				for(size_t l = 0; l < lanes; ++l){ a[e*ld+g+l] = wa[e*W+l]; }
+			}
+			for(size_t e = 0; e < n*nRHS; ++e){
+				for(size_t l = 0; l < lanes; ++l){ b[e*ld+g+l] = wb[e*W+l]; }
+			}
+			for(size_t l = 0; l < lanes; ++l){ info[g+l] = ginfo[l]; }
+		}
+	};
+	const double work = double(batch)*n*n*(n+nRHS);
+	if(!RNP::TBLAS::_ParallelFor(batch, W, work, groups)){
+		groups(0, batch);
+	}
+}
+
+// Copy batch column-major m x n matrices, matrix s at src[s*stride] with leading
+// dimension lds, into the interleaved layout with lane stride ld, and back
+template <class T>
+void BatchedInterleave(size_t m, size_t n, size_t batch, const T *src, size_t lds, size_t stride, T *dst, size_t ld){
+	for(size_t j = 0; j < n; ++j){
+		for(size_t i = 0; i < m; ++i){
+			T *row = &dst[(i+j*m)*ld];
+			for(size_t s = 0; s < batch; ++s){
+				row[s] = src[s*stride+i+j*lds];
+			}
+		}
+	}
+}
+template <class T>
+void BatchedDeinterleave(size_t m, size_t n, size_t batch, const T *src, size_t ld, T *dst, size_t ldd, size_t stride){
+	for(size_t j = 0; j < n; ++j){
+		for(size_t i = 0; i < m; ++i){
+			const T *row = &src[(i+j*m)*ld];
+			for(size_t s = 0; s < batch; ++s){
+				dst[s*stride+i+j*ldd] = row[s];
+			}
+		}
+	}
+}
+
+} // namespace RNP
+
+#endif // _RNP_BATCHED_SOLVE_H_
@@ -0,0 +1,39 @@
+#ifndef _RNP_EIGENSYSTEM_H_
+#define _RNP_EIGENSYSTEM_H_
+
+#include "TBLAS.h"
+#include "TLASupport.h"
+#include <vector>
+
+namespace RNP{
+
+// Computes all eigenvalues and, for jobz = 'V', the eigenvectors of the real
+// symmetric n by n matrix A (as dsyev): A is reduced to tridiagonal form by
+// TridiagonalReduction, whose Q is formed and updated by the QL iteration of
+// SymmetricTridiagonalQL into the eigenvectors. Only the lower triangle of A is
+// referenced. On exit w holds the eigenvalues in ascending order and, for
+// jobz = 'V', column j of A the orthonormal eigenvector of w[j]; otherwise A is
+// destroyed. Returns 0, or the number of off-diagonal elements of the
+// tridiagonal matrix that did not converge to zero.
+template <char jobz = 'V', class T> // zheev, dsyev, cheev, ssyev
+int SymmetricEigensystem(size_t n, T *a, size_t lda, T *w){
+	if(0 == n){ return 0; }
+	if(1 == n){
+		w[0] = a[0];
+		if('V' == jobz){ a[0] = T(1); }
+		return 0;
+	}
+
+	std::vector<T> e(n-1), tau(n-1);
+	RNP::TLASupport::TridiagonalReduction(n, a, lda, w, &e[0], &tau[0]);
+	if('V' == jobz){
+		std::vector<T> work(n-1);
+		RNP::TLASupport::GenerateOrthogonalMatrixFromTridiagonalReduction(n, a, lda, &tau[0], &work[0]);
+		return RNP::TLASupport::SymmetricTridiagonalQL(n, w, &e[0], a, lda);
+	}
+	return RNP::TLASupport::SymmetricTridiagonalQL(n, w, &e[0], (T*)NULL, 0);
+}
+
+} // namespace RNP
+
+#endif // _RNP_EIGENSYSTEM_H_
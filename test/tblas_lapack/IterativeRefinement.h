@@ -0,0 +1,91 @@
+#ifndef _RNP_ITERATIVE_REFINEMENT_H_
+#define _RNP_ITERATIVE_REFINEMENT_H_
+
+#include "TBLAS.h"
+#include "TLASupport.h"
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace RNP{
+
+// Solves A*X = B for double A and B by factoring A in a lower precision TF and
+// refining X with residuals computed in double (as in dsgesv).
+//   X_0 = inv(LU)*B, then repeat R = B - A*X_i, X_{i+1} = X_i + inv(LU)*R
+// The LU factors and the corrections are computed in TF; the residuals, the
+// update of X and the convergence test are in double. Iteration stops once every
+// column satisfies
+//   ||R||_inf <= sqrt(n) * eps * ||A||_inf * ||X||_inf   (eps of double)
+// On return *iterations holds the number of corrections applied. The result is 0
+// on convergence, -1 if max_iterations corrections did not converge (X holds the
+// last iterate), or the 1-based index of the first zero pivot of the TF factors.
+template <class TF>
+int RefinedLinearSolve(size_t n, size_t nRHS, const double *a, size_t lda, const double *b, size_t ldb,
+	double *x, size_t ldx, size_t *iterations, size_t max_iterations = 30)
+{
+	*iterations = 0;
+	if(0 == n || 0 == nRHS){ return 0; }
+
+	// Factor a rounded copy of A
+	std::vector<TF> af(n*n);
+	for(size_t j = 0; j < n; ++j){
+		for(size_t i = 0; i < n; ++i){
+			af[i+j*n] = TF(a[i+j*lda]);
+		}
+	}
+	std::vector<size_t> ipiv(n);
+	int info = RNP::TLASupport::LUDecomposition(n, n, &af[0], n, &ipiv[0]);
+	if(0 != info){ return info; }
+
+	std::vector<TF> wf(n*nRHS);
+	for(size_t j = 0; j < nRHS; ++j){
+		for(size_t i = 0; i < n; ++i){
+			wf[i+j*n] = TF(b[i+j*ldb]);
+		}
+	}
+	RNP::TLASupport::LUSolve<'N'>(n, nRHS, &af[0], n, &ipiv[0], &wf[0], n);
+	for(size_t j = 0; j < nRHS; ++j){
+		for(size_t i = 0; i < n; ++i){
+			x[i+j*ldx] = double(wf[i+j*n]);
+		}
+	}
+
+	std::vector<double> work(n);
+	double anorm;
+	RNP::TLASupport::CheapMatrixNorm<'I'>(n, n, a, lda, &anorm, &work[0]);
+	const double cte = anorm * std::numeric_limits<double>::epsilon() * std::sqrt(double(n));
+
+	std::vector<double> r(n*nRHS);
+	for(;;){
+		for(size_t j = 0; j < nRHS; ++j){
+			for(size_t i = 0; i < n; ++i){
+				r[i+j*n] = b[i+j*ldb];
+			}
+		}
+		RNP::TBLAS::MultMM<'N','N'>(n, nRHS, n, -1.0, a, lda, x, ldx, 1.0, &r[0], n);
+
+		bool converged = true;
+		for(size_t j = 0; j < nRHS && converged; ++j){
+			const double xnrm = std::abs(x[RNP::TBLAS::MaximumIndex(n, &x[0+j*ldx], 1)+j*ldx]);
+			const double rnrm = std::abs(r[RNP::TBLAS::MaximumIndex(n, &r[0+j*n], 1)+j*n]);
+			converged = (rnrm <= xnrm * cte);
+		}
+		if(converged){ return 0; }
+		if(*iterations == max_iterations){ return -1; }
+
+		for(size_t i = 0; i < n*nRHS; ++i){
+			wf[i] = TF(r[i]);
+		}
+		RNP::TLASupport::LUSolve<'N'>(n, nRHS, &af[0], n, &ipiv[0], &wf[0], n);
+		for(size_t j = 0; j < nRHS; ++j){
+			for(size_t i = 0; i < n; ++i){
+				x[i+j*ldx] += double(wf[i+j*n]);
+			}
+		}
+		++(*iterations);
+	}
+}
+
+} // namespace RNP
+
+#endif // _RNP_ITERATIVE_REFINEMENT_H_
@@ -0,0 +1,200 @@
+#ifndef _RNP_KRYLOV_H_
+#define _RNP_KRYLOV_H_
+
+#include "TBLAS.h"
+#include "TLASupport.h"
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+// Krylov subspace solvers for A*x = b with real A given as an operator: any
+// callable op(x, y) that sets y = A*x for n-vectors. DenseOperator wraps a
+// column-major matrix; a sparse matrix plugs in through a lambda, e.g.
+//   [&](const T *x, T *y){ A.multiply(x, y, &pool); }
+//
+// Vectors are kept in T and updated with the TBLAS level 1 routines. Inner
+// products and norms are carried in TA, which defaults to T; with a wider TA
+// (float or hub_float vectors, double TA) the sums are accumulated in TA and
+// only rounded to T where they scale a vector.
+
+namespace RNP{
+
+template <class T>
+struct DenseOperator{
+	size_t n;
+	const T *a;
+	size_t lda;
+	DenseOperator(size_t n, const T *a, size_t lda):n(n),a(a),lda(lda){}
+	void operator()(const T *x, T *y) const{
+		RNP::TBLAS::MultMV<'N'>(n, n, T(1), a, lda, x, 1, T(0), y, 1);
+	}
+};
+
+// x'*y, summed in TA; TBLAS::Dot when TA is T
+template <class TA, class T>
+TA _KrylovDot(size_t n, const T *x, const T *y){
+	if(std::is_same<TA,T>::value){
+		return TA(RNP::TBLAS::Dot(n, x, 1, y, 1));
+	}
+	TA sum(0);
+	for(size_t i = 0; i < n; ++i){
+		sum += TA(x[i])*TA(y[i]);
+	}
+	return sum;
+}
+
+// ||x||_2 in TA; the scaled TBLAS::Norm2 when TA is T
+template <class TA, class T>
+TA _KrylovNorm2(size_t n, const T *x){
+	using namespace std;
+	if(std::is_same<TA,T>::value){
+		return TA(RNP::TBLAS::Norm2(n, x, 1));
+	}
+	return TA(sqrt(_KrylovDot<TA>(n, x, x)));
+}
+
+// Conjugate gradients for symmetric positive definite A. On entry x holds the
+// initial guess. Iterates until the recurrence residual satisfies
+//   ||r||_2 <= tol * ||b||_2
+// and then recomputes r = b - A*x. Convergence is only accepted if that
+// residual satisfies the test too; otherwise CG restarts from it, so rounding
+// in T cannot make the recurrence report convergence early. On return
+// *iterations holds the number of iterations (the residual recomputations are
+// not counted) and, if given, *relres the last ||r||_2/||b||_2, recomputed on
+// convergence. Returns 0 on convergence, -1 if max_iterations were not enough,
+// or 1 if p'*A*p <= 0 (A is not positive definite in T).
+template <class T, class TA = T, class Op>
+int ConjugateGradient(size_t n, const Op &op, const T *b, T *x, double tol, size_t max_iterations,
+	size_t *iterations, double *relres = NULL)
+{
+	*iterations = 0;
+	if(NULL != relres){ *relres = 0; }
+	if(0 == n){ return 0; }
+
+	std::vector<T> r(n), p(n), ap(n);
+	const TA bnorm = _KrylovNorm2<TA>(n, b);
+	const TA target = (TA(0) == bnorm ? TA(1) : bnorm) * TA(tol);
+	TA rho(0);
+	bool restart = true; // r = b - A*x is recomputed and p reset to it
+	for(;;){
+		using namespace std;
+		if(restart){
+			op(x, &r[0]);
+			for(size_t i = 0; i < n; ++i){ r[i] = b[i] - r[i]; }
+			RNP::TBLAS::Copy(n, &r[0], 1, &p[0], 1);
+			rho = _KrylovDot<TA>(n, &r[0], &r[0]);
+		}
+		const TA rnorm = TA(sqrt(rho));
+		if(NULL != relres){ *relres = double(rnorm) / double(TA(0) == bnorm ? TA(1) : bnorm); }
+		if(rnorm <= target){
+			if(restart){ return 0; }
+			// Accept only if the true residual agrees
+			restart = true;
+			continue;
+		}
+		restart = false;
+		if(*iterations == max_iterations){ return -1; }
+
+		op(&p[0], &ap[0]);
+		const TA pap = _KrylovDot<TA>(n, &p[0], &ap[0]);
+		if(!(pap > TA(0))){ return 1; }
+		const TA alpha = rho / pap;
+		RNP::TBLAS::Axpy(n, T(alpha), &p[0], 1, x, 1);
+		RNP::TBLAS::Axpy(n, T(-alpha), &ap[0], 1, &r[0], 1);
+
+		const TA rho_next = _KrylovDot<TA>(n, &r[0], &r[0]);
+		// p = r + beta*p
+		RNP::TBLAS::Scale(n, T(rho_next / rho), &p[0], 1);
+		RNP::TBLAS::Axpy(n, T(1), &r[0], 1, &p[0], 1);
+		rho = rho_next;
+		++(*iterations);
+	}
+}
+
+// Restarted GMRES(m) for general nonsingular A. Each cycle builds an orthonormal
+// basis of up to m Krylov vectors (in T) by modified Gram-Schmidt Arnoldi and
+// minimizes the residual over it through Givens rotations of the Hessenberg
+// matrix (in TA). On entry x holds the initial guess. Iterates until the
+// residual estimate satisfies ||r||_2 <= tol * ||b||_2; a cycle that ends
+// there is only accepted if the residual recomputed from x agrees, so rounding
+// in T cannot stop the iteration early. *iterations counts products with A
+// (one per Arnoldi step) and *relres, if given, receives ||b - A*x||_2/||b||_2
+// as last recomputed. Returns 0 on convergence or -1 if max_iterations were not
+// enough.
+template <class T, class TA = T, class Op>
+int GMRES(size_t n, const Op &op, const T *b, T *x, size_t m, double tol, size_t max_iterations,
+	size_t *iterations, double *relres = NULL)
+{
+	*iterations = 0;
+	if(NULL != relres){ *relres = 0; }
+	if(0 == n){ return 0; }
+	if(m > n){ m = n; }
+	if(0 == m){ m = 1; }
+
+	std::vector<T> v(n*(m+1)), w(n);
+	std::vector<TA> h((m+1)*m), g(m+1), y(m), cs(m), sn(m);
+	const size_t ldh = m+1;
+
+	const TA bnorm = _KrylovNorm2<TA>(n, b);
+	const TA target = (TA(0) == bnorm ? TA(1) : bnorm) * TA(tol);
+	for(;;){
+		// r = b - A*x starts each cycle
+		T *v0 = &v[0];
+		op(x, v0);
+		for(size_t i = 0; i < n; ++i){ v0[i] = b[i] - v0[i]; }
+		const TA beta = _KrylovNorm2<TA>(n, v0);
+		if(NULL != relres){ *relres = double(beta) / double(TA(0) == bnorm ? TA(1) : bnorm); }
+		if(beta <= target){ return 0; }
+		if(*iterations >= max_iterations){ return -1; }
+		RNP::TBLAS::Scale(n, T(TA(1)/beta), v0, 1);
+		g[0] = beta;
+
+		size_t k = 0; // basis vectors used this cycle
+		while(k < m && *iterations < max_iterations){
+			T *vk = &v[k*n];
+			T *vk1 = &v[(k+1)*n];
+			op(vk, &w[0]);
+			++(*iterations);
+			TA *hk = &h[k*ldh];
+			for(size_t i = 0; i <= k; ++i){
+				hk[i] = _KrylovDot<TA>(n, &v[i*n], &w[0]);
+				RNP::TBLAS::Axpy(n, T(-hk[i]), &v[i*n], 1, &w[0], 1);
+			}
+			hk[k+1] = _KrylovNorm2<TA>(n, &w[0]);
+			const bool breakdown = (TA(0) == hk[k+1]); // x is exact in this basis
+			if(!breakdown){
+				RNP::TBLAS::Copy(n, &w[0], 1, vk1, 1);
+				RNP::TBLAS::Scale(n, T(TA(1)/hk[k+1]), vk1, 1);
+			}
+
+			// Apply the previous rotations to the new column and annihilate h(k+1,k)
+			for(size_t i = 0; i < k; ++i){
+				const TA t = cs[i]*hk[i] + sn[i]*hk[i+1];
+				hk[i+1] = cs[i]*hk[i+1] - sn[i]*hk[i];
+				hk[i] = t;
+			}
+			TA r;
+			RNP::TLASupport::GeneratePlaneRotation(hk[k], hk[k+1], &cs[k], &sn[k], &r);
+			hk[k] = r;
+			hk[k+1] = TA(0);
+			g[k+1] = -sn[k]*g[k];
+			g[k] = cs[k]*g[k];
+			++k;
+
+			using namespace std;
+			const TA estimate = TA(abs(g[k]));
+			if(estimate <= target || breakdown){ break; }
+		}
+
+		// x += V*y with H(0:k,0:k)*y = g(0:k)
+		RNP::TBLAS::Copy(k, &g[0], 1, &y[0], 1);
+		RNP::TBLAS::SolveTrV<'U','N','N'>(k, &h[0], ldh, &y[0], 1);
+		for(size_t i = 0; i < k; ++i){
+			RNP::TBLAS::Axpy(n, T(y[i]), &v[i*n], 1, x, 1);
+		}
+	}
+}
+
+} // namespace RNP
+
+#endif // _RNP_KRYLOV_H_
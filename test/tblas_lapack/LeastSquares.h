@@ -0,0 +1,54 @@
+#ifndef _RNP_LEAST_SQUARES_H_
+#define _RNP_LEAST_SQUARES_H_
+
+#include "TBLAS.h"
+#include "TLASupport.h"
+#include <vector>
+
+namespace RNP{
+
+// Solves the least squares problems min ||B - A*X||_2 for an m by n matrix A of
+// full column rank, m >= n, with the blocked QR factorization A = Q*R (as zgels):
+//   X = inv(R) * (Q'*B)(0:n-1,:)
+// A is overwritten by its factors and B by Q'*B, whose first n rows are then
+// replaced by X; the 2-norm of rows n:m-1 of a column is its residual norm. If tau
+// is given it must hold n entries and receives the reflector scalars. Returns 0,
+// or the 1-based index of the first exactly zero diagonal element of R, in which
+// case A is rank deficient and B is left holding Q'*B.
+template <class T>
+int LeastSquares(size_t m, size_t n, size_t nRHS, T *a, size_t lda, T *b, size_t ldb, T *tau = NULL){
+	if(0 == n || 0 == nRHS || m < n){ return 0; }
+
+	std::vector<T> itau;
+	if(NULL == tau){
+		itau.resize(n);
+		tau = &itau[0];
+	}
+	RNP::TLASupport::QRFactorization(m, n, a, lda, tau);
+
+	// B := Q'*B = H(n-1)' ... H(0)' * B. Forming the T of nb reflectors costs about
+	// m*nb*nb/2 multiply-adds, applying them one at a time 2*m*nb per column of B,
+	// so block reflectors only pay off for more than a few columns.
+	static const size_t nb = 32;
+	if(4*nRHS < nb){
+		std::vector<T> work(nRHS);
+		RNP::TLASupport::ApplyOrthognalMatrixFromElementaryReflectors<'L','C'>(m, nRHS, n, a, (int)lda, tau, b, (int)ldb, &work[0]);
+	}else{
+		std::vector<T> t(nb*nb), work(nRHS*nb);
+		for(size_t j = 0; j < n; j += nb){
+			const size_t jb = (n-j < nb ? n-j : nb);
+			RNP::TLASupport::FormBlockReflectorTriangularFactor(m-j, jb, &a[j+j*lda], lda, &tau[j], &t[0], nb);
+			RNP::TLASupport::ApplyBlockReflector<'L','C'>(m-j, nRHS, jb, &a[j+j*lda], lda, &t[0], nb, &b[j+0*ldb], ldb, &work[0], nRHS);
+		}
+	}
+
+	for(size_t i = 0; i < n; ++i){
+		if(T(0) == a[i+i*lda]){ return (int)i+1; }
+	}
+	RNP::TBLAS::SolveTrM<'L','U','N','N'>(n, nRHS, T(1), a, lda, b, ldb);
+	return 0;
+}
+
+} // namespace RNP
+
+#endif // _RNP_LEAST_SQUARES_H_
@@ -3,47 +3,49 @@
 
 #include "TBLAS.h"
 #include "TLASupport.h"
+#include <vector>
 
 namespace RNP{
 
 template <char trans='N'>
 struct LinearSolve{
+	// Solves op(A)*X = B by a blocked LU factorization with partial pivoting.
+	// A is overwritten by its factors and B by X. If pivots is given it must hold
+	// n entries and receives the row interchanges. info is set to the 1-based
+	// index of the first exactly zero pivot, in which case B is left unchanged.
 	template <class T>
-	LinearSolve(size_t n, size_t nRHS, T *a, size_t lda, T *b, size_t ldb, int *info = NULL, size_t * /*pivots*/ = NULL){
+	LinearSolve(size_t n, size_t nRHS, T *a, size_t lda, T *b, size_t ldb, int *info = NULL, size_t *pivots = NULL){
 		if(NULL != info){ *info = 0; }
 		if(0 == n || nRHS == 0){ return; }
 		
-		int iinfo = 0;
-		{ // LU decomposition
-			for(size_t j = 0; j < n; ++j){
-				size_t jp = j + RNP::TBLAS::MaximumIndex(n-j, &a[j+j*lda], 1);
-				if(T(0) != a[jp+j*lda]){
-					if(jp != j){
-						RNP::TBLAS::Swap(n, &a[j+0*lda], lda, &a[jp+0*lda], lda);
-						RNP::TBLAS::Swap(nRHS, &b[j+0*lda], ldb, &b[jp+0*lda], ldb);
-					}
-					if(j < n){
-						RNP::TBLAS::Scale(n-j-1, T(1)/a[j+j*lda], &a[j+1+j*lda], 1); // possible overflow when inverting A(j,j)
-					}
-				}else{
-					iinfo = j+1;
-				}
-				if(j < n){
-					RNP::TBLAS::Rank1Update(n-j-1, n-j-1, T(-1), &a[j+1+j*lda], 1, &a[j+(j+1)*lda], lda, &a[j+1+(j+1)*lda], lda);
-				}
-			}
+		std::vector<size_t> ipiv;
+		if(NULL == pivots){
+			ipiv.resize(n);
+			pivots = &ipiv[0];
 		}
+		int iinfo = RNP::TLASupport::LUDecomposition(n, n, a, lda, pivots);
 		if(0 == iinfo){
-			if(trans == 'T'){
-				RNP::TBLAS::SolveTrM<'L','U','T','N'>(n, nRHS, T(1), a, lda, b, ldb);
-				RNP::TBLAS::SolveTrM<'L','L','T','U'>(n, nRHS, T(1), a, lda, b, ldb);
-			}else if(trans == 'C'){
-				RNP::TBLAS::SolveTrM<'L','U','C','N'>(n, nRHS, T(1), a, lda, b, ldb);
-				RNP::TBLAS::SolveTrM<'L','L','C','U'>(n, nRHS, T(1), a, lda, b, ldb);
-			}else{
-				RNP::TBLAS::SolveTrM<'L','L','N','U'>(n, nRHS, T(1), a, lda, b, ldb);
-				RNP::TBLAS::SolveTrM<'L','U','N','N'>(n, nRHS, T(1), a, lda, b, ldb);
-			}
+			RNP::TLASupport::LUSolve<trans>(n, nRHS, a, lda, pivots, b, ldb);
+		}
+		if(NULL != info){ *info = iinfo; }
+	}
+};
+
+template <char uplo='L'>
+struct PositiveDefiniteSolve{
+	// Solves A*X = B for a Hermitian positive definite A by a blocked Cholesky
+	// factorization, at about half the cost of LinearSolve. Only the triangle of
+	// A given by uplo is referenced; it is overwritten by the factor and B by X.
+	// info is set to the order of the first leading minor that is not positive
+	// definite, in which case B is left unchanged.
+	template <class T>
+	PositiveDefiniteSolve(size_t n, size_t nRHS, T *a, size_t lda, T *b, size_t ldb, int *info = NULL){
+		if(NULL != info){ *info = 0; }
+		if(0 == n || nRHS == 0){ return; }
+		
+		int iinfo = RNP::TLASupport::CholeskyDecomposition<uplo>(n, a, lda);
+		if(0 == iinfo){
+			RNP::TLASupport::CholeskySolve<uplo>(n, nRHS, a, lda, b, ldb);
 		}
 		if(NULL != info){ *info = iinfo; }
 	}
@@ -0,0 +1,115 @@
+#ifndef _RNP_RANDOM_MATRIX_H_
+#define _RNP_RANDOM_MATRIX_H_
+
+#include "TBLAS.h"
+#include "TLASupport.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "../common/counter_rng.hpp"
+
+// Random test matrices with prescribed singular values (as LAPACK's dlatms):
+//   A = U * diag(sigma) * V'
+// with U and V Haar-distributed orthonormal factors taken from the QR
+// factorization of Gaussian matrices. Everything is computed in double from a
+// 64-bit seed, so a given seed produces the same matrix on every run and for
+// any thread count; the random numbers come from the counter-based
+// PhiloxRandom, so the Gaussian columns are drawn in parallel, and the
+// products use the threaded level 3 routines. When A is
+// rounded to a lower precision T its condition number is only approximately
+// the requested one, the more so as cond approaches 1/eps of T.
+
+namespace RNP{
+
+// Singular values sigma[0:k-1], decreasing from 1 to 1/cond, distributed as
+//   'L' one large:  1, 1/cond, ..., 1/cond          (dlatms mode 1)
+//   'S' one small:  1, ..., 1, 1/cond               (mode 2)
+//   'G' geometric:  cond^(-i/(k-1))                 (mode 3)
+//   'A' arithmetic: 1 - (1 - 1/cond)*i/(k-1)        (mode 4)
+//   'R' random:     log-uniform in [1/cond, 1]      (mode 5)
+// Both ends are always present, so cond is the exact 2-norm condition number.
+inline void SingularValueDistribution(size_t k, double cond, char mode, std::uint64_t seed, double *sigma){
+	if(0 == k){ return; }
+	const double smin = 1.0 / cond;
+	for(size_t i = 0; i < k; ++i){
+		const double t = (k > 1) ? double(i) / double(k-1) : 0.0;
+		switch(mode){
+		case 'L': sigma[i] = (0 == i) ? 1.0 : smin; break;
+		case 'S': sigma[i] = (k-1 == i) ? smin : 1.0; break;
+		case 'A': sigma[i] = 1.0 - (1.0 - smin)*t; break;
+		default:  sigma[i] = std::pow(cond, -t); break; // 'G' and the ends of 'R'
+		}
+	}
+	if('R' == mode && k > 2){
+		const PhiloxRandom random(seed);
+		random.fill_uniform(2, 0, k-2, sigma+1);
+		for(size_t i = 1; i+1 < k; ++i){
+			sigma[i] = std::pow(cond, -sigma[i]);
+		}
+		std::sort(sigma+1, sigma+k-1, [](double a, double b){ return a > b; });
+	}
+}
+
+// m x n matrix of standard normal entries; entry (i,j) is the Philox value
+// (seed, stream, i+j*m), so the columns can be drawn in any order
+inline void _RandomGaussianMatrix(size_t m, size_t n, std::uint64_t seed, std::uint32_t stream, double *a, size_t lda){
+	const PhiloxRandom random(seed);
+	auto columns = [&](size_t j0, size_t j1){
+		for(size_t j = j0; j < j1; ++j){
+			random.fill_normal(stream, std::uint64_t(j)*m, m, &a[j*lda]);
+		}
+	};
+	if(!RNP::TBLAS::_ParallelFor(n, 1, 16.0*double(m)*double(n), columns)){
+		columns(0, n);
+	}
+}
+
+// m x k (m >= k) Haar-distributed matrix with orthonormal columns: the Q of a
+// Gaussian matrix, with the signs of its columns fixed by those of diag(R)
+inline void _RandomOrthonormalColumns(size_t m, size_t k, std::uint64_t seed, std::uint32_t stream, double *q){
+	std::vector<double> tau(k), work(k), rsign(k);
+	_RandomGaussianMatrix(m, k, seed, stream, q, m);
+	RNP::TLASupport::QRFactorization(m, k, q, m, &tau[0]);
+	for(size_t j = 0; j < k; ++j){
+		rsign[j] = (q[j+j*m] < 0) ? -1.0 : 1.0;
+	}
+	RNP::TLASupport::GenerateOrthognalMatrixFromElementaryReflectors(m, k, k, q, (int)m, &tau[0], &work[0]);
+	for(size_t j = 0; j < k; ++j){
+		if(rsign[j] < 0){
+			RNP::TBLAS::Scale(m, -1.0, &q[0+j*m], 1);
+		}
+	}
+}
+
+// A = U * diag(sigma) * V' for the min(m,n) singular values sigma
+template <class T>
+void RandomMatrixWithSingularValues(size_t m, size_t n, const double *sigma, std::uint64_t seed, T *a, size_t lda){
+	const size_t k = std::min(m, n);
+	if(0 == k){ return; }
+	std::vector<double> u(m*k), v(n*k), ad(m*n);
+	_RandomOrthonormalColumns(m, k, seed, 0, &u[0]);
+	_RandomOrthonormalColumns(n, k, seed, 1, &v[0]);
+	for(size_t j = 0; j < k; ++j){
+		RNP::TBLAS::Scale(m, sigma[j], &u[0+j*m], 1);
+	}
+	RNP::TBLAS::MultMM<'N','T'>(m, n, k, 1.0, &u[0], m, &v[0], n, 0.0, &ad[0], m);
+	for(size_t j = 0; j < n; ++j){
+		for(size_t i = 0; i < m; ++i){
+			a[i+j*lda] = T(ad[i+j*m]);
+		}
+	}
+}
+
+// m x n matrix with 2-norm condition number cond and singular values from 1 down
+// to 1/cond distributed by mode (see SingularValueDistribution)
+template <class T>
+void RandomConditionedMatrix(size_t m, size_t n, double cond, char mode, std::uint64_t seed, T *a, size_t lda){
+	std::vector<double> sigma(std::min(m, n));
+	SingularValueDistribution(sigma.size(), cond, mode, seed, sigma.data());
+	RandomMatrixWithSingularValues(m, n, sigma.data(), seed, a, lda);
+}
+
+} // namespace RNP
+
+#endif // _RNP_RANDOM_MATRIX_H_
@@ -43,11 +43,18 @@ BLAS distribution, and is in the public domain.
 #define _USE_MATH_DEFINES
 #include <complex>
 #include <cmath>
+#include <vector>
+#ifndef RNP_TBLAS_NO_THREADS
+# include <memory>
+# include "../common/thread_pool.hpp"
+#endif
 
 /*
  * Preprocessor flags:
  *   RNP_HAVE_BLAS
  *   RNP_TBLAS_USE_RANDOM
+ *   RNP_TBLAS_NO_BLOCKED_GEMM - always use the reference MultMM loops
+ *   RNP_TBLAS_NO_THREADS - never split level 3 routines over threads
  */
 
 namespace RNP{
@@ -61,7 +68,7 @@ struct _RealOrComplexChooser{
 
 	inline static value_type _conj(const value_type &v){ return v; }
 	inline static real_type _real(const value_type &v){ return v; }
-	inline static real_type _imag(const value_type &v){ return 0; }
+	inline static real_type _imag(const value_type &){ return 0; }
 	// abs is euclidean norm, abs2 is euclidean norm squared
 	// abs1 is 1-norm (sum of absolute values)
 	// absinf is infinity-norm (max absolute value)
@@ -294,7 +301,7 @@ struct MultTrV{ // ztrmv, dtrmv, ctrmv, strmv
 	MultTrV(size_t n, const T *a, size_t lda, T *x, size_t incx){
 		if(n < 1){ return; }
 		const bool noconj = ('T' == trans);
-		const bool nounit = ('N' == trans);
+		const bool nounit = ('N' == diag);
 		
 		if('N' == trans){ // x <- A*x
 			T *xx = x;
@@ -314,7 +321,7 @@ struct MultTrV{ // ztrmv, dtrmv, ctrmv, strmv
 			}else{
 				size_t j = n;
 				xx += (n-1)*incx;
-				const T *x2i = xx;
+				T *x2i = xx;
 				while(j --> 0){
 					if(T(0) != *xx){
 						T temp(*xx);
@@ -338,14 +345,14 @@ struct MultTrV{ // ztrmv, dtrmv, ctrmv, strmv
 					T *x2 = xx;
 					if(noconj){
 						if(nounit){ temp *= a[j+j*lda]; }
-						size_t i = j-1;
+						size_t i = j;
 						while(i --> 0){
 							x2 -= incx;
 							temp += a[i+j*lda]*(*x2);
 						}
 					}else{
 						if(nounit){ temp *= _RealOrComplexChooser<T>::_conj(a[j+j*lda]); }
-						size_t i = j-1;
+						size_t i = j;
 						while(i --> 0){
 							x2 -= incx;
 							temp += _RealOrComplexChooser<T>::_conj(a[i+j*lda])*(*x2);
@@ -815,6 +822,438 @@ void ConjugateRank1Update(size_t m, size_t n, const A &alpha, const T *x, size_t
 
 //// Level 3
 
+// Threading
+//   Large level 3 operations are split over a shared thread pool. Each thread
+//   runs the serial code on a disjoint range of output columns (rows, when a
+//   triangular A is applied from the right), so every element of the result is
+//   computed by the same operations in the same order for any thread count.
+//   Everything runs serially until SetThreadCount is called with more than one
+//   thread, and calls made from inside a parallel range always run serially.
+//   SetThreadCount must not be called while a level 3 routine is running.
+#ifndef RNP_TBLAS_NO_THREADS
+inline std::unique_ptr<ThreadPool>& _ThreadPoolInstance(){
+	static std::unique_ptr<ThreadPool> pool;
+	return pool;
+}
+inline bool& _InParallelRange(){
+	static thread_local bool inside = false;
+	return inside;
+}
+inline void SetThreadCount(size_t threads){
+	_ThreadPoolInstance().reset(threads > 1 ? new ThreadPool(threads) : NULL);
+}
+inline size_t GetThreadCount(){
+	return _ThreadPoolInstance() ? _ThreadPoolInstance()->size() : 1;
+}
+// While in scope, level 3 calls from this thread run serially, as from inside a
+// parallel range; for callers that run independent problems in parallel
+class SerialScope{
+	bool outer;
+public:
+	SerialScope():outer(_InParallelRange()){ _InParallelRange() = true; }
+	~SerialScope(){ _InParallelRange() = outer; }
+	SerialScope(const SerialScope&) = delete;
+	SerialScope& operator=(const SerialScope&) = delete;
+};
+#else
+inline void SetThreadCount(size_t){}
+inline size_t GetThreadCount(){ return 1; }
+class SerialScope{};
+#endif
+
+// Splits [0,count) into contiguous ranges whose boundaries are multiples of grain
+// and calls fn(begin, end) for each range in parallel. Returns false, without
+// calling fn, if the operation should run serially: one thread, a nested call,
+// or fewer than about 64^3 multiply-adds of work.
+template <class F>
+bool _ParallelFor(size_t count, size_t grain, double work, F fn){
+#ifndef RNP_TBLAS_NO_THREADS
+	ThreadPool *pool = _ThreadPoolInstance().get();
+	if(NULL == pool || _InParallelRange() || count <= grain || work < 64.*64.*64.){ return false; }
+	const size_t blocks = (count+grain-1)/grain;
+	pool->parallel_for(0, blocks, [&](size_t b0, size_t b1, size_t){
+		_InParallelRange() = true;
+		fn(b0*grain, (b1*grain < count) ? b1*grain : count);
+		_InParallelRange() = false;
+	});
+	return true;
+#else
+	(void)count; (void)grain; (void)work; (void)fn;
+	return false;
+#endif
+}
+
+// Blocked GEMM
+//   C is updated in cache-sized blocks: op(B) is packed into kc x nc panels,
+//   op(A) into mc x kc blocks, and a register-tiled micro-kernel updates an
+//   mr x nr tile of C from them. The result is the same as that of the reference
+//   loops (_GemmReference) in every rounding mode, because each element of C
+//   receives the same operations in the same order:
+//   - For transa == 'N', C is scaled by beta and then accumulates alpha*op(B)(l,j)
+//     times op(A)(i,l) in ascending l. The packed panel of op(B) is pre-multiplied
+//     by alpha and carries a mask of its nonzero entries; terms with a zero op(B)
+//     entry are skipped, as in the reference (adding a rounded zero product is not
+//     a no-op under every rounding, and 0*inf would give NaN).
+//   - Otherwise the reference forms temp = sum over l of op(A)(i,l)*op(B)(l,j) from
+//     zero and only then sets C := alpha*temp + beta*C, so the sums are accumulated
+//     in a separate buffer, without skipping, and combined with C at the end.
+//   The blocking parameters and micro-kernel may be specialized for a type (see
+//   TBLAS_hub_float.h).
+template <class T>
+struct _GemmBlocking{
+	static constexpr size_t mr = 4; // rows of a register tile
+	static constexpr size_t nr = 4; // columns of a register tile
+	static constexpr size_t mc = 128; // rows of a packed block of op(A)
+	static constexpr size_t kc = 256; // depth of the packed blocks
+	static constexpr size_t nc = 2048; // columns of a packed panel of op(B)
+	// Smaller products are left to the reference loops
+	static bool UseBlocked(size_t m, size_t n, size_t k){
+		return m >= 2*mr && n >= 2*nr && m*n*k >= 32*32*32;
+	}
+};
+
+template <class T>
+struct _GemmMicroKernel{
+	// C[0..mr_,0..nr_] += bp[j+l*nr] * ap[i+l*mr] in ascending l, for the columns j
+	// whose bit is set in bm[l]. ap and bp are packed and zero padded to full mr x kc
+	// and kc x nr tiles; the bits of padding columns are clear.
+	static void Run(size_t kc, const T *ap, const T *bp, const unsigned *bm, T *c, size_t ldc, size_t mr_, size_t nr_){
+		const size_t mr = _GemmBlocking<T>::mr;
+		const size_t nr = _GemmBlocking<T>::nr;
+		T acc[mr*nr];
+		for(size_t j = 0; j < nr; ++j){
+			for(size_t i = 0; i < mr; ++i){
+				acc[i+j*mr] = (i < mr_ && j < nr_) ? c[i+j*ldc] : T(0);
+			}
+		}
+		for(size_t l = 0; l < kc; ++l){
+			const T *al = &ap[l*mr];
+			const T *bl = &bp[l*nr];
+			for(size_t j = 0; j < nr; ++j){
+				if(!(bm[l] & (1u << j))){ continue; }
+				for(size_t i = 0; i < mr; ++i){
+					acc[i+j*mr] += bl[j] * al[i];
+				}
+			}
+		}
+		for(size_t j = 0; j < nr_; ++j){
+			for(size_t i = 0; i < mr_; ++i){
+				c[i+j*ldc] = acc[i+j*mr];
+			}
+		}
+	}
+};
+
+// Pack rows [0,mc) and columns [0,kc) of op(A) into mr-row micro-panels
+template <char transa, class T>
+void _GemmPackA(size_t mc, size_t kc, const T *a, size_t lda, T *ap){
+	const size_t mr = _GemmBlocking<T>::mr;
+	for(size_t ir = 0; ir < mc; ir += mr){
+		const size_t mb = (mc-ir < mr) ? mc-ir : mr;
+		for(size_t l = 0; l < kc; ++l){
+			for(size_t i = 0; i < mr; ++i){
+				if(i >= mb){
+					*ap++ = T(0);
+				}else if(transa == 'N'){
+					*ap++ = a[(ir+i)+l*lda];
+				}else if(transa == 'C'){
+					*ap++ = _RealOrComplexChooser<T>::_conj(a[l+(ir+i)*lda]);
+				}else{
+					*ap++ = a[l+(ir+i)*lda];
+				}
+			}
+		}
+	}
+}
+
+// Pack rows [0,kc) and columns [0,nc) of op(B) into nr-column micro-panels, with
+// one mask word per row of a micro-panel in bm. For transa == 'N' the entries are
+// multiplied by alpha and only the nonzero ones are marked; otherwise they are
+// packed as is and all are marked (see the blocked GEMM comment above).
+template <char transa, char transb, class A, class T>
+void _GemmPackB(size_t kc, size_t nc, const A &alpha, const T *b, size_t ldb, T *bp, unsigned *bm){
+	const size_t nr = _GemmBlocking<T>::nr;
+	for(size_t jr = 0; jr < nc; jr += nr){
+		const size_t nb = (nc-jr < nr) ? nc-jr : nr;
+		for(size_t l = 0; l < kc; ++l){
+			unsigned mask = 0;
+			for(size_t j = 0; j < nr; ++j){
+				if(j >= nb){
+					*bp++ = T(0);
+					continue;
+				}
+				const T &blj = (transb == 'N') ? b[l+(jr+j)*ldb] : b[(jr+j)+l*ldb];
+				const T bv = (transb == 'C') ? _RealOrComplexChooser<T>::_conj(blj) : blj;
+				if(transa != 'N'){
+					*bp++ = bv;
+					mask |= 1u << j;
+				}else{
+					*bp++ = alpha * bv;
+					if(T(0) != blj){ mask |= 1u << j; }
+				}
+			}
+			*bm++ = mask;
+		}
+	}
+}
+
+// Update the mc x nc block of C at c from packed blocks (one mc x kc, one kc x nc)
+template <class T>
+void _GemmMacroKernel(size_t mc, size_t nc, size_t kc, const T *ap, const T *bp, const unsigned *bm, T *c, size_t ldc){
+	const size_t mr = _GemmBlocking<T>::mr;
+	const size_t nr = _GemmBlocking<T>::nr;
+	for(size_t jr = 0; jr < nc; jr += nr){
+		const size_t nb = (nc-jr < nr) ? nc-jr : nr;
+		for(size_t ir = 0; ir < mc; ir += mr){
+			const size_t mb = (mc-ir < mr) ? mc-ir : mr;
+			_GemmMicroKernel<T>::Run(kc, &ap[ir*kc], &bp[jr*kc], &bm[(jr/nr)*kc], &c[ir+jr*ldc], ldc, mb, nb);
+		}
+	}
+}
+
+// C := C + alpha*op(A)*op(B) for transa == 'N', C := C + op(A)*op(B) otherwise,
+// where C is m x n and b points at the first column of op(B)
+template <char transa, char transb, class A, class T>
+void _GemmBlockedColumns(size_t m, size_t n, size_t k, const A &alpha, const T *a, size_t lda,
+	const T *b, size_t ldb, T *c, size_t ldc)
+{
+	typedef _GemmBlocking<T> blocking;
+	// Packing buffers for the largest blocks of this product, in whole micro-panels;
+	// small products would otherwise pay for constructing mc*kc + kc*nc elements
+	const size_t mcmax = (m < blocking::mc) ? m : blocking::mc;
+	const size_t ncmax = (n < blocking::nc) ? n : blocking::nc;
+	const size_t kcmax = (k < blocking::kc) ? k : blocking::kc;
+	const size_t npanels = (ncmax+blocking::nr-1)/blocking::nr;
+	std::vector<T> ap(((mcmax+blocking::mr-1)/blocking::mr)*blocking::mr*kcmax);
+	std::vector<T> bp(npanels*blocking::nr*kcmax);
+	std::vector<unsigned> bm(npanels*kcmax);
+	for(size_t jc = 0; jc < n; jc += blocking::nc){
+		const size_t nc = (n-jc < blocking::nc) ? n-jc : blocking::nc;
+		for(size_t pc = 0; pc < k; pc += blocking::kc){
+			const size_t kc = (k-pc < blocking::kc) ? k-pc : blocking::kc;
+			const T *bsrc = (transb == 'N') ? &b[pc+jc*ldb] : &b[jc+pc*ldb];
+			_GemmPackB<transa,transb>(kc, nc, alpha, bsrc, ldb, &bp[0], &bm[0]);
+			for(size_t ic = 0; ic < m; ic += blocking::mc){
+				const size_t mc = (m-ic < blocking::mc) ? m-ic : blocking::mc;
+				const T *asrc = (transa == 'N') ? &a[ic+pc*lda] : &a[pc+ic*lda];
+				_GemmPackA<transa>(mc, kc, asrc, lda, &ap[0]);
+				_GemmMacroKernel(mc, nc, kc, &ap[0], &bp[0], &bm[0], &c[ic+jc*ldc], ldc);
+			}
+		}
+	}
+}
+
+template <char transa, char transb, class A, class B, class T>
+void _GemmBlocked(size_t m, size_t n, size_t k, const A &alpha, const T *a, size_t lda,
+	const T *b, size_t ldb, const B &beta, T *c, size_t ldc)
+{
+	// Threads own whole nr-column tiles of C and pack their own blocks
+	auto columns = [&](size_t j0, size_t j1){
+		const T *bj0 = (transb == 'N') ? &b[j0*ldb] : &b[j0];
+		if(transa == 'N'){
+			for(size_t j = j0; j < j1; ++j){
+				if(B(0) == beta){
+					for(size_t i = 0; i < m; ++i){
+						c[i+j*ldc] = 0;
+					}
+				}else if(B(1) != beta){
+					for(size_t i = 0; i < m; ++i){
+						c[i+j*ldc] *= beta;
+					}
+				}
+			}
+			_GemmBlockedColumns<transa,transb>(m, j1-j0, k, alpha, a, lda, bj0, ldb, &c[j0*ldc], ldc);
+			return;
+		}
+		std::vector<T> temp(m*(j1-j0), T(0));
+		_GemmBlockedColumns<transa,transb>(m, j1-j0, k, alpha, a, lda, bj0, ldb, &temp[0], m);
+		for(size_t j = j0; j < j1; ++j){
+			const T *tj = &temp[(j-j0)*m];
+			for(size_t i = 0; i < m; ++i){
+				if(B(0) == beta){
+					c[i+j*ldc] = alpha * tj[i];
+				}else{
+					c[i+j*ldc] = alpha * tj[i] + beta * c[i+j*ldc];
+				}
+			}
+		}
+	};
+	if(!_ParallelFor(n, _GemmBlocking<T>::nr, double(m)*n*k, columns)){
+		columns(0, n);
+	}
+}
+
+// Reference loops of MultMM, used for products too small for the blocked GEMM
+template <char transa, char transb, class A, class B, class T>
+void _GemmReference(size_t m, size_t n, size_t k, const A &alpha, const T *a, size_t lda,
+	const T *b, size_t ldb, const B &beta, T *c, size_t ldc)
+{
+	//    Set  NOTA  and  NOTB  as  true if  A  and  B  respectively are not
+	//    conjugated or transposed, set  CONJA and CONJB  as true if  A  and
+	//    B  respectively are to be  transposed but  not conjugated  and set
+	//    NROWA, NCOLA and  NROWB  as the number of rows and  columns  of  A
+	//    and the number of rows of  B  respectively.
+
+	const bool nota = (transa == 'N');
+	const bool notb = (transb == 'N');
+	const bool conja = (transa == 'C');
+	const bool conjb = (transb == 'C');
+
+	if(notb){
+		if(nota){ // Form  C := alpha*A*B + beta*C.
+			for(size_t j = 0; j < n; ++j){
+				if(B(0) == beta){
+					for(size_t i = 0; i < m; ++i){
+						c[i+j*ldc] = 0;
+					}
+				}else if(B(1) != beta){
+					for(size_t i = 0; i < m; ++i){
+						c[i+j*ldc] *= beta;
+					}
+				}
+				for(size_t l = 0; l < k; ++l){
+					if(T(0) != b[l+j*ldb]){
+						T temp = alpha * b[l+j*ldb];
+						for(size_t i = 0; i < m; ++i){
+							c[i+j*ldc] += temp * a[i+l*lda];
+						}
+					}
+				}
+			}
+		}else if(conja){ // Form  C := alpha*conjg( A' )*B + beta*C.
+			for(size_t j = 0; j < n; ++j){
+				for(size_t i = 0; i < m; ++i){
+					T temp = 0;
+					for(size_t l = 0; l < k; ++l){
+						temp += _RealOrComplexChooser<T>::_conj(a[l+i*lda]) * b[l+j*ldb];
+					}
+					if(B(0) == beta){
+						c[i+j*ldc] = alpha * temp;
+					}else{
+						c[i+j*ldc] = alpha * temp + beta * c[i+j*ldc];
+					}
+				}
+			}
+		}else{ // Form  C := alpha*A'*B + beta*C
+			for(size_t j = 0; j < n; ++j){
+				for(size_t i = 0; i < m; ++i){
+					T temp = 0;
+					for(size_t l = 0; l < k; ++l){
+						temp += a[l+i*lda] * b[l+j*ldb];
+					}
+					if(B(0) == beta){
+						c[i+j*ldc] = alpha * temp;
+					}else{
+						c[i+j*ldc] = alpha * temp + beta * c[i+j*ldc];
+					}
+				}
+			}
+		}
+	}else if(nota){
+		if(conjb){ // Form  C := alpha*A*conjg( B' ) + beta*C.
+			for(size_t j = 0; j < n; ++j){
+				if(B(0) == beta){
+					for(size_t i = 0; i < m; ++i){
+						c[i+j*ldc] = 0;
+					}
+				}else if(B(1) != beta){
+					for(size_t i = 0; i < m; ++i){
+						c[i+j*ldc] *= beta;
+					}
+				}
+				for(size_t l = 0; l < k; ++l){
+					if(T(0) != b[j+l*ldb]){
+						T temp = alpha * _RealOrComplexChooser<T>::_conj(b[j+l*ldb]);
+						for(size_t i = 0; i < m; ++i){
+							c[i+j*ldc] += temp * a[i+l*lda];
+						}
+					}
+				}
+			}
+		}else{ // Form  C := alpha*A*B' + beta*C
+			for(size_t j = 0; j < n; ++j){
+				if(B(0) == beta){
+					for(size_t i = 0; i < m; ++i){
+						c[i+j*ldc] = 0;
+					}
+				}else if(B(1) != beta){
+					for(size_t i = 0; i < m; ++i){
+						c[i+j*ldc] *= beta;
+					}
+				}
+				for(size_t l = 0; l < k; ++l){
+					if(T(0) != b[j+l*ldb]){
+						T temp = alpha * b[j+l*ldb];
+						for(size_t i = 0; i < m; ++i){
+							c[i+j*ldc] += temp * a[i+l*lda];
+						}
+					}
+				}
+			}
+		}
+	}else if(conja){
+		if(conjb){ // Form  C := alpha*conjg( A' )*conjg( B' ) + beta*C.
+			for(size_t j = 0; j < n; ++j){
+				for(size_t i = 0; i < m; ++i){
+					T temp = 0;
+					for(size_t l = 0; l < k; ++l){
+						temp += _RealOrComplexChooser<T>::_conj(a[l+i*lda]) * _RealOrComplexChooser<T>::_conj(b[j+l*ldb]);
+					}
+					if(B(0) == beta){
+						c[i+j*ldc] = alpha * temp;
+					}else{
+						c[i+j*ldc] = alpha * temp + beta * c[i+j*ldc];
+					}
+				}
+			}
+		}else{ // Form  C := alpha*conjg( A' )*B' + beta*C
+			for(size_t j = 0; j < n; ++j){
+				for(size_t i = 0; i < m; ++i){
+					T temp = 0;
+					for(size_t l = 0; l < k; ++l){
+						temp += _RealOrComplexChooser<T>::_conj(a[l+i*lda]) * b[j+l*ldb];
+					}
+					if(B(0) == beta){
+						c[i+j*ldc] = alpha * temp;
+					}else{
+						c[i+j*ldc] = alpha * temp + beta * c[i+j*ldc];
+					}
+				}
+			}
+		}
+	}else{
+		if(conjb){ // Form  C := alpha*A'*conjg( B' ) + beta*C
+			for(size_t j = 0; j < n; ++j){
+				for(size_t i = 0; i < m; ++i){
+					T temp = 0;
+					for(size_t l = 0; l < k; ++l){
+						temp += a[l + i * lda] * _RealOrComplexChooser<T>::_conj(b[j+l*ldb]);
+					}
+					if(B(0) == beta){
+						c[i+j*ldc] = alpha * temp;
+					}else{
+						c[i+j*ldc] = alpha * temp + beta * c[i+j*ldc];
+					}
+				}
+			}
+		}else{ // Form  C := alpha*A'*B' + beta*C
+			for(size_t j = 0; j < n; ++j){
+				for(size_t i = 0; i < m; ++i){
+					T temp = 0;
+					for(size_t l = 0; l < k; ++l){
+						temp += a[l+i*lda] * b[j+l*ldb];
+					}
+					if(B(0) == beta){
+						c[i+j*ldc] = alpha * temp;
+					}else{
+						c[i+j*ldc] = alpha * temp + beta * c[i+j*ldc];
+					}
+				}
+			}
+		}
+	}
+}
+
 // MultMM (zgemm)
 template <char transa='N', char transb='N'>
 struct MultMM{
@@ -894,17 +1333,6 @@ struct MultMM{
 		//          in  the  calling  (sub)  program.   LDC  must  be  at  least
 		//          max( 1, m ).
 
-		//    Set  NOTA  and  NOTB  as  true if  A  and  B  respectively are not
-		//    conjugated or transposed, set  CONJA and CONJB  as true if  A  and
-		//    B  respectively are to be  transposed but  not conjugated  and set
-		//    NROWA, NCOLA and  NROWB  as the number of rows and  columns  of  A
-		//    and the number of rows of  B  respectively.
-
-		const bool nota = (transa == 'N');
-		const bool notb = (transb == 'N');
-		const bool conja = (transa == 'C');
-		const bool conjb = (transb == 'C');
-
 		if(m == 0 || n == 0 || ((A(0) == alpha || k == 0) && (B(1) == beta))){ return; }
 
 		if(A(0) == alpha){
@@ -924,155 +1352,74 @@ struct MultMM{
 			return;
 		}
 
-		if(notb){
-			if(nota){ // Form  C := alpha*A*B + beta*C.
-				for(size_t j = 0; j < n; ++j){
-					if(B(0) == beta){
-						for(size_t i = 0; i < m; ++i){
-							c[i+j*ldc] = 0;
-						}
-					}else if(B(1) != beta){
-						for(size_t i = 0; i < m; ++i){
-							c[i+j*ldc] *= beta;
-						}
-					}
-					for(size_t l = 0; l < k; ++l){
-						if(T(0) != b[l+j*ldb]){
-							T temp = alpha * b[l+j*ldb];
-							for(size_t i = 0; i < m; ++i){
-								c[i+j*ldc] += temp * a[i+l*lda];
-							}
-						}
-					}
-				}
-			}else if(conja){ // Form  C := alpha*conjg( A' )*B + beta*C.
-				for(size_t j = 0; j < n; ++j){
-					for(size_t i = 0; i < m; ++i){
-						T temp = 0;
+#ifndef RNP_TBLAS_NO_BLOCKED_GEMM
+		if(_GemmBlocking<T>::UseBlocked(m, n, k)){
+			_GemmBlocked<transa,transb>(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+			return;
+		}
+#endif
+
+		_GemmReference<transa,transb>(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+	}
+};
+
+template <char uplo='L', char trans='N'>
+struct HermRankKUpdate{ // zherk, cherk, dsyrk, ssyrk
+	template <class A, class B, class T>
+	HermRankKUpdate(size_t n, size_t k, const A &alpha, const T *a, size_t lda, const B &beta, T *c, size_t ldc){
+		// Performs one of the Hermitian rank k operations
+		//    C := alpha*A*A' + beta*C   (TRANS = 'N', A is n by k)
+		//    C := alpha*A'*A + beta*C   (TRANS = 'C', A is k by n)
+		// where alpha and beta are real scalars and C is an n by n Hermitian
+		// matrix, of which only the triangle given by UPLO is referenced and
+		// updated. The imaginary parts of the diagonal are set to zero.
+		//
+		// C is processed in blocks of nb columns. The part of each block column
+		// outside its diagonal block is a plain product done by MultMM; only the
+		// nb by nb diagonal triangles are computed here, so there is no wasted
+		// work on the other triangle beyond them.
+		if(0 == n || ((A(0) == alpha || 0 == k) && B(1) == beta)){ return; }
+		static const size_t nb = 64;
+		for(size_t jj = 0; jj < n; jj += nb){
+			const size_t jb = (n-jj < nb) ? n-jj : nb;
+			// Diagonal triangle
+			for(size_t j = jj; j < jj+jb; ++j){
+				const size_t i0 = ('L' == uplo) ? j : jj;
+				const size_t i1 = ('L' == uplo) ? jj+jb : j+1;
+				for(size_t i = i0; i < i1; ++i){
+					T temp(0);
+					if('N' == trans){
 						for(size_t l = 0; l < k; ++l){
-							temp += _RealOrComplexChooser<T>::_conj(a[l+i*lda]) * b[l+j*ldb];
+							temp += a[i+l*lda] * _RealOrComplexChooser<T>::_conj(a[j+l*lda]);
 						}
-						if(B(0) == beta){
-							c[i+j*ldc] = alpha * temp;
-						}else{
-							c[i+j*ldc] = alpha * temp + beta * c[i+j*ldc];
-						}
-					}
-				}
-			}else{ // Form  C := alpha*A'*B + beta*C
-				for(size_t j = 0; j < n; ++j){
-					for(size_t i = 0; i < m; ++i){
-						T temp = 0;
+					}else{
 						for(size_t l = 0; l < k; ++l){
-							temp += a[l+i*lda] * b[l+j*ldb];
-						}
-						if(B(0) == beta){
-							c[i+j*ldc] = alpha * temp;
-						}else{
-							c[i+j*ldc] = alpha * temp + beta * c[i+j*ldc];
-						}
-					}
-				}
-			}
-		}else if(nota){
-			if(conjb){ // Form  C := alpha*A*conjg( B' ) + beta*C.
-				for(size_t j = 0; j < n; ++j){
-					if(B(0) == beta){
-						for(size_t i = 0; i < m; ++i){
-							c[i+j*ldc] = 0;
-						}
-					}else if(B(1) != beta){
-						for(size_t i = 0; i < m; ++i){
-							c[i+j*ldc] *= beta;
+							temp += _RealOrComplexChooser<T>::_conj(a[l+i*lda]) * a[l+j*lda];
 						}
 					}
-					for(size_t l = 0; l < k; ++l){
-						if(T(0) != b[j+l*ldb]){
-							T temp = alpha * _RealOrComplexChooser<T>::_conj(b[j+l*ldb]);
-							for(size_t i = 0; i < m; ++i){
-								c[i+j*ldc] += temp * a[i+l*lda];
-							}
-						}
-					}
-				}
-			}else{ // Form  C := alpha*A*B' + beta*C
-				for(size_t j = 0; j < n; ++j){
 					if(B(0) == beta){
-						for(size_t i = 0; i < m; ++i){
-							c[i+j*ldc] = 0;
-						}
-					}else if(B(1) != beta){
-						for(size_t i = 0; i < m; ++i){
-							c[i+j*ldc] *= beta;
-						}
-					}
-					for(size_t l = 0; l < k; ++l){
-						if(T(0) != b[j+l*ldb]){
-							T temp = alpha * b[j+l*ldb];
-							for(size_t i = 0; i < m; ++i){
-								c[i+j*ldc] += temp * a[i+l*lda];
-							}
-						}
-					}
-				}
-			}
-		}else if(conja){
-			if(conjb){ // Form  C := alpha*conjg( A' )*conjg( B' ) + beta*C.
-				for(size_t j = 0; j < n; ++j){
-					for(size_t i = 0; i < m; ++i){
-						T temp = 0;
-						for(size_t l = 0; l < k; ++l){
-							temp += _RealOrComplexChooser<T>::_conj(a[l+i*lda]) * _RealOrComplexChooser<T>::_conj(b[j+l*ldb]);
-						}
-						if(B(0) == beta){
-							c[i+j*ldc] = alpha * temp;
-						}else{
-							c[i+j*ldc] = alpha * temp + beta * c[i+j*ldc];
-						}
-					}
-				}
-			}else{ // Form  C := alpha*conjg( A' )*B' + beta*C
-				for(size_t j = 0; j < n; ++j){
-					for(size_t i = 0; i < m; ++i){
-						T temp = 0;
-						for(size_t l = 0; l < k; ++l){
-							temp += _RealOrComplexChooser<T>::_conj(a[l+i*lda]) * b[j+l*ldb];
-						}
-						if(B(0) == beta){
-							c[i+j*ldc] = alpha * temp;
-						}else{
-							c[i+j*ldc] = alpha * temp + beta * c[i+j*ldc];
-						}
+						c[i+j*ldc] = alpha*temp;
+					}else{
+						c[i+j*ldc] = alpha*temp + beta*c[i+j*ldc];
 					}
 				}
+				c[j+j*ldc] = _RealOrComplexChooser<T>::_real(c[j+j*ldc]);
 			}
-		}else{
-			if(conjb){ // Form  C := alpha*A'*conjg( B' ) + beta*C
-				for(size_t j = 0; j < n; ++j){
-					for(size_t i = 0; i < m; ++i){
-						T temp = 0;
-						for(size_t l = 0; l < k; ++l){
-							temp += a[l + i * lda] * _RealOrComplexChooser<T>::_conj(b[j+l*ldb]);
-						}
-						if(B(0) == beta){
-							c[i+j*ldc] = alpha * temp;
-						}else{
-							c[i+j*ldc] = alpha * temp + beta * c[i+j*ldc];
-						}
+			// Rest of the block column
+			if('L' == uplo){
+				if(jj+jb < n){
+					if('N' == trans){
+						MultMM<'N','C'>(n-jj-jb, jb, k, alpha, &a[jj+jb+0*lda], lda, &a[jj+0*lda], lda, beta, &c[jj+jb+jj*ldc], ldc);
+					}else{
+						MultMM<'C','N'>(n-jj-jb, jb, k, alpha, &a[0+(jj+jb)*lda], lda, &a[0+jj*lda], lda, beta, &c[jj+jb+jj*ldc], ldc);
 					}
 				}
-			}else{ // Form  C := alpha*A'*B' + beta*C
-				for(size_t j = 0; j < n; ++j){
-					for(size_t i = 0; i < m; ++i){
-						T temp = 0;
-						for(size_t l = 0; l < k; ++l){
-							temp += a[l+i*lda] * b[j+l*ldb];
-						}
-						if(B(0) == beta){
-							c[i+j*ldc] = alpha * temp;
-						}else{
-							c[i+j*ldc] = alpha * temp + beta * c[i+j*ldc];
-						}
+			}else{
+				if(jj > 0){
+					if('N' == trans){
+						MultMM<'N','C'>(jj, jb, k, alpha, a, lda, &a[jj+0*lda], lda, beta, &c[0+jj*ldc], ldc);
+					}else{
+						MultMM<'C','N'>(jj, jb, k, alpha, a, lda, &a[0+jj*lda], lda, beta, &c[0+jj*ldc], ldc);
 					}
 				}
 			}
@@ -1172,6 +1519,13 @@ struct MultTrM{ // ztrmm, dtrmm, ctrmm, strmm
 	 
 		if(m == 0 || n == 0){ return; }
 
+		// Columns of B are independent when A is applied from the left, rows otherwise
+		if(lside ? _ParallelFor(n, 1, 0.5*m*m*n, [&](size_t j0, size_t j1){
+				MultTrM<side,uplo,transa,diag>(m, j1-j0, alpha, a, lda, &b[j0*ldb], ldb);
+			}) : _ParallelFor(m, 8, 0.5*m*n*n, [&](size_t i0, size_t i1){
+				MultTrM<side,uplo,transa,diag>(i1-i0, n, alpha, a, lda, &b[i0], ldb);
+			})){ return; }
+
 		if(alpha == TA(0)){
 			for(size_t j = 0; j < n; ++j){
 				for(size_t i = 0; i < m; ++i){
@@ -1221,9 +1575,9 @@ struct MultTrM{ // ztrmm, dtrmm, ctrmm, strmm
 									temp += a[k+i*lda]*b[k+j*ldb];
 								}
 							}else{
-								if(nounit) temp *= std::conj(a[i+i*lda]);
+								if(nounit) temp *= _RealOrComplexChooser<T>::_conj(a[i+i*lda]);
 								for(size_t k = 0; k < i; ++k){
-									temp += std::conj(a[k+i*lda])*b[k+j*ldb];
+									temp += _RealOrComplexChooser<T>::_conj(a[k+i*lda])*b[k+j*ldb];
 								}
 							}
 							b[i+j*ldb] = alpha*temp;
@@ -1239,9 +1593,9 @@ struct MultTrM{ // ztrmm, dtrmm, ctrmm, strmm
 									temp += a[k+i*lda]*b[k+j*ldb];
 								}
 							}else{
-								if(nounit) temp *= std::conj(a[i+i*lda]);
+								if(nounit) temp *= _RealOrComplexChooser<T>::_conj(a[i+i*lda]);
 								for(size_t k = i+1; k < m; ++k){
-									temp += std::conj(a[k+i*lda])*b[k+j*ldb];
+									temp += _RealOrComplexChooser<T>::_conj(a[k+i*lda])*b[k+j*ldb];
 								}
 							}
 							b[i+j*ldb] = alpha*temp;
@@ -1293,7 +1647,7 @@ struct MultTrM{ // ztrmm, dtrmm, ctrmm, strmm
 								if(noconj){
 									temp = alpha*a[j+k*lda];
 								}else{
-									temp = alpha*std::conj(a[j+k*lda]);
+									temp = alpha*_RealOrComplexChooser<T>::_conj(a[j+k*lda]);
 								}
 								for(size_t i = 0; i < m; ++i){
 									b[i+j*ldb] += temp*b[i+k*ldb];
@@ -1305,7 +1659,7 @@ struct MultTrM{ // ztrmm, dtrmm, ctrmm, strmm
 							if(noconj){
 								temp *= a[k+k*lda];
 							}else{
-								temp *= std::conj(a[k+k*lda]);
+								temp *= _RealOrComplexChooser<T>::_conj(a[k+k*lda]);
 							}
 						}
 						if(temp != T(1)){
@@ -1322,7 +1676,7 @@ struct MultTrM{ // ztrmm, dtrmm, ctrmm, strmm
 								if(noconj){
 									temp = alpha*a[j+k*lda];
 								}else{
-									temp = alpha*std::conj(a[j+k*lda]);
+									temp = alpha*_RealOrComplexChooser<T>::_conj(a[j+k*lda]);
 								}
 								for(size_t i = 0; i < m; ++i){
 									b[i+j*ldb] += temp*b[i+k*ldb];
@@ -1334,7 +1688,7 @@ struct MultTrM{ // ztrmm, dtrmm, ctrmm, strmm
 							if(noconj){
 								temp *= a[k+k*lda];
 							}else{
-								temp = temp*std::conj(a[k+k*lda]);
+								temp = temp*_RealOrComplexChooser<T>::_conj(a[k+k*lda]);
 							}
 						}
 						if(temp != T(1)){
@@ -1422,6 +1776,14 @@ struct SolveTrM{ // ztrsm, dtrsm, ctrsm, strsm
 
 		if(m == 0 || n == 0){ return; }
 
+		// Each right-hand side is solved independently: columns of B when A is
+		// applied from the left, rows otherwise
+		if(lside ? _ParallelFor(n, 1, 0.5*m*m*n, [&](size_t j0, size_t j1){
+				SolveTrM<side,uplo,transa,diag>(m, j1-j0, alpha, a, lda, &b[j0*ldb], ldb);
+			}) : _ParallelFor(m, 8, 0.5*m*n*n, [&](size_t i0, size_t i1){
+				SolveTrM<side,uplo,transa,diag>(i1-i0, n, alpha, a, lda, &b[i0], ldb);
+			})){ return; }
+
 		if(TA(0) == alpha){
 			for(size_t j = 0; j < n; ++j){
 				for(size_t i = 0; i < m; ++i){
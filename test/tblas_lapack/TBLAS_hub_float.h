@@ -0,0 +1,69 @@
+#ifndef _RNP_TBLAS_HUB_FLOAT_H_
+#define _RNP_TBLAS_HUB_FLOAT_H_
+
+// Specializations of the blocked GEMM for hub_float.
+// Include this header before any level-3 routine is instantiated for hub_float;
+// without it the generic kernel is used, which gives the same results more slowly.
+
+#include "TBLAS.h"
+#include "../../src/hub_float.hpp"
+
+namespace RNP{
+namespace TBLAS{
+
+template <>
+struct _GemmBlocking<hub_float>{
+	static constexpr size_t mr = 4;
+	static constexpr size_t nr = 2;
+	static constexpr size_t mc = 128;
+	static constexpr size_t kc = 256;
+	static constexpr size_t nc = 2048;
+	static bool UseBlocked(size_t m, size_t n, size_t k){
+		return m >= 2*mr && n >= 2*nr && m*n*k >= 16*16*16;
+	}
+};
+
+// The accumulators are kept as plain doubles and every product and sum is
+// rounded with hub_float::quantize, the same rounding the hub_float operators
+// apply, so the results are bit-identical to the generic kernel, including the
+// terms it skips for zero entries of op(B). Avoiding a hub_float temporary per
+// operation lets the tile stay in registers.
+template <>
+struct _GemmMicroKernel<hub_float>{
+	static void Run(size_t kc, const hub_float *ap, const hub_float *bp, const unsigned *bm, hub_float *c, size_t ldc, size_t mr_, size_t nr_){
+		const size_t mr = _GemmBlocking<hub_float>::mr;
+		const size_t nr = _GemmBlocking<hub_float>::nr;
+		double acc[mr*nr];
+		for(size_t j = 0; j < nr; ++j){
+			for(size_t i = 0; i < mr; ++i){
+				acc[i+j*mr] = (i < mr_ && j < nr_) ? double(c[i+j*ldc]) : 0.0;
+			}
+		}
+		for(size_t l = 0; l < kc; ++l){
+			const hub_float *al = &ap[l*mr];
+			const hub_float *bl = &bp[l*nr];
+			const unsigned mask = bm[l];
+			// Fully unrolled so the accumulators stay in registers
+#pragma GCC unroll 8
+			for(size_t j = 0; j < nr; ++j){
+				if(!(mask & (1u << j))){ continue; }
+				const double bj = double(bl[j]);
+#pragma GCC unroll 8
+				for(size_t i = 0; i < mr; ++i){
+					const double prod = hub_float::quantize(bj * double(al[i]));
+					acc[i+j*mr] = hub_float::quantize(acc[i+j*mr] + prod);
+				}
+			}
+		}
+		for(size_t j = 0; j < nr_; ++j){
+			for(size_t i = 0; i < mr_; ++i){
+				c[i+j*ldc] = hub_float(acc[i+j*mr]);
+			}
+		}
+	}
+};
+
+} // namespace TBLAS
+} // namespace RNP
+
+#endif // _RNP_TBLAS_HUB_FLOAT_H_
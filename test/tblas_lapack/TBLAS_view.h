@@ -0,0 +1,71 @@
+#ifndef _RNP_TBLAS_VIEW_H_
+#define _RNP_TBLAS_VIEW_H_
+
+#include "TBLAS.h"
+#include "LinearSolve.h"
+#include "../common/matrix_view.hpp"
+
+// TBLAS and LinearSolve on MatrixView operands of either layout, without
+// copying. The column-major routines see a row-major view of A through its
+// storage, which is A' in column-major order with the same leading dimension,
+// and compensate with the transposed form of the operation.
+
+namespace RNP{
+namespace View{
+
+// Keeps the read-only operands out of template argument deduction, so that
+// MatrixView<T> arguments convert to MatrixView<const T>
+template <class T>
+struct _ConstView{ typedef MatrixView<const T> type; };
+
+// y = alpha*A*x + beta*y
+template <class A, class B, class T>
+void MultMV(const A &alpha, const typename _ConstView<T>::type &a, const T *x, size_t incx, const B &beta, T *y, size_t incy){
+	if(a.isColumnMajor()){
+		RNP::TBLAS::MultMV<'N'>(a.getRows(), a.getCols(), alpha, a.data(), a.getLeadingDimension(), x, incx, beta, y, incy);
+	}else{
+		RNP::TBLAS::MultMV<'T'>(a.getCols(), a.getRows(), alpha, a.data(), a.getLeadingDimension(), x, incx, beta, y, incy);
+	}
+}
+
+// C = alpha*A*B + beta*C. A row-major C is filled as C' = B'*A'.
+template <class A, class B, class T>
+void MultMM(const A &alpha, const typename _ConstView<T>::type &a, const typename _ConstView<T>::type &b, const B &beta, const MatrixView<T> &c){
+	if(!c.isColumnMajor()){
+		MultMM(alpha, b.transposed(), a.transposed(), beta, c.transposed());
+		return;
+	}
+	const size_t m = c.getRows(), n = c.getCols(), k = a.getCols();
+	const T *pa = a.data(), *pb = b.data();
+	const size_t lda = a.getLeadingDimension(), ldb = b.getLeadingDimension(), ldc = c.getLeadingDimension();
+	if(a.isColumnMajor()){
+		if(b.isColumnMajor()){
+			RNP::TBLAS::MultMM<'N','N'>(m, n, k, alpha, pa, lda, pb, ldb, beta, c.data(), ldc);
+		}else{
+			RNP::TBLAS::MultMM<'N','T'>(m, n, k, alpha, pa, lda, pb, ldb, beta, c.data(), ldc);
+		}
+	}else{
+		if(b.isColumnMajor()){
+			RNP::TBLAS::MultMM<'T','N'>(m, n, k, alpha, pa, lda, pb, ldb, beta, c.data(), ldc);
+		}else{
+			RNP::TBLAS::MultMM<'T','T'>(m, n, k, alpha, pa, lda, pb, ldb, beta, c.data(), ldc);
+		}
+	}
+}
+
+// Solves A*X = B for square A as RNP::LinearSolve; A is overwritten by the LU
+// factors of its storage (of A' for a row-major view) and the column-major
+// n x nRHS B by X
+template <class T>
+void LinearSolve(const MatrixView<T> &a, size_t nRHS, T *b, size_t ldb, int *info = NULL, size_t *pivots = NULL){
+	if(a.isColumnMajor()){
+		RNP::LinearSolve<'N'>(a.getRows(), nRHS, a.data(), a.getLeadingDimension(), b, ldb, info, pivots);
+	}else{
+		RNP::LinearSolve<'T'>(a.getRows(), nRHS, a.data(), a.getLeadingDimension(), b, ldb, info, pivots);
+	}
+}
+
+} // namespace View
+} // namespace RNP
+
+#endif // _RNP_TBLAS_VIEW_H_
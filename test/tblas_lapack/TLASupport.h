@@ -43,6 +43,7 @@ and are in the public domain.
 #include <complex>
 #include <cmath>
 #include <limits>
+#include <vector>
 #include "TBLAS.h"
 
 /*
@@ -270,7 +271,6 @@ struct CheapMatrixNorm{ // zlange, dlange, clange, slange
 		}else if('I' == norm){ // max row sum
 			if(NULL == work){ // can't accumulate row sums
 				for(size_t i = 0; i < m; ++i){
-					size_t jstart = 0; if(i > 0){ jstart = i-1; }
 					real_type sum = 0;
 					for(size_t j = 0; j < n; ++j){
 						sum += RNP::TBLAS::_RealOrComplexChooser<T>::_abs(a[i+j*lda]);
@@ -615,17 +615,17 @@ void GenerateElementaryReflector(size_t n, T *alpha, T *x, size_t incx, T *tau){
 	using namespace std;
 
 	if(n == 0){
-		tau = 0;
+		*tau = 0;
 		return;
 	}
 	
 	real_type xnorm = RNP::TBLAS::Norm2( n-1, x, incx );
 	if(xnorm == 0 && RNP::TBLAS::_RealOrComplexChooser<T>::_imag(*alpha) == 0){ // H  =  I
-		tau = 0;
+		*tau = 0;
 	}else{ // general case
 		real_type beta = RNP::TLASupport::Pythag3( RNP::TBLAS::_RealOrComplexChooser<T>::_real(*alpha), RNP::TBLAS::_RealOrComplexChooser<T>::_imag(*alpha), xnorm );
 		if(RNP::TBLAS::_RealOrComplexChooser<T>::_real(*alpha) > 0){ beta = -beta; };
-		const real_type safmin = std::numeric_limits<real_type>::min() / (2*std::numeric_limits<real_type>::epsilon());
+		const real_type safmin = std::numeric_limits<real_type>::min() / (real_type(2)*std::numeric_limits<real_type>::epsilon());
 		const real_type rsafmn = real_type(1) / safmin;
 		// 
 		size_t knt = 0;
@@ -790,6 +790,153 @@ void GenerateElementaryReflectorPositive(size_t n, T *alpha, T *x, size_t incx,
 }
 
 
+template <class T> // zlarft, dlarft, clarft, slarft
+void FormBlockReflectorTriangularFactor(size_t n, size_t k, const T *v, size_t ldv, const T *tau, T *t, size_t ldt){
+	// Forms the k by k upper triangular factor T of the block reflector
+	//       H = H(1) H(2) . . . H(k) = I - V * T * V'
+	// where the i-th column of the n by k matrix V holds the vector of H(i),
+	// with v(0:i-1) = 0 and v(i) = 1, as stored by QRFactorization. This is
+	// the forward, columnwise case of ZLARFT; the unit diagonal and the zeros
+	// above it are implied, so the upper triangle of V is not referenced.
+
+	// Arguments
+	// =========
+
+	// N       The order of the block reflector H. N >= K.
+
+	// K       The number of elementary reflectors.
+
+	// V       (input) array, dimension (LDV,K)
+	//         The vectors of the elementary reflectors below the diagonal.
+
+	// TAU     (input) array, dimension (K)
+	//         TAU(i) must contain the scalar factor of H(i).
+
+	// T       (output) array, dimension (LDT,K)
+	//         The upper triangular factor; the strictly lower triangle
+	//         is not referenced.
+
+	for(size_t i = 0; i < k; ++i){
+		if(T(0) == tau[i]){ // H(i) = I
+			for(size_t j = 0; j <= i; ++j){
+				t[j+i*ldt] = T(0);
+			}
+			continue;
+		}
+		// T(0:i-1,i) := -tau(i) * V(i:n-1,0:i-1)' * V(i:n-1,i)
+		const T mtau = -tau[i];
+		for(size_t j = 0; j < i; ++j){
+			t[j+i*ldt] = mtau * RNP::TBLAS::_RealOrComplexChooser<T>::_conj(v[i+j*ldv]);
+		}
+		if(i+1 < n){
+			RNP::TBLAS::MultMV<'C'>(n-i-1, i, mtau, &v[i+1+0*ldv], ldv, &v[i+1+i*ldv], 1, T(1), &t[0+i*ldt], 1);
+		}
+		// T(0:i-1,i) := T(0:i-1,0:i-1) * T(0:i-1,i)
+		RNP::TBLAS::MultTrV<'U','N','N'>(i, t, ldt, &t[0+i*ldt], 1);
+		t[i+i*ldt] = tau[i];
+	}
+}
+
+template <char side='L', char trans='N'>
+struct ApplyBlockReflector{ // zlarfb, dlarfb, clarfb, slarfb
+	template <class T>
+	ApplyBlockReflector(size_t m, size_t n, size_t k, const T *v, size_t ldv, const T *t, size_t ldt,
+		T *c, size_t ldc, T *work, size_t ldwork)
+	{
+		// Applies the block reflector H = I - V * T * V' formed by
+		// FormBlockReflectorTriangularFactor, or its conjugate transpose H',
+		// to an m by n matrix C, from the left or the right. Apart from two
+		// small triangular products the work is done by MultMM.
+
+		// Arguments
+		// =========
+
+		// SIDE    = 'L': apply H or H' from the Left
+		//         = 'R': apply H or H' from the Right
+
+		// TRANS   = 'N': apply H  (No transpose)
+		//         = 'C': apply H' (Conjugate transpose)
+
+		// K       The number of elementary reflectors in H.
+		//         K <= M if SIDE = 'L', K <= N if SIDE = 'R'.
+
+		// V       (input) array, dimension (LDV,K)
+		//         Unit lower trapezoidal, as for FormBlockReflectorTriangularFactor.
+		//         The upper triangle is not referenced.
+
+		// T       (input) array, dimension (LDT,K)
+		//         The upper triangular factor of H.
+
+		// C       (input/output) array, dimension (LDC,N)
+		//         On exit, C is overwritten by H*C, H'*C, C*H or C*H'.
+
+		// WORK    (workspace) array, dimension (LDWORK,K)
+		//         LDWORK >= N if SIDE = 'L', LDWORK >= M if SIDE = 'R'.
+
+		if(m < 1 || n < 1 || k < 1){ return; }
+
+		if('L' == side){
+			// W := C1' (n by k), C1 the first k rows of C
+			for(size_t j = 0; j < k; ++j){
+				for(size_t i = 0; i < n; ++i){
+					work[i+j*ldwork] = RNP::TBLAS::_RealOrComplexChooser<T>::_conj(c[j+i*ldc]);
+				}
+			}
+			// W := W * V1 + C2' * V2
+			RNP::TBLAS::MultTrM<'R','L','N','U'>(n, k, T(1), v, ldv, work, ldwork);
+			if(m > k){
+				RNP::TBLAS::MultMM<'C','N'>(n, k, m-k, T(1), &c[k+0*ldc], ldc, &v[k+0*ldv], ldv, T(1), work, ldwork);
+			}
+			// W := W * T' for H, W * T for H'
+			if('N' == trans){
+				RNP::TBLAS::MultTrM<'R','U','C','N'>(n, k, T(1), t, ldt, work, ldwork);
+			}else{
+				RNP::TBLAS::MultTrM<'R','U','N','N'>(n, k, T(1), t, ldt, work, ldwork);
+			}
+			// C2 := C2 - V2 * W'
+			if(m > k){
+				RNP::TBLAS::MultMM<'N','C'>(m-k, n, k, T(-1), &v[k+0*ldv], ldv, work, ldwork, T(1), &c[k+0*ldc], ldc);
+			}
+			// C1 := C1 - V1 * W'
+			RNP::TBLAS::MultTrM<'R','L','C','U'>(n, k, T(1), v, ldv, work, ldwork);
+			for(size_t j = 0; j < k; ++j){
+				for(size_t i = 0; i < n; ++i){
+					c[j+i*ldc] -= RNP::TBLAS::_RealOrComplexChooser<T>::_conj(work[i+j*ldwork]);
+				}
+			}
+		}else{
+			// W := C1 (m by k), C1 the first k columns of C
+			for(size_t j = 0; j < k; ++j){
+				for(size_t i = 0; i < m; ++i){
+					work[i+j*ldwork] = c[i+j*ldc];
+				}
+			}
+			// W := W * V1 + C2 * V2
+			RNP::TBLAS::MultTrM<'R','L','N','U'>(m, k, T(1), v, ldv, work, ldwork);
+			if(n > k){
+				RNP::TBLAS::MultMM<'N','N'>(m, k, n-k, T(1), &c[0+k*ldc], ldc, &v[k+0*ldv], ldv, T(1), work, ldwork);
+			}
+			// W := W * T for H, W * T' for H'
+			if('N' == trans){
+				RNP::TBLAS::MultTrM<'R','U','N','N'>(m, k, T(1), t, ldt, work, ldwork);
+			}else{
+				RNP::TBLAS::MultTrM<'R','U','C','N'>(m, k, T(1), t, ldt, work, ldwork);
+			}
+			// C2 := C2 - W * V2'
+			if(n > k){
+				RNP::TBLAS::MultMM<'N','C'>(m, n-k, k, T(-1), work, ldwork, &v[k+0*ldv], ldv, T(1), &c[0+k*ldc], ldc);
+			}
+			// C1 := C1 - W * V1'
+			RNP::TBLAS::MultTrM<'R','L','C','U'>(m, k, T(1), v, ldv, work, ldwork);
+			for(size_t j = 0; j < k; ++j){
+				for(size_t i = 0; i < m; ++i){
+					c[i+j*ldc] -= work[i+j*ldwork];
+				}
+			}
+		}
+	}
+};
+
 template <char side='L', char trans='N'>
 struct ApplyOrthognalMatrixFromElementaryReflectors{ // zunmqr, zunm2r, cunmqr, cunm2r
 	template <class T>
@@ -969,8 +1116,8 @@ void GenerateOrthognalMatrixFromElementaryReflectors(size_t m, size_t n, size_t
 	}
 }
 
-template <class T> // zgeqrf, zgeqr2, dgeqrf, dgeqr2, cgeqrf, cgeqr2, sgeqrf, sgeqr2
-void QRFactorization(size_t m, size_t n, T *a, size_t lda, T *tau, T *work){
+template <class T> // zgeqr2, dgeqr2, cgeqr2, sgeqr2
+void UnblockedQRFactorization(size_t m, size_t n, T *a, size_t lda, T *tau, T *work){
 	using namespace std;
 
 	// ZGEQR2 computes a QR factorization of a complex m by n matrix A = Q * R.
@@ -1016,14 +1163,76 @@ void QRFactorization(size_t m, size_t n, T *a, size_t lda, T *tau, T *work){
 		RNP::TLASupport::GenerateElementaryReflector(m-i, &a[i+i*lda], &a[row+i*lda], 1, &tau[i]);
 		if(i < n-1){
 			// Apply H(i)' to A(i:m,i+1:n) from the left
-			std::complex<double> alpha = a[i+i*lda];
+			T alpha = a[i+i*lda];
 			a[i+i*lda] = 1;
-			RNP::TLASupport::ApplyElementaryReflector<'L'>(m-i, n-i-1, &a[i+i*lda], 1, std::conj(tau[i]), &a[i+(i+1)*lda], lda, work);
+			RNP::TLASupport::ApplyElementaryReflector<'L'>(m-i, n-i-1, &a[i+i*lda], 1, RNP::TBLAS::_RealOrComplexChooser<T>::_conj(tau[i]), &a[i+(i+1)*lda], lda, work);
 			a[i+i*lda] = alpha;
 		}
 	}
 }
 
+// Factors the m by n panel A, n <= ldt, and forms the triangular factor T of its
+// block reflector, as UnblockedQRFactorization and then
+// FormBlockReflectorTriangularFactor would. The columns are split in halves: the
+// left half is factored, its block reflector is applied to the right half, and the
+// rest of the right half is factored, both recursively. T is then assembled from
+// the factors of the halves as
+//   T = [ T1  -T1*V1'*V2*T2 ]
+//       [ 0         T2      ]
+// so most of the panel work, including T, is done by MultMM.
+template <class T>
+void _RecursiveQRPanel(size_t m, size_t n, T *a, size_t lda, T *tau, T *t, size_t ldt, T *work){
+	static const size_t nleaf = 4;
+	if(n <= nleaf || m <= n){
+		UnblockedQRFactorization(m, n, a, lda, tau, work);
+		FormBlockReflectorTriangularFactor(m, n, a, lda, tau, t, ldt);
+		return;
+	}
+	const size_t n1 = n/2;
+	const size_t n2 = n-n1;
+	_RecursiveQRPanel(m, n1, a, lda, tau, t, ldt, work);
+	ApplyBlockReflector<'L','C'>(m, n2, n1, a, lda, t, ldt, &a[0+n1*lda], lda, work, n2);
+	_RecursiveQRPanel(m-n1, n2, &a[n1+n1*lda], lda, &tau[n1], &t[n1+n1*ldt], ldt, work);
+
+	// T12 := V1' * V2, where V2 is zero above row n1 and unit lower triangular in
+	// rows n1:n
+	T *t12 = &t[0+n1*ldt];
+	for(size_t j = 0; j < n2; ++j){
+		for(size_t i = 0; i < n1; ++i){
+			t12[i+j*ldt] = RNP::TBLAS::_RealOrComplexChooser<T>::_conj(a[n1+j+i*lda]);
+		}
+	}
+	RNP::TBLAS::MultTrM<'R','L','N','U'>(n1, n2, T(1), &a[n1+n1*lda], lda, t12, ldt);
+	if(m > n){
+		RNP::TBLAS::MultMM<'C','N'>(n1, n2, m-n, T(1), &a[n+0*lda], lda, &a[n+n1*lda], lda, T(1), t12, ldt);
+	}
+	// T12 := -T1 * T12 * T2
+	RNP::TBLAS::MultTrM<'L','U','N','N'>(n1, n2, T(1), t, ldt, t12, ldt);
+	RNP::TBLAS::MultTrM<'R','U','N','N'>(n1, n2, T(-1), &t[n1+n1*ldt], ldt, t12, ldt);
+}
+
+// Blocked Householder QR factorization, A = Q*R, with the same output format as
+// UnblockedQRFactorization. Each panel of nb columns is factored recursively
+// (see _RecursiveQRPanel), and its reflectors are applied to the trailing matrix at once as the block
+// reflector I - V*T*V' (compact WY form), so that the bulk of the work is done
+// by MultMM.
+template <class T> // zgeqrf, dgeqrf, cgeqrf, sgeqrf
+void QRFactorization(size_t m, size_t n, T *a, size_t lda, T *tau){
+	static const size_t nb = 32;
+	const size_t k = (m < n ? m : n);
+	std::vector<T> work(n*nb);
+	std::vector<T> t(nb*nb);
+	for(size_t j = 0; j < k; j += nb){
+		const size_t jb = (k-j < nb ? k-j : nb);
+		// Factor the panel A(j:m,j:j+jb) and form the T of its block reflector
+		_RecursiveQRPanel(m-j, jb, &a[j+j*lda], lda, &tau[j], &t[0], nb, &work[0]);
+		if(j+jb < n){
+			// Apply H' = (H(j) ... H(j+jb-1))' to A(j:m,j+jb:n) from the left
+			ApplyBlockReflector<'L','C'>(m-j, n-j-jb, jb, &a[j+j*lda], lda, &t[0], nb, &a[j+(j+jb)*lda], lda, &work[0], n);
+		}
+	}
+}
+
 template <class T> // zlartg, dlartg, clartg, slartg
 void GeneratePlaneRotation(const T &f, const T &g, typename RNP::TBLAS::_RealOrComplexChooser<T>::real_type *cs, T *sn, T *r)
 {
@@ -1110,7 +1319,7 @@ void GeneratePlaneRotation(const T &f, const T &g, typename RNP::TBLAS::_RealOrC
 			*cs = 0;
 			*r = RNP::TBLAS::_RealOrComplexChooser<T>::_abs(g);
 			// Do complex/real division explicitly with two real divisions */
-			*sn = gs/abs(gs);
+			*sn = gs/real_type(abs(gs));
 			return;
 		}
 		real_type f2s = abs(fs);
@@ -1521,8 +1730,39 @@ struct GeneralizedHessenbergReduction{ // zgghrd, dgghrd, cgghrd, sgghrd
 	}
 };
 
-template <class T> // zgetrf, dgetrf, cgetrf, sgetrf
-int LUDecomposition(size_t m, size_t n, T *a, size_t lda, size_t *pivots){
+// if inv is true, the permuations are applied in reverse order (applies the inverse permutation
+template <char side, char inv>
+struct ApplyPermutations{
+	template <class T>
+	ApplyPermutations(size_t m, size_t n, T *a, size_t lda, const size_t *pivots){
+		if('L' == side){
+			for(size_t i = 0; i < m; ++i){
+				size_t ip;
+				if('N' == inv){
+					ip = pivots[i];
+				}else{
+					ip = pivots[m-1-i];
+				}
+				if(i == ip){ continue; }
+				RNP::TBLAS::Swap(n, &a[i+0*lda],lda, &a[ip+0*lda],lda);
+			}
+		}else{
+			for(size_t j = 0; j < n; ++j){
+				size_t jp;
+				if('N' == inv){
+					jp = pivots[j];
+				}else{
+					jp = pivots[m-1-j];
+				}
+				if(j == jp){ continue; }
+				RNP::TBLAS::Swap(m, &a[0+j*lda],1, &a[0+jp*lda],1);
+			}
+		}
+	}
+};
+
+template <class T> // zgetf2, dgetf2, cgetf2, sgetf2
+int UnblockedLUDecomposition(size_t m, size_t n, T *a, size_t lda, size_t *pivots){
 	int info = 0;
 	size_t min_dim = (m < n ? m : n);
 	for(size_t j = 0; j < min_dim; ++j){
@@ -1535,15 +1775,61 @@ int LUDecomposition(size_t m, size_t n, T *a, size_t lda, size_t *pivots){
 			if(j < m){
 				RNP::TBLAS::Scale(m-j-1, T(1)/a[j+j*lda], &a[j+1+j*lda], 1); // possible overflow when inverting A(j,j)
 			}
-		}else{
-			info = j;
+		}else if(0 == info){
+			info = j+1; // first exactly zero pivot, 1-based
 		}
 		if(j < min_dim){
 			RNP::TBLAS::Rank1Update(m-j-1, n-j-1, T(-1), &a[j+1+j*lda], 1, &a[j+(j+1)*lda], lda, &a[j+1+(j+1)*lda], lda);
 		}
 	}
-	if(0 != info){ return info+1; }
-	return 0;
+	return info;
+}
+
+// Right-looking blocked LU with partial pivoting, P*A = L*U. Each panel of nb
+// columns is factored by UnblockedLUDecomposition, its row interchanges are
+// applied to the rest of A, and the trailing matrix is updated with MultMM.
+// Every element receives the same operations in the same order as in
+// UnblockedLUDecomposition, so the factors and pivots are identical in every
+// rounding mode. For this reason the block row of U is computed with the
+// rank-1 updates of the unblocked factorization rather than with SolveTrM:
+// those form -1*y before multiplying, which is not exact under every rounding.
+// Returns 0, or the 1-based index of the first exactly zero pivot.
+template <class T> // zgetrf, dgetrf, cgetrf, sgetrf
+int LUDecomposition(size_t m, size_t n, T *a, size_t lda, size_t *pivots){
+	static const size_t nb = 64;
+	size_t min_dim = (m < n ? m : n);
+	if(min_dim <= nb){
+		return UnblockedLUDecomposition(m, n, a, lda, pivots);
+	}
+	int info = 0;
+	for(size_t j = 0; j < min_dim; j += nb){
+		const size_t jb = (min_dim-j < nb ? min_dim-j : nb);
+		// Factor the panel A(j:m,j:j+jb); its pivots are relative to row j
+		int iinfo = UnblockedLUDecomposition(m-j, jb, &a[j+j*lda], lda, &pivots[j]);
+		if(0 == info && iinfo > 0){ info = iinfo + (int)j; }
+		// Apply the interchanges to the columns left and right of the panel
+		ApplyPermutations<'L','N'>(jb, j, &a[j+0*lda], lda, &pivots[j]);
+		if(j+jb < n){
+			ApplyPermutations<'L','N'>(jb, n-j-jb, &a[j+(j+jb)*lda], lda, &pivots[j]);
+			// Compute the block row of U, then update the trailing matrix
+			auto block_row = [&](size_t c0, size_t c1){
+				T *u = &a[j+(j+jb+c0)*lda];
+				for(size_t k = 0; k+1 < jb; ++k){
+					RNP::TBLAS::Rank1Update(jb-k-1, c1-c0, T(-1), &a[j+k+1+(j+k)*lda], 1, &u[k], lda, &u[k+1], lda);
+				}
+			};
+			if(!RNP::TBLAS::_ParallelFor(n-j-jb, 1, 0.5*double(jb)*jb*(n-j-jb), block_row)){
+				block_row(0, n-j-jb);
+			}
+			if(j+jb < m){
+				RNP::TBLAS::MultMM<'N','N'>(m-j-jb, n-j-jb, jb, T(-1), &a[j+jb+j*lda], lda, &a[j+(j+jb)*lda], lda, T(1), &a[j+jb+(j+jb)*lda], lda);
+			}
+		}
+		for(size_t i = j; i < j+jb; ++i){
+			pivots[i] += j;
+		}
+	}
+	return info;
 }
 
 
@@ -1578,6 +1864,267 @@ struct LUSolve{
 	}
 };
 
+template <char uplo, class T> // zpotf2, dpotf2, cpotf2, spotf2
+int UnblockedCholeskyDecomposition(size_t n, T *a, size_t lda){
+	typedef typename RNP::TBLAS::_RealOrComplexChooser<T>::real_type real_type;
+	using namespace std;
+	for(size_t j = 0; j < n; ++j){
+		if('U' == uplo){ // A = U'*U
+			// Compute U(j,j) and test for non-positive-definiteness (or NaN)
+			real_type ajj = RNP::TBLAS::_RealOrComplexChooser<T>::_real(a[j+j*lda])
+				- RNP::TBLAS::_RealOrComplexChooser<T>::_real(RNP::TBLAS::ConjugateDot(j, &a[0+j*lda], 1, &a[0+j*lda], 1));
+			if(!(ajj > 0)){
+				a[j+j*lda] = ajj;
+				return (int)j+1;
+			}
+			ajj = sqrt(ajj);
+			a[j+j*lda] = ajj;
+			// Compute elements j+1:n of row j
+			if(j+1 < n){
+				RNP::TBLAS::Conjugate(j, &a[0+j*lda], 1);
+				RNP::TBLAS::MultMV<'T'>(j, n-j-1, T(-1), &a[0+(j+1)*lda], lda, &a[0+j*lda], 1, T(1), &a[j+(j+1)*lda], lda);
+				RNP::TBLAS::Conjugate(j, &a[0+j*lda], 1);
+				RNP::TBLAS::Scale(n-j-1, real_type(1)/ajj, &a[j+(j+1)*lda], lda);
+			}
+		}else{ // A = L*L'
+			// Compute L(j,j) and test for non-positive-definiteness (or NaN)
+			real_type ajj = RNP::TBLAS::_RealOrComplexChooser<T>::_real(a[j+j*lda])
+				- RNP::TBLAS::_RealOrComplexChooser<T>::_real(RNP::TBLAS::ConjugateDot(j, &a[j+0*lda], lda, &a[j+0*lda], lda));
+			if(!(ajj > 0)){
+				a[j+j*lda] = ajj;
+				return (int)j+1;
+			}
+			ajj = sqrt(ajj);
+			a[j+j*lda] = ajj;
+			// Compute elements j+1:n of column j
+			if(j+1 < n){
+				RNP::TBLAS::Conjugate(j, &a[j+0*lda], lda);
+				RNP::TBLAS::MultMV<'N'>(n-j-1, j, T(-1), &a[j+1+0*lda], lda, &a[j+0*lda], lda, T(1), &a[j+1+j*lda], 1);
+				RNP::TBLAS::Conjugate(j, &a[j+0*lda], lda);
+				RNP::TBLAS::Scale(n-j-1, real_type(1)/ajj, &a[j+1+j*lda], 1);
+			}
+		}
+	}
+	return 0;
+}
+
+// Blocked Cholesky factorization of a Hermitian positive definite matrix,
+// A = U'*U (uplo = 'U') or A = L*L' (uplo = 'L'). For each diagonal block of nb
+// columns the contribution of the columns before it is subtracted with
+// HermRankKUpdate, the block is factored by UnblockedCholeskyDecomposition, and
+// the rest of its block row of U (block column of L) is computed with MultMM and
+// SolveTrM. Only the triangle given by uplo is referenced. Returns 0, or the order
+// of the first leading minor that is not positive definite, in which case the
+// factorization is incomplete.
+template <char uplo, class T> // zpotrf, dpotrf, cpotrf, spotrf
+int CholeskyDecomposition(size_t n, T *a, size_t lda){
+	typedef typename RNP::TBLAS::_RealOrComplexChooser<T>::real_type real_type;
+	static const size_t nb = 64;
+	if(n <= nb){
+		return UnblockedCholeskyDecomposition<uplo>(n, a, lda);
+	}
+	for(size_t j = 0; j < n; j += nb){
+		const size_t jb = (n-j < nb ? n-j : nb);
+		if('U' == uplo){
+			// Update and factor the diagonal block
+			RNP::TBLAS::HermRankKUpdate<'U','C'>(jb, j, real_type(-1), &a[0+j*lda], lda, real_type(1), &a[j+j*lda], lda);
+			int info = UnblockedCholeskyDecomposition<'U'>(jb, &a[j+j*lda], lda);
+			if(0 != info){ return info + (int)j; }
+			if(j+jb < n){
+				// Compute the rest of the block row
+				RNP::TBLAS::MultMM<'C','N'>(jb, n-j-jb, j, T(-1), &a[0+j*lda], lda, &a[0+(j+jb)*lda], lda, T(1), &a[j+(j+jb)*lda], lda);
+				RNP::TBLAS::SolveTrM<'L','U','C','N'>(jb, n-j-jb, T(1), &a[j+j*lda], lda, &a[j+(j+jb)*lda], lda);
+			}
+		}else{
+			// Update and factor the diagonal block
+			RNP::TBLAS::HermRankKUpdate<'L','N'>(jb, j, real_type(-1), &a[j+0*lda], lda, real_type(1), &a[j+j*lda], lda);
+			int info = UnblockedCholeskyDecomposition<'L'>(jb, &a[j+j*lda], lda);
+			if(0 != info){ return info + (int)j; }
+			if(j+jb < n){
+				// Compute the rest of the block column
+				RNP::TBLAS::MultMM<'N','C'>(n-j-jb, jb, j, T(-1), &a[j+jb+0*lda], lda, &a[j+0*lda], lda, T(1), &a[j+jb+j*lda], lda);
+				RNP::TBLAS::SolveTrM<'R','L','C','N'>(n-j-jb, jb, T(1), &a[j+j*lda], lda, &a[j+jb+j*lda], lda);
+			}
+		}
+	}
+	return 0;
+}
+
+template <char uplo='L'>
+struct CholeskySolve{ // zpotrs, dpotrs, cpotrs, spotrs
+	template <class T>
+	CholeskySolve(size_t n, size_t nRHS, const T *a, size_t lda, T *b, size_t ldb){
+		// Solves A*X = B with the factors computed by CholeskyDecomposition<uplo>
+		if(0 == n || nRHS == 0){ return; }
+		if('U' == uplo){ // A = U'*U
+			RNP::TBLAS::SolveTrM<'L','U','C','N'>(n, nRHS, T(1), a, lda, b, ldb);
+			RNP::TBLAS::SolveTrM<'L','U','N','N'>(n, nRHS, T(1), a, lda, b, ldb);
+		}else{ // A = L*L'
+			RNP::TBLAS::SolveTrM<'L','L','N','N'>(n, nRHS, T(1), a, lda, b, ldb);
+			RNP::TBLAS::SolveTrM<'L','L','C','N'>(n, nRHS, T(1), a, lda, b, ldb);
+		}
+	}
+};
+
+// Reduces a real symmetric matrix A to symmetric tridiagonal form T by an
+// orthogonal similarity transformation, Q'*A*Q = T, with Q the product
+//   Q = H(0) H(1) ... H(n-2)
+// of elementary reflectors H(i) = I - tau[i]*v*v', where v(0:i) = 0, v(i+1) = 1
+// and v(i+2:n-1) is stored on exit in A(i+2:n-1,i). Only the lower triangle of A
+// is referenced. On exit the diagonal of T is in d[0:n-1] and its subdiagonal,
+// also on the subdiagonal of A, in e[0:n-2]; tau needs n-1 entries and is also
+// used as workspace. Each step costs a MultHermV and a rank 2 update, so the
+// reduction is level 2 throughout.
+template <class T> // dsytd2, ssytd2 (uplo = 'L')
+void TridiagonalReduction(size_t n, T *a, size_t lda, T *d, T *e, T *tau){
+	if(0 == n){ return; }
+	for(size_t i = 0; i+1 < n; ++i){
+		const size_t m = n-i-1; // order of the trailing matrix A(i+1:n-1,i+1:n-1)
+		T *v = &a[(i+1)+i*lda];
+		T taui;
+		// Annihilate A(i+2:n-1,i)
+		T alpha = v[0];
+		GenerateElementaryReflector(m, &alpha, &a[(i+2 < n ? i+2 : n-1)+i*lda], 1, &taui);
+		e[i] = alpha;
+		if(T(0) != taui){
+			v[0] = T(1);
+			T *w = &tau[i];
+			// w := tau*A*v - (tau/2)*(w'*v)*v
+			RNP::TBLAS::MultHermV<'L'>(m, taui, &a[(i+1)+(i+1)*lda], lda, v, 1, T(0), w, 1);
+			const T beta = T(-0.5) * taui * RNP::TBLAS::Dot(m, w, 1, v, 1);
+			RNP::TBLAS::Axpy(m, beta, v, 1, w, 1);
+			// A := A - v*w' - w*v', lower triangle (dsyr2)
+			for(size_t j = 0; j < m; ++j){
+				T *ajj = &a[(i+1+j)+(i+1+j)*lda];
+				RNP::TBLAS::Axpy(m-j, -w[j], &v[j], 1, ajj, 1);
+				RNP::TBLAS::Axpy(m-j, -v[j], &w[j], 1, ajj, 1);
+			}
+			v[0] = e[i];
+		}
+		d[i] = a[i+i*lda];
+		tau[i] = taui;
+	}
+	d[n-1] = a[(n-1)+(n-1)*lda];
+}
+
+// Overwrites the n by n matrix A, as returned by TridiagonalReduction, with the
+// orthogonal Q of the reduction: the reflector vectors are shifted one column to
+// the right and expanded by GenerateOrthognalMatrixFromElementaryReflectors.
+// work needs n-1 entries.
+template <class T> // dorgtr, sorgtr (uplo = 'L')
+void GenerateOrthogonalMatrixFromTridiagonalReduction(size_t n, T *a, size_t lda, const T *tau, T *work){
+	if(0 == n){ return; }
+	for(size_t j = n-1; j > 0; --j){
+		a[0+j*lda] = T(0);
+		for(size_t i = j+1; i < n; ++i){
+			a[i+j*lda] = a[i+(j-1)*lda];
+		}
+	}
+	a[0] = T(1);
+	for(size_t i = 1; i < n; ++i){
+		a[i] = T(0);
+	}
+	if(n > 1){
+		GenerateOrthognalMatrixFromElementaryReflectors(n-1, n-1, n-1, &a[1+1*lda], (int)lda, tau, work);
+	}
+}
+
+// Computes all eigenvalues, and optionally eigenvectors, of the real symmetric
+// tridiagonal matrix with diagonal d[0:n-1] and subdiagonal e[0:n-2], by the
+// implicit QL method with Wilkinson shifts (as in EISPACK's tql2). An
+// off-diagonal element is set to zero once
+//   |e[m]| <= eps * (|d[m]| + |d[m+1]|)
+// with eps the epsilon of T. If z is not NULL, the plane rotations are applied
+// to the columns of the n by n matrix Z, which should hold the identity for the
+// eigenvectors of T, or the Q of TridiagonalReduction for those of A. On exit d
+// holds the eigenvalues in ascending order, with the columns of Z permuted to
+// match, and e is destroyed. Returns 0, or the number of off-diagonal elements
+// that had not converged after 30*n QL sweeps (d is then unordered).
+template <class T> // dsteqr, ssteqr (compz = 'V')
+int SymmetricTridiagonalQL(size_t n, T *d, T *e, T *z, size_t ldz){
+	using namespace std;
+	if(0 == n){ return 0; }
+	const T eps = std::numeric_limits<T>::epsilon();
+	const size_t max_sweeps = 30*n;
+	size_t sweeps = 0;
+	std::vector<T> sub(n, T(0)); // sub[i] couples d[i] and d[i+1]; sub[n-1] = 0
+	for(size_t i = 0; i+1 < n; ++i){ sub[i] = e[i]; }
+
+	for(size_t l = 0; l < n; ++l){
+		for(;;){
+			// Find a small subdiagonal element to split off the block l:m
+			size_t m = l;
+			for(; m+1 < n; ++m){
+				const T dd = T(abs(d[m])) + T(abs(d[m+1]));
+				if(T(abs(sub[m])) <= eps*dd){ break; }
+			}
+			if(m == l){ break; }
+			if(sweeps == max_sweeps){
+				int info = 0;
+				for(size_t i = 0; i+1 < n; ++i){
+					if(T(0) != sub[i]){ ++info; }
+					e[i] = sub[i];
+				}
+				return info;
+			}
+			++sweeps;
+
+			// Wilkinson shift from the leading 2 by 2 block
+			T g = (d[l+1] - d[l]) / (T(2)*sub[l]);
+			T r = Pythag2(g, T(1));
+			g = d[m] - d[l] + sub[l] / (g + (g < T(0) ? T(-abs(r)) : T(abs(r))));
+			T s(1), c(1), p(0);
+			bool deflated = false;
+			for(size_t i = m; i-- > l; ){
+				const T f = s*sub[i];
+				const T b = c*sub[i];
+				r = Pythag2(f, g);
+				sub[i+1] = r;
+				if(T(0) == r){ // underflow: deflate and restart the sweep
+					d[i+1] -= p;
+					sub[m] = T(0);
+					deflated = true;
+					break;
+				}
+				s = f/r;
+				c = g/r;
+				g = d[i+1] - p;
+				r = (d[i] - g)*s + T(2)*c*b;
+				p = s*r;
+				d[i+1] = g + p;
+				g = c*r - b;
+				if(NULL != z){ // Z(:,i:i+1) := Z(:,i:i+1) * [c -s; s c]'
+					T *zi = &z[i*ldz], *zi1 = &z[(i+1)*ldz];
+					for(size_t k = 0; k < n; ++k){
+						const T t = zi1[k];
+						zi1[k] = s*zi[k] + c*t;
+						zi[k] = c*zi[k] - s*t;
+					}
+				}
+			}
+			if(deflated){ continue; }
+			d[l] -= p;
+			sub[l] = g;
+			sub[m] = T(0);
+		}
+	}
+
+	// Selection sort into ascending order, swapping columns of Z along
+	for(size_t i = 0; i+1 < n; ++i){
+		size_t k = i;
+		for(size_t j = i+1; j < n; ++j){
+			if(d[j] < d[k]){ k = j; }
+		}
+		if(k != i){
+			std::swap(d[i], d[k]);
+			if(NULL != z){
+				RNP::TBLAS::Swap(n, &z[i*ldz], 1, &z[k*ldz], 1);
+			}
+		}
+	}
+	return 0;
+}
+
 template <class T>
 void Determinant(size_t n, T *a, size_t lda, T *mant, typename RNP::TBLAS::_RealOrComplexChooser<T>::real_type *base, int *expo, size_t *pivots = NULL){
 	typedef typename RNP::TBLAS::_RealOrComplexChooser<T>::real_type real_type;
@@ -1608,36 +2155,6 @@ void Determinant(size_t n, T *a, size_t lda, T *mant, typename RNP::TBLAS::_Real
 	}
 }
 
-// if inv is true, the permuations are applied in reverse order (applies the inverse permutation
-template <char side, char inv>
-struct ApplyPermutations{
-	template <class T>
-	ApplyPermutations(size_t m, size_t n, T *a, size_t lda, const size_t *pivots){
-		if('L' == side){
-			for(size_t i = 0; i < m; ++i){
-				size_t ip;
-				if('N' == inv){
-					ip = pivots[i];
-				}else{
-					ip = pivots[m-1-i];
-				}
-				if(i == ip){ continue; }
-				RNP::TBLAS::Swap(n, &a[i+0*lda],lda, &a[ip+0*lda],lda);
-			}
-		}else{
-			for(size_t j = 0; j < n; ++j){
-				size_t jp;
-				if('N' == inv){
-					jp = pivots[j];
-				}else{
-					jp = pivots[m-1-j];
-				}
-				if(j == jp){ continue; }
-				RNP::TBLAS::Swap(m, &a[0+j*lda],1, &a[0+jp*lda],1);
-			}
-		}
-	}
-};
 
 
 /*
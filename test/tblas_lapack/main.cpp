@@ -5,11 +5,25 @@
 #include <algorithm>
 #include <random>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <cstdint>
 #include "LinearSolve.h"
+#include "IterativeRefinement.h"
+#include "BatchedSolve.h"
+#include "LeastSquares.h"
+#include "Eigensystem.h"
+#include "RandomMatrix.h"
+#include "TBLAS_view.h"
+#include "TBLAS_hub_float.h"        // hub_float GEMM kernel, before any level-3 use
 #include "../../src/hub_float.hpp"  // Include hub_float header
 #include "../common/error_stats.hpp" // Include error stats header
 #include "../common/io_utils.hpp"    // Include IO utils header
 #include "../common/matrix.hpp"      // Include matrix header
+#include "../common/trial_scheduler.hpp"
+#include "../common/benchmark.hpp"
 
 // Function template for printing a matrix
 template<typename T>
@@ -91,186 +105,47 @@ void printErrorStats(const ErrorStats& stats, const std::string& description) {
     std::cout << std::endl;
 }
 
-// Function to determine if SNR has stabilized
-bool is_snr_stable(const std::vector<double>& snr_values, double threshold = 0.5, size_t min_trials = 5) {
-    if (snr_values.size() < min_trials) {
-        return false; // Need at least min_trials to determine stability
-    }
-
-    // Calculate variance of the last few SNR values
-    double sum = 0.0;
-    double sum_sq = 0.0;
-    
-    // Use the last min_trials values or all values if fewer
-    size_t start_idx = std::max(size_t(0), snr_values.size() - min_trials);
-    size_t count = snr_values.size() - start_idx;
-    
-    for (size_t i = start_idx; i < snr_values.size(); ++i) {
-        sum += snr_values[i];
-        sum_sq += snr_values[i] * snr_values[i];
-    }
-    
-    double mean = sum / count;
-    double variance = (sum_sq / count) - (mean * mean);
-    
-    // Also check if the mean is changing significantly
-    double prev_mean = 0.0;
-    if (snr_values.size() > min_trials * 2) {
-        double prev_sum = 0.0;
-        size_t prev_start = std::max(size_t(0), snr_values.size() - min_trials * 2);
-        size_t prev_count = std::min(min_trials, snr_values.size() - prev_start - min_trials);
-        
-        for (size_t i = prev_start; i < prev_start + prev_count; ++i) {
-            prev_sum += snr_values[i];
-        }
-        prev_mean = prev_sum / prev_count;
-    } else {
-        prev_mean = mean; // Not enough data for a good previous mean
-    }
-    
-    double mean_change = std::fabs(mean - prev_mean) / (std::fabs(mean) + 1e-6);
-    
-    return variance < threshold && mean_change < threshold;
-}
-
-// Generate random matrix and vector for testing
+// Random system A*x = b whose matrix has 2-norm condition number cond, with its
+// singular values spread from scale down to scale/cond by mode (see
+// RNP::SingularValueDistribution), and b uniform in [-scale, scale]. The system
+// depends only on seed.
 template<typename T>
-std::pair<Matrix<T>, std::vector<T>> generate_random_system(size_t size, double min_val = -100.0, double max_val = 100.0) {
-    // Create matrix A and vector b
+std::pair<Matrix<T>, std::vector<T>> generate_random_system(size_t size, double cond, std::uint64_t seed,
+                                                            char mode = 'G', double scale = 100.0) {
+    std::vector<double> a(size * size);
+    RNP::RandomConditionedMatrix(size, size, cond, mode, seed, a.data(), size);
+
     Matrix<T> A(size, size);
-    A.randomize(min_val, max_val);
-    
-    // Make the matrix diagonally dominant to ensure it's well-conditioned
     for (size_t i = 0; i < size; ++i) {
-        T row_sum = 0;
         for (size_t j = 0; j < size; ++j) {
-            if (i != j) row_sum += std::fabs(A(i, j));
+            A(i, j) = static_cast<T>(scale * a[i + j * size]);
         }
-        // Make diagonal element greater than sum of other elements in the row
-        A(i, i) = row_sum + static_cast<T>(1.0 + (rand() % 10));
     }
-    
-    // Create a random right-hand side vector
+
+    // Philox stream 3 of the seed; RandomConditionedMatrix draws from 0 to 2
     std::vector<T> b(size);
-    std::random_device rd;
-    std::mt19937 gen(42); // Fixed seed for reproducibility
-    std::uniform_real_distribution<double> dist(min_val, max_val);
-    
-    for (size_t i = 0; i < size; ++i) {
-        b[i] = static_cast<T>(dist(gen));
-    }
-    
+    PhiloxRandom(seed).fill_uniform(3, 0, size, b.data(), -scale, scale);
+
     return {A, b};
 }
 
-// Solve a matrix system with given precision - let's debug the hub_float issue
+// Solve A*x = b with RNP::LinearSolve. The row-major Matrix is handed over as a
+// view, which LinearSolve factors in place as A' and solves transposed, so only
+// the storage is copied, to keep A_orig intact.
 template<typename T>
 std::vector<T> solve_matrix_system(const Matrix<T>& A_orig, const std::vector<T>& b_orig, int* info = nullptr) {
-    size_t n = A_orig.getRows();
-    
-    // Copy A and b since they will be modified
-    T* A_copy = new T[n * n];
-    T* b_copy = new T[n];
-    
-    // Debug prints for investigating values
-    std::cout << "Matrix A values before LinearSolve:" << std::endl;
-    for (size_t i = 0; i < std::min(n, size_t(5)); ++i) {
-        for (size_t j = 0; j < std::min(n, size_t(5)); ++j) {
-            std::cout << static_cast<double>(A_orig(i, j)) << " ";
-            A_copy[i + j*n] = A_orig(i, j);
-        }
-        std::cout << std::endl;
-        b_copy[i] = b_orig[i];
-    }
-    std::cout << "Vector b values before LinearSolve:" << std::endl;
-    for (size_t i = 0; i < std::min(n, size_t(5)); ++i) {
-        std::cout << static_cast<double>(b_orig[i]) << " ";
+    if (A_orig.getRows() != A_orig.getCols() || A_orig.getRows() != b_orig.size()) {
+        throw std::runtime_error("Dimension mismatch in linear system solver");
     }
-    std::cout << std::endl;
-    
-    // Solve using RNP::LinearSolve
+    Matrix<T> A(A_orig);
+    std::vector<T> x(b_orig);
+
     int local_info = 0;
     if (info == nullptr) info = &local_info;
-    
-    try {
-        RNP::LinearSolve<>(n, 1, A_copy, n, b_copy, n, info);
-    } catch (const std::exception& e) {
-        std::cerr << "Exception during LinearSolve: " << e.what() << std::endl;
-        throw;
-    }
-    
-    // Check if LinearSolve returned an error
+    RNP::View::LinearSolve(A.view(), 1, x.data(), x.size(), info);
     if (*info != 0) {
         std::cerr << "LinearSolve returned error code: " << *info << std::endl;
     }
-    
-    // Debug prints for investigating values
-    std::cout << "Solution x values after LinearSolve:" << std::endl;
-    for (size_t i = 0; i < std::min(n, size_t(5)); ++i) {
-        std::cout << static_cast<double>(b_copy[i]) << " ";
-    }
-    std::cout << std::endl;
-    
-    // Check for zeros in the solution
-    bool all_zeros = true;
-    for (size_t i = 0; i < n && all_zeros; ++i) {
-        if (b_copy[i] != static_cast<T>(0)) {
-            all_zeros = false;
-        }
-    }
-    
-    if (all_zeros) {
-        std::cerr << "Warning: Solution vector contains all zeros!" << std::endl;
-        // Let's try a workaround by using double internally and converting back
-        if (std::is_same<T, hub_float>::value) {
-            std::cerr << "Attempting workaround for hub_float..." << std::endl;
-            
-            // Create double versions
-            double* A_double = new double[n * n];
-            double* b_double = new double[n];
-            
-            // Convert hub_float to double
-            for (size_t i = 0; i < n; ++i) {
-                for (size_t j = 0; j < n; ++j) {
-                    A_double[i + j*n] = static_cast<double>(A_orig(i, j));
-                }
-                b_double[i] = static_cast<double>(b_orig[i]);
-            }
-            
-            // Solve with double
-            int double_info = 0;
-            RNP::LinearSolve<>(n, 1, A_double, n, b_double, n, &double_info);
-            
-            // Convert back to hub_float
-            for (size_t i = 0; i < n; ++i) {
-                b_copy[i] = static_cast<T>(b_double[i]);
-            }
-            
-            // Clean up
-            delete[] A_double;
-            delete[] b_double;
-            
-            // Update info
-            *info = double_info;
-            
-            std::cout << "After workaround, solution is:" << std::endl;
-            for (size_t i = 0; i < std::min(n, size_t(5)); ++i) {
-                std::cout << static_cast<double>(b_copy[i]) << " ";
-            }
-            std::cout << std::endl;
-        }
-    }
-    
-    // Convert result to vector
-    std::vector<T> x(n);
-    for (size_t i = 0; i < n; ++i) {
-        x[i] = b_copy[i];
-    }
-    
-    // Clean up
-    delete[] A_copy;
-    delete[] b_copy;
-    
     return x;
 }
 
@@ -283,7 +158,6 @@ std::vector<T> solve_using_matrix_class(const Matrix<T>& A, const std::vector<T>
         
         // Verify solution
         if (A.validateSolution(x, b)) {
-            std::cout << "Matrix class solver succeeded" << std::endl;
             return x;
         } else {
             std::cerr << "Matrix class solver failed validation" << std::endl;
@@ -296,19 +170,118 @@ std::vector<T> solve_using_matrix_class(const Matrix<T>& A, const std::vector<T>
     return solve_matrix_system(A, b);
 }
 
-// Run an exhaustive test with stability check
-void run_exhaustive_test() {
-    // Test parameters
-    std::vector<size_t> matrix_sizes = {10, 20, 50, 100};
-    const size_t max_trials = 50;       // Maximum number of trials per matrix size
-    const double snr_threshold = 0.1;   // Threshold for SNR stability
-    const size_t min_trials = 5;        // Minimum number of trials before checking stability
+// One trial of the exhaustive test: errors of the float and hub_float solutions
+// against the double one, and the files holding the system and reference
+struct ExhaustiveTrial {
+    ErrorStats float_stats;
+    ErrorStats hub_stats;
+    std::string matrix_file;
+    std::string b_file;
+    std::string x_ref_file;
+};
+
+// Solve a random system of the given size and condition number in double, float
+// and hub_float, saving the system and the solutions under data_dir
+bool run_exhaustive_trial(size_t size, double cond, std::uint64_t seed, const std::string& file_tag,
+                          const std::string& data_dir, ExhaustiveTrial& out) {
+    // Trials run in parallel; each one keeps the level-3 routines to itself
+    RNP::TBLAS::SerialScope serial;
+    auto [A_double, b_double] = generate_random_system<double>(size, cond, seed);
+
+    // Solve with double precision (reference solution)
+    std::vector<double> x_double = solve_matrix_system(A_double, b_double);
+
+    // Save reference matrix and vectors for this trial
+    out.matrix_file = data_dir + "/matrix_" + file_tag + ".txt";
+    write_matrix_text(out.matrix_file, A_double);
+    out.b_file = data_dir + "/b_vector_" + file_tag + ".txt";
+    write_vector_text(out.b_file, b_double);
+    out.x_ref_file = data_dir + "/x_ref_" + file_tag + ".txt";
+    write_vector_text(out.x_ref_file, x_double);
+
+    // Convert to float precision and solve
+    Matrix<float> A_float(size, size);
+    std::vector<float> b_float(size);
+    for (size_t i = 0; i < size; ++i) {
+        for (size_t j = 0; j < size; ++j) {
+            A_float(i, j) = static_cast<float>(A_double(i, j));
+        }
+        b_float[i] = static_cast<float>(b_double[i]);
+    }
+    std::vector<float> x_float = solve_matrix_system(A_float, b_float);
+    write_vector_text(data_dir + "/x_float_" + file_tag + ".txt", x_float);
+
+    // Convert to hub_float precision and solve
+    Matrix<hub_float> A_hub(size, size);
+    std::vector<hub_float> b_hub(size);
+    for (size_t i = 0; i < size; ++i) {
+        for (size_t j = 0; j < size; ++j) {
+            A_hub(i, j) = static_cast<double>(A_double(i, j));
+        }
+        b_hub[i] = static_cast<double>(b_double[i]);
+    }
+    std::vector<hub_float> x_hub = solve_using_matrix_class(A_hub, b_hub);
+    write_vector_text(data_dir + "/x_hub_" + file_tag + ".txt", x_hub);
+
+    out.float_stats = calculate_errors(x_double, x_float);
+    out.hub_stats = calculate_errors(x_double, x_hub);
+    return true;
+}
+
+// Average the per-trial statistics of one case; min and max over all trials
+ErrorStats summarize_trials(const std::vector<ErrorStats>& trials) {
+    ErrorStats summary;
+    if (trials.empty()) {
+        return summary;
+    }
+    summary = trials[0];
+    for (size_t i = 1; i < trials.size(); ++i) {
+        summary.avg_error = (summary.avg_error * i + trials[i].avg_error) / (i + 1);
+        summary.relative_error = (summary.relative_error * i + trials[i].relative_error) / (i + 1);
+        summary.variance = (summary.variance * i + trials[i].variance) / (i + 1);
+        summary.snr = (summary.snr * i + trials[i].snr) / (i + 1);
+        summary.signed_avg_error = (summary.signed_avg_error * i + trials[i].signed_avg_error) / (i + 1);
+        summary.mse = (summary.mse * i + trials[i].mse) / (i + 1);
+        summary.rmse = (summary.rmse * i + trials[i].rmse) / (i + 1);
+        summary.max_error = std::max(summary.max_error, trials[i].max_error);
+        summary.min_error = std::min(summary.min_error, trials[i].min_error);
+    }
+    return summary;
+}
+
+// Run every size at every condition number, each case until the 95% confidence
+// intervals on the mean SNR and RMSE of both float and hub_float are narrow
+// enough (see AdaptiveTrialScheduler) or max_trials have run
+void run_exhaustive_test(size_t threads) {
+    // Test parameters: every size at every condition number
+    const std::vector<size_t> sizes = {10, 20, 50, 100};
+    const std::vector<double> conditions = {1e1, 1e3, 1e5, 1e7};
+    AdaptiveTrialScheduler::Options options;
+    options.min_trials = 10;
+    options.max_trials = 100;
+    options.batch_size = 8;
+    // Mean SNR to within 0.5 dB and RMSE to within 10%. The mean relative error
+    // is dominated by rare solution components near zero and is only tracked
+    const std::vector<MetricTarget> targets = {
+        {"float SNR", 0.0, 0.5}, {"float RMSE", 0.10, 0.0}, {"float rel error"},
+        {"hub SNR", 0.0, 0.5},   {"hub RMSE", 0.10, 0.0},   {"hub rel error"}};
+    ThreadPool pool(threads);
 
     // Create directory for output data
     std::string timestamp = get_timestamp();
     std::string data_dir = "tblas_results_" + timestamp;
     ensure_directory_exists(data_dir);
 
+    // One test case per (size, condition number)
+    std::vector<size_t> matrix_sizes;
+    std::vector<double> condition_numbers;
+    for (double cond : conditions) {
+        for (size_t size : sizes) {
+            matrix_sizes.push_back(size);
+            condition_numbers.push_back(cond);
+        }
+    }
+
     // Prepare data structures for storing results
     std::vector<std::vector<ErrorStats>> float_trials(matrix_sizes.size());
     std::vector<std::vector<ErrorStats>> hub_trials(matrix_sizes.size());
@@ -320,252 +293,773 @@ void run_exhaustive_test() {
     std::vector<std::vector<std::string>> b_vector_files(matrix_sizes.size());
     std::vector<std::vector<std::string>> x_ref_files(matrix_sizes.size());
     
-    // Test each matrix size
+    size_t total_trials = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    // Test each case
     for (size_t size_idx = 0; size_idx < matrix_sizes.size(); ++size_idx) {
         size_t size = matrix_sizes[size_idx];
-        std::cout << "\n===== TESTING MATRIX SIZE: " << size << "x" << size << " =====" << std::endl;
-        
-        // Track SNR values to check stability
-        std::vector<double> float_snr_values;
-        std::vector<double> hub_snr_values;
-        
-        // Running statistics for float and hub_float
-        double float_avg_snr = 0.0;
-        double hub_avg_snr = 0.0;
-        
-        // Run trials until stability or max trials reached
-        size_t trial = 0;
-        bool float_stable = false;
-        bool hub_stable = false;
-        
-        while (trial < max_trials && (!float_stable || !hub_stable)) {
-            std::cout << "Trial " << trial + 1 << " of max " << max_trials << std::endl;
-            
-            // Generate a random system
-            auto [A_double, b_double] = generate_random_system<double>(size);
-            
-            // Solve with double precision (reference solution)
-            std::vector<double> x_double;
-            try {
-                x_double = solve_matrix_system(A_double, b_double);
-            } catch (const std::exception& e) {
-                std::cerr << "Error solving double precision: " << e.what() << std::endl;
-                continue; // Skip this trial if it fails
-            }
-            
-            // Save reference matrix and vectors for this trial
-            std::string matrix_file = data_dir + "/matrix_" + std::to_string(size) + "_trial_" + std::to_string(trial) + ".txt";
-            write_matrix_text(matrix_file, A_double);
-            matrix_files[size_idx].push_back(matrix_file);
-            
-            std::string b_file = data_dir + "/b_vector_" + std::to_string(size) + "_trial_" + std::to_string(trial) + ".txt";
-            write_vector_text(b_file, b_double);
-            b_vector_files[size_idx].push_back(b_file);
-            
-            std::string x_ref_file = data_dir + "/x_ref_" + std::to_string(size) + "_trial_" + std::to_string(trial) + ".txt";
-            write_vector_text(x_ref_file, x_double);
-            x_ref_files[size_idx].push_back(x_ref_file);
-            
-            // Convert to float precision
-            Matrix<float> A_float(size, size);
-            std::vector<float> b_float(size);
-            
-            for (size_t i = 0; i < size; ++i) {
-                for (size_t j = 0; j < size; ++j) {
-                    A_float(i, j) = static_cast<float>(A_double(i, j));
-                }
-                b_float[i] = static_cast<float>(b_double[i]);
-            }
-            
-            // Solve with float precision
-            std::vector<float> x_float;
-            try {
-                x_float = solve_matrix_system(A_float, b_float);
-            } catch (const std::exception& e) {
-                std::cerr << "Error solving float precision: " << e.what() << std::endl;
-                continue; // Skip this trial if it fails
-            }
-            
-            // Save float solution
-            std::string x_float_file = data_dir + "/x_float_" + std::to_string(size) + "_trial_" + std::to_string(trial) + ".txt";
-            write_vector_text(x_float_file, x_float);
-            
-            // Convert to hub_float precision
-            Matrix<hub_float> A_hub(size, size);
-            std::vector<hub_float> b_hub(size);
-            
-            for (size_t i = 0; i < size; ++i) {
-                for (size_t j = 0; j < size; ++j) {
-                    A_hub(i, j) = static_cast<double>(A_double(i, j));
-                }
-                b_hub[i] = static_cast<double>(b_double[i]);
-            }
-            
-            // Solve with hub_float precision
-            std::vector<hub_float> x_hub;
-            try {
-                // First try the specialized matrix class solver
-                x_hub = solve_using_matrix_class(A_hub, b_hub);
-                
-                // If we get an empty or all-zero solution, try the workaround
-                bool all_zeros = true;
-                for (const auto& val : x_hub) {
-                    if (val != static_cast<hub_float>(0)) {
-                        all_zeros = false;
-                        break;
-                    }
-                }
-                
-                if (all_zeros || x_hub.empty()) {
-                    std::cerr << "Got all zeros or empty solution from hub_float solver, trying direct conversion" << std::endl;
-                    
-                    // Create a direct conversion from the double solution
-                    x_hub.resize(size);
-                    for (size_t i = 0; i < size; ++i) {
-                        x_hub[i] = static_cast<hub_float>(x_double[i]);
-                    }
-                    
-                    // Validate that this solution is reasonable
-                    std::vector<hub_float> Ax = A_hub.multiply(x_hub);
-                    double error = 0.0;
-                    for (size_t i = 0; i < size; ++i) {
-                        error += std::abs(static_cast<double>(Ax[i] - b_hub[i]));
-                    }
-                    error /= size;
-                    
-                    std::cout << "Direct conversion solution with average error: " << error << std::endl;
-                    if (error > 1.0) {
-                        std::cerr << "Direct conversion solution has high error, falling back to original solution" << std::endl;
-                        x_hub = solve_matrix_system(A_hub, b_hub);
-                    }
-                }
-                
-                std::cout << "hub_float solution: ";
-                for (size_t i = 0; i < std::min(x_hub.size(), size_t(5)); ++i) {
-                    std::cout << static_cast<double>(x_hub[i]) << " ";
-                }
-                std::cout << std::endl;
-            } catch (const std::exception& e) {
-                std::cerr << "Error solving hub_float precision: " << e.what() << std::endl;
-                
-                // As fallback, try direct conversion from double
-                std::cout << "Using direct conversion from double as fallback" << std::endl;
-                x_hub.resize(size);
-                for (size_t i = 0; i < size; ++i) {
-                    x_hub[i] = static_cast<hub_float>(x_double[i]);
-                }
-                
-                std::cout << "Fallback hub_float solution: ";
-                for (size_t i = 0; i < std::min(x_hub.size(), size_t(5)); ++i) {
-                    std::cout << static_cast<double>(x_hub[i]) << " ";
-                }
-                std::cout << std::endl;
-            }
-            
-            // Save hub_float solution
-            std::string x_hub_file = data_dir + "/x_hub_" + std::to_string(size) + "_trial_" + std::to_string(trial) + ".txt";
-            write_vector_text(x_hub_file, x_hub);
-            
-            // Calculate error statistics
-            ErrorStats float_stats = calculate_errors(x_double, x_float);
-            ErrorStats hub_stats = calculate_errors(x_double, x_hub);
-            
-            // Store the stats
-            float_trials[size_idx].push_back(float_stats);
-            hub_trials[size_idx].push_back(hub_stats);
-            
-            // Track SNR values for stability check
-            float_snr_values.push_back(float_stats.snr);
-            hub_snr_values.push_back(hub_stats.snr);
-            
-            // Update running statistics
-            float_avg_snr = (float_avg_snr * trial + float_stats.snr) / (trial + 1);
-            hub_avg_snr = (hub_avg_snr * trial + hub_stats.snr) / (trial + 1);
-            
-            // Output current trial stats
-            std::cout << "Float SNR: " << float_stats.snr << " dB, Hub SNR: " << hub_stats.snr << " dB" << std::endl;
-            std::cout << "Float Rel Error: " << float_stats.relative_error << ", Hub Rel Error: " << hub_stats.relative_error << std::endl;
-            
-            // Check if SNR has stabilized
-            if (!float_stable) {
-                float_stable = is_snr_stable(float_snr_values, snr_threshold, min_trials);
-            }
-            if (!hub_stable) {
-                hub_stable = is_snr_stable(hub_snr_values, snr_threshold, min_trials);
-            }
-            
-            if (float_stable && hub_stable) {
-                std::cout << "SNR has stabilized for both float and hub_float after " << trial + 1 << " trials." << std::endl;
-            }
-            
-            trial++;
+        double cond = condition_numbers[size_idx];
+        const int cond_exponent = static_cast<int>(std::lround(std::log10(cond)));
+        const std::string case_tag = std::to_string(size) + "_cond_1e" + std::to_string(cond_exponent);
+        std::cout << "\n===== TESTING MATRIX SIZE: " << size << "x" << size
+                  << ", CONDITION NUMBER: 1e" << cond_exponent << " =====" << std::endl;
+
+        // The seed identifies the case and trial, so every thread count runs the same systems
+        AdaptiveTrialScheduler scheduler(targets, options, &pool);
+        std::vector<ExhaustiveTrial> results = scheduler.run<ExhaustiveTrial>(
+            [&](size_t trial, ExhaustiveTrial& out) {
+                const std::uint64_t seed = (std::uint64_t(size) << 32) | (std::uint64_t(cond_exponent) << 16) | trial;
+                return run_exhaustive_trial(size, cond, seed, case_tag + "_trial_" + std::to_string(trial), data_dir, out);
+            },
+            [](const ExhaustiveTrial& t) {
+                return std::vector<double>{t.float_stats.snr, t.float_stats.rmse, t.float_stats.relative_error,
+                                           t.hub_stats.snr, t.hub_stats.rmse, t.hub_stats.relative_error};
+            });
+        total_trials += scheduler.trials_run();
+        if (!scheduler.failure_message().empty()) {
+            std::cerr << "Skipped failing trials, first " << scheduler.failure_message() << std::endl;
         }
-        
-        // Calculate summary statistics for this matrix size
-        if (!float_trials[size_idx].empty()) {
-            float_summary[size_idx] = float_trials[size_idx][0]; // Start with first trial
-            for (size_t i = 1; i < float_trials[size_idx].size(); ++i) {
-                // Update average values
-                float_summary[size_idx].avg_error = (float_summary[size_idx].avg_error * i + float_trials[size_idx][i].avg_error) / (i + 1);
-                float_summary[size_idx].relative_error = (float_summary[size_idx].relative_error * i + float_trials[size_idx][i].relative_error) / (i + 1);
-                float_summary[size_idx].variance = (float_summary[size_idx].variance * i + float_trials[size_idx][i].variance) / (i + 1);
-                float_summary[size_idx].snr = (float_summary[size_idx].snr * i + float_trials[size_idx][i].snr) / (i + 1);
-                float_summary[size_idx].signed_avg_error = (float_summary[size_idx].signed_avg_error * i + float_trials[size_idx][i].signed_avg_error) / (i + 1);
-                float_summary[size_idx].mse = (float_summary[size_idx].mse * i + float_trials[size_idx][i].mse) / (i + 1);
-                float_summary[size_idx].rmse = (float_summary[size_idx].rmse * i + float_trials[size_idx][i].rmse) / (i + 1);
-                
-                // Update min/max
-                float_summary[size_idx].max_error = std::max(float_summary[size_idx].max_error, float_trials[size_idx][i].max_error);
-                float_summary[size_idx].min_error = std::min(float_summary[size_idx].min_error, float_trials[size_idx][i].min_error);
-            }
+
+        for (size_t i = 0; i < results.size(); ++i) {
+            float_trials[size_idx].push_back(results[i].float_stats);
+            hub_trials[size_idx].push_back(results[i].hub_stats);
+            matrix_files[size_idx].push_back(results[i].matrix_file);
+            b_vector_files[size_idx].push_back(results[i].b_file);
+            x_ref_files[size_idx].push_back(results[i].x_ref_file);
         }
-        
-        if (!hub_trials[size_idx].empty()) {
-            hub_summary[size_idx] = hub_trials[size_idx][0]; // Start with first trial
-            for (size_t i = 1; i < hub_trials[size_idx].size(); ++i) {
-                // Update average values
-                hub_summary[size_idx].avg_error = (hub_summary[size_idx].avg_error * i + hub_trials[size_idx][i].avg_error) / (i + 1);
-                hub_summary[size_idx].relative_error = (hub_summary[size_idx].relative_error * i + hub_trials[size_idx][i].relative_error) / (i + 1);
-                hub_summary[size_idx].variance = (hub_summary[size_idx].variance * i + hub_trials[size_idx][i].variance) / (i + 1);
-                hub_summary[size_idx].snr = (hub_summary[size_idx].snr * i + hub_trials[size_idx][i].snr) / (i + 1);
-                hub_summary[size_idx].signed_avg_error = (hub_summary[size_idx].signed_avg_error * i + hub_trials[size_idx][i].signed_avg_error) / (i + 1);
-                hub_summary[size_idx].mse = (hub_summary[size_idx].mse * i + hub_trials[size_idx][i].mse) / (i + 1);
-                hub_summary[size_idx].rmse = (hub_summary[size_idx].rmse * i + hub_trials[size_idx][i].rmse) / (i + 1);
-                
-                // Update min/max
-                hub_summary[size_idx].max_error = std::max(hub_summary[size_idx].max_error, hub_trials[size_idx][i].max_error);
-                hub_summary[size_idx].min_error = std::min(hub_summary[size_idx].min_error, hub_trials[size_idx][i].min_error);
-            }
+        float_summary[size_idx] = summarize_trials(float_trials[size_idx]);
+        hub_summary[size_idx] = summarize_trials(hub_trials[size_idx]);
+
+        // Print summary for this case, with the confidence interval half-widths
+        const double float_avg_snr = scheduler.statistics(0).mean();
+        const double hub_avg_snr = scheduler.statistics(3).mean();
+        std::cout << "Trials completed: " << scheduler.trials_accepted() << " of " << scheduler.trials_run()
+                  << (scheduler.converged() ? " (converged)" : " (max trials reached)") << std::endl;
+        for (size_t k = 0; k < targets.size(); ++k) {
+            std::cout << "  " << std::left << std::setw(16) << targets[k].name << std::right
+                      << scheduler.statistics(k).mean() << " +/- " << scheduler.half_width(k) << std::endl;
         }
-        
-        // Print summary for this matrix size
-        std::cout << "\n===== SUMMARY FOR MATRIX SIZE " << size << "x" << size << " =====" << std::endl;
-        std::cout << "Trials completed: " << trial << std::endl;
-        std::cout << "Float average SNR: " << float_avg_snr << " dB" << std::endl;
-        std::cout << "Hub_float average SNR: " << hub_avg_snr << " dB" << std::endl;
         std::cout << "SNR improvement ratio: " << (hub_avg_snr / float_avg_snr) << std::endl;
         std::cout << "SNR improvement in dB: " << (hub_avg_snr - float_avg_snr) << " dB" << std::endl;
     }
     
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "\n" << total_trials << " trials in " << seconds << " s on " << pool.size() << " thread(s)" << std::endl;
+
     // Save all results to CSV
     std::string csv_file = data_dir + "/results_summary.csv";
-    write_csv(csv_file, data_dir, matrix_sizes, float_trials, hub_trials, float_summary, hub_summary, 
+    write_csv(csv_file, data_dir, matrix_sizes, condition_numbers, float_trials, hub_trials, float_summary, hub_summary, 
               matrix_files, b_vector_files, x_ref_files);
     
     std::cout << "\nAll test results saved in directory: " << data_dir << std::endl;
 }
 
-int main() {
+// Mixed-precision iterative refinement: factor in float or hub_float, refine in double,
+// and compare with a pure double LU solve on the same matrices
+struct RefinementResult {
+    std::string type;
+    size_t iterations = 0;
+    bool converged = true;
+    double seconds = 0.0;
+    double forward_error = 0.0;
+};
+
+// ||x - x_true||_inf / ||x_true||_inf
+double forward_error(const std::vector<double>& x, const std::vector<double>& x_true) {
+    double err = 0.0, norm = 0.0;
+    for (size_t i = 0; i < x.size(); i++) {
+        err = std::max(err, std::fabs(x[i] - x_true[i]));
+        norm = std::max(norm, std::fabs(x_true[i]));
+    }
+    return err / norm;
+}
+
+template<typename TF>
+RefinementResult refine_with(const char* type, const std::vector<double>& A, const std::vector<double>& b,
+                             const std::vector<double>& x_true, size_t n) {
+    RefinementResult result;
+    result.type = type;
+    std::vector<double> x(n);
+    auto start = std::chrono::steady_clock::now();
+    int info = RNP::RefinedLinearSolve<TF>(n, 1, A.data(), n, b.data(), n, x.data(), n, &result.iterations);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.converged = (info == 0);
+    result.forward_error = forward_error(x, x_true);
+    return result;
+}
+
+void run_refinement_test() {
+    std::vector<size_t> matrix_sizes = {100, 200, 500, 1000};
+    std::vector<double> condition_numbers = {1e1, 1e3, 1e5, 1e7};
+    const size_t trials = 3;
+
+    std::string timestamp = get_timestamp();
+    std::string data_dir = "tblas_results_" + timestamp;
+    ensure_directory_exists(data_dir);
+    std::string csv_file = data_dir + "/refinement.csv";
+    std::ofstream csv(csv_file);
+    csv << "size,cond,trial,type,iterations,converged,seconds,forward_error" << std::endl;
+
+    std::cout << "\n===== MIXED-PRECISION ITERATIVE REFINEMENT =====" << std::endl;
+    std::cout << std::setw(6) << "size" << std::setw(9) << "cond" << std::setw(7) << "trial" << std::setw(12) << "type"
+              << std::setw(7) << "iter" << std::setw(12) << "time (s)" << std::setw(14) << "fwd error" << std::endl;
+
+    for (size_t n : matrix_sizes) {
+        for (double cond : condition_numbers) {
+            double total_iterations[2] = {0.0, 0.0};
+            size_t failures[2] = {0, 0};
+            double total_seconds[3] = {0.0, 0.0, 0.0};
+            for (size_t trial = 0; trial < trials; trial++) {
+                // Dense random system with condition number cond and a known solution
+                const std::uint64_t seed = 1000 * n + trial;
+                std::vector<double> A(n * n), x_true(n), b(n, 0.0);
+                RNP::RandomConditionedMatrix(n, n, cond, 'G', seed, A.data(), n);
+                std::mt19937 gen(static_cast<unsigned>(seed));
+                std::uniform_real_distribution<double> dist(-1.0, 1.0);
+                for (double& v : x_true) v = dist(gen);
+                for (size_t j = 0; j < n; j++) {
+                    for (size_t i = 0; i < n; i++) {
+                        b[i] += A[i + j * n] * x_true[j];
+                    }
+                }
+
+                RefinementResult reference;
+                reference.type = "double";
+                std::vector<double> A_copy = A, x = b;
+                auto start = std::chrono::steady_clock::now();
+                int info = 0;
+                RNP::LinearSolve<>(n, 1, A_copy.data(), n, x.data(), n, &info);
+                reference.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                reference.converged = (info == 0);
+                reference.forward_error = forward_error(x, x_true);
+
+                RefinementResult results[3] = {
+                    reference,
+                    refine_with<float>("float", A, b, x_true, n),
+                    refine_with<hub_float>("hub_float", A, b, x_true, n)
+                };
+                for (size_t k = 0; k < 3; k++) {
+                    const RefinementResult& r = results[k];
+                    std::cout << std::setw(6) << n << std::setw(9) << std::setprecision(1) << cond
+                              << std::setw(7) << trial << std::setw(12) << r.type
+                              << std::setw(7) << (r.converged ? std::to_string(r.iterations) : std::string("fail"))
+                              << std::setw(12) << std::setprecision(4) << r.seconds
+                              << std::setw(14) << std::setprecision(3) << r.forward_error << std::endl;
+                    csv << n << "," << cond << "," << trial << "," << r.type << "," << r.iterations << ","
+                        << r.converged << "," << std::setprecision(9) << r.seconds << "," << r.forward_error << std::endl;
+                    total_seconds[k] += r.seconds;
+                    if (k > 0) {
+                        total_iterations[k - 1] += r.iterations;
+                        if (!r.converged) failures[k - 1]++;
+                    }
+                }
+            }
+            std::cout << "Size " << n << ", cond " << std::setprecision(1) << cond
+                      << ": mean iterations float " << std::setprecision(3) << total_iterations[0] / trials
+                      << " (" << failures[0] << " failed), hub_float " << total_iterations[1] / trials
+                      << " (" << failures[1] << " failed); time vs double: float "
+                      << total_seconds[1] / total_seconds[0] << "x, hub_float "
+                      << total_seconds[2] / total_seconds[0] << "x" << std::endl;
+        }
+    }
+
+    std::cout << "\nResults written to " << csv_file << std::endl;
+}
+
+// Batched small systems: throughput of BatchedLinearSolve on the interleaved layout
+// against one LinearSolve call per system, on the same random systems
+template<typename T>
+void bench_batched(const char* type, size_t n, size_t batch, std::ofstream& csv) {
+    std::mt19937 gen(static_cast<unsigned>(n));
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<T> A(batch * n * n), B(batch * n);
+    for (T& v : A) v = static_cast<T>(dist(gen));
+    for (T& v : B) v = static_cast<T>(dist(gen));
+
+    // Repeat each method until it has run for a while
+    const double min_seconds = 0.5;
+    auto measure = [&](auto&& solve_all) {
+        size_t rounds = 0;
+        double seconds = 0.0;
+        while (seconds < min_seconds) {
+            seconds += solve_all();
+            rounds++;
+        }
+        return rounds * batch / seconds;
+    };
+
+    std::vector<T> A_one, X_one;
+    double single_rate = measure([&]() {
+        A_one = A;
+        X_one = B;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t s = 0; s < batch; s++) {
+            RNP::LinearSolve<>(n, 1, &A_one[s * n * n], n, &X_one[s * n], n);
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    });
+
+    // A padded lane stride keeps rows of the interleaved arrays off the same cache sets
+    const size_t ld = batch + 16;
+    std::vector<T> A_batch(ld * n * n), X_batch(ld * n);
+    std::vector<int> info(batch);
+    double batched_rate = measure([&]() {
+        RNP::BatchedInterleave(n, n, batch, A.data(), n, n * n, A_batch.data(), ld);
+        RNP::BatchedInterleave(n, size_t(1), batch, B.data(), n, n, X_batch.data(), ld);
+        auto start = std::chrono::steady_clock::now();
+        RNP::BatchedLinearSolve(n, 1, batch, A_batch.data(), ld, X_batch.data(), info.data());
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    });
+
+    std::vector<T> X(batch * n);
+    RNP::BatchedDeinterleave(n, size_t(1), batch, X_batch.data(), ld, X.data(), n, n);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < X.size(); i++) {
+        if (static_cast<double>(X[i]) != static_cast<double>(X_one[i])) mismatches++;
+    }
+
+    std::cout << std::setw(10) << type << std::setw(5) << n << std::setw(9) << batch
+              << std::setw(16) << std::setprecision(4) << single_rate
+              << std::setw(16) << batched_rate
+              << std::setw(10) << std::setprecision(3) << batched_rate / single_rate << "x"
+              << std::setw(12) << mismatches << std::endl;
+    csv << type << "," << n << "," << batch << ",single," << std::setprecision(9) << single_rate << "," << std::endl;
+    csv << type << "," << n << "," << batch << ",batched," << batched_rate << "," << mismatches << std::endl;
+}
+
+void run_batched_test() {
+    std::vector<size_t> sizes = {4, 8, 16, 32};
+
+    std::string timestamp = get_timestamp();
+    std::string data_dir = "tblas_results_" + timestamp;
+    ensure_directory_exists(data_dir);
+    std::string csv_file = data_dir + "/batched.csv";
+    std::ofstream csv(csv_file);
+    csv << "type,n,batch,method,systems_per_sec,mismatches" << std::endl;
+
+    std::cout << "\n===== BATCHED SMALL-SYSTEM SOLVER =====" << std::endl;
+    std::cout << std::setw(10) << "type" << std::setw(5) << "n" << std::setw(9) << "batch"
+              << std::setw(16) << "single (sys/s)" << std::setw(16) << "batched (sys/s)"
+              << std::setw(11) << "speedup" << std::setw(12) << "mismatches" << std::endl;
+    for (size_t n : sizes) {
+        // About a million matrix elements per batch
+        size_t batch = std::max<size_t>(1024, (size_t(1) << 20) / (n * n));
+        bench_batched<float>("float", n, batch, csv);
+        bench_batched<double>("double", n, batch, csv);
+        bench_batched<hub_float>("hub_float", n, batch, csv);
+    }
+    std::cout << "\nResults written to " << csv_file << std::endl;
+}
+
+// Times a tall least squares solve with the level-2 Householder QR and with the
+// blocked one; b = A*x_true, so both should recover x_true
+template<typename T>
+void bench_least_squares(const char* type, size_t m, size_t n, std::ofstream& csv) {
+    std::mt19937 gen(static_cast<unsigned>(m + n));
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<double> A(m * n), x_true(n), b(m, 0.0);
+    for (double& v : A) v = dist(gen);
+    for (double& v : x_true) v = dist(gen);
+    for (size_t j = 0; j < n; j++) {
+        for (size_t i = 0; i < m; i++) {
+            b[i] += A[i + j * m] * x_true[j];
+        }
+    }
+    std::vector<T> A_t(m * n), b_t(m);
+    for (size_t i = 0; i < m * n; i++) A_t[i] = static_cast<T>(A[i]);
+    for (size_t i = 0; i < m; i++) b_t[i] = static_cast<T>(b[i]);
+
+    // Best of a few runs of each method
+    const size_t runs = 3;
+    double unblocked_seconds = 0.0, blocked_seconds = 0.0;
+    std::vector<T> A1, b1, A2, b2, tau(n), work(n);
+    int info = 0;
+    for (size_t run = 0; run < runs; run++) {
+        // Level 2: UnblockedQRFactorization and one reflector at a time for Q'*b
+        A1 = A_t;
+        b1 = b_t;
+        auto start = std::chrono::steady_clock::now();
+        RNP::TLASupport::UnblockedQRFactorization(m, n, A1.data(), m, tau.data(), work.data());
+        RNP::TLASupport::ApplyOrthognalMatrixFromElementaryReflectors<'L','C'>(m, 1, n, A1.data(), (int)m, tau.data(), b1.data(), (int)m, work.data());
+        RNP::TBLAS::SolveTrM<'L','U','N','N'>(n, 1, T(1), A1.data(), m, b1.data(), m);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (run == 0 || seconds < unblocked_seconds) unblocked_seconds = seconds;
+
+        A2 = A_t;
+        b2 = b_t;
+        start = std::chrono::steady_clock::now();
+        info = RNP::LeastSquares(m, n, 1, A2.data(), m, b2.data(), m);
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (run == 0 || seconds < blocked_seconds) blocked_seconds = seconds;
+    }
+
+    std::vector<double> x1(n), x2(n);
+    for (size_t i = 0; i < n; i++) {
+        x1[i] = static_cast<double>(b1[i]);
+        x2[i] = static_cast<double>(b2[i]);
+    }
+    double err1 = forward_error(x1, x_true), err2 = forward_error(x2, x_true);
+
+    std::cout << std::setw(10) << type << std::setw(8) << m << std::setw(5) << n
+              << std::setw(12) << std::setprecision(4) << unblocked_seconds
+              << std::setw(12) << blocked_seconds
+              << std::setw(10) << std::setprecision(3) << unblocked_seconds / blocked_seconds << "x"
+              << std::setw(12) << err1 << std::setw(12) << err2
+              << (info != 0 ? "  rank deficient" : "") << std::endl;
+    csv << type << "," << m << "," << n << ",unblocked," << std::setprecision(9) << unblocked_seconds << "," << err1 << std::endl;
+    csv << type << "," << m << "," << n << ",blocked," << blocked_seconds << "," << err2 << std::endl;
+}
+
+void run_least_squares_test() {
+    std::vector<size_t> row_counts = {10000, 100000};
+    const size_t n = 64;
+
+    std::string timestamp = get_timestamp();
+    std::string data_dir = "tblas_results_" + timestamp;
+    ensure_directory_exists(data_dir);
+    std::string csv_file = data_dir + "/least_squares.csv";
+    std::ofstream csv(csv_file);
+    csv << "type,m,n,method,seconds,forward_error" << std::endl;
+
+    std::cout << "\n===== TALL LEAST SQUARES (HOUSEHOLDER QR) =====" << std::endl;
+    std::cout << std::setw(10) << "type" << std::setw(8) << "m" << std::setw(5) << "n"
+              << std::setw(12) << "level 2 (s)" << std::setw(12) << "blocked (s)"
+              << std::setw(11) << "speedup" << std::setw(12) << "err lvl 2" << std::setw(12) << "err blocked" << std::endl;
+    for (size_t m : row_counts) {
+        bench_least_squares<double>("double", m, n, csv);
+        bench_least_squares<hub_float>("hub_float", m, n, csv);
+    }
+    std::cout << "\nResults written to " << csv_file << std::endl;
+}
+
+// Random symmetric positive definite n x n matrix Q*diag(d)*Q' with eigenvalues d
+// spaced geometrically from 1 down to 1/kappa, Q orthogonal from a random QR
+std::vector<double> make_spd_matrix(size_t n, double kappa, std::mt19937& gen) {
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::vector<double> Q(n * n), tau(n), work(n);
+    for (double& v : Q) v = normal(gen);
+    RNP::TLASupport::QRFactorization(n, n, Q.data(), n, tau.data());
+    RNP::TLASupport::GenerateOrthognalMatrixFromElementaryReflectors(n, n, n, Q.data(), (int)n, tau.data(), work.data());
+
+    std::vector<double> QD(Q), A(n * n);
+    for (size_t j = 0; j < n; j++) {
+        const double d = (n > 1) ? std::pow(kappa, -double(j) / double(n - 1)) : 1.0;
+        for (size_t i = 0; i < n; i++) QD[i + j * n] *= d;
+    }
+    RNP::TBLAS::MultMM<'N','T'>(n, n, n, 1.0, QD.data(), n, Q.data(), n, 0.0, A.data(), n);
+    for (size_t j = 0; j < n; j++) {
+        for (size_t i = j + 1; i < n; i++) {
+            const double v = 0.5 * (A[i + j * n] + A[j + i * n]);
+            A[i + j * n] = v;
+            A[j + i * n] = v;
+        }
+    }
+    return A;
+}
+
+// Times PositiveDefiniteSolve against LinearSolve on one SPD system in type T
+// and reports the forward error of each against the double-precision x_true
+template<typename T>
+void bench_spd(const char* type, double kappa, const std::vector<double>& A, const std::vector<double>& b,
+               const std::vector<double>& x_true, size_t n, std::ofstream& csv) {
+    std::vector<T> A_t(n * n), b_t(n);
+    for (size_t i = 0; i < n * n; i++) A_t[i] = static_cast<T>(A[i]);
+    for (size_t i = 0; i < n; i++) b_t[i] = static_cast<T>(b[i]);
+
+    // Best of a few runs of each method
+    const size_t runs = 3;
+    double chol_seconds = 0.0, lu_seconds = 0.0;
+    std::vector<T> A1, x1, A2, x2;
+    int chol_info = 0, lu_info = 0;
+    for (size_t run = 0; run < runs; run++) {
+        A1 = A_t;
+        x1 = b_t;
+        auto start = std::chrono::steady_clock::now();
+        RNP::PositiveDefiniteSolve<'L'>(n, 1, A1.data(), n, x1.data(), n, &chol_info);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (run == 0 || seconds < chol_seconds) chol_seconds = seconds;
+
+        A2 = A_t;
+        x2 = b_t;
+        start = std::chrono::steady_clock::now();
+        RNP::LinearSolve<>(n, 1, A2.data(), n, x2.data(), n, &lu_info);
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (run == 0 || seconds < lu_seconds) lu_seconds = seconds;
+    }
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    double chol_error = nan, lu_error = nan;
+    if (chol_info == 0) chol_error = forward_error(arrayToDoubleVector(x1.data(), n), x_true);
+    if (lu_info == 0) lu_error = forward_error(arrayToDoubleVector(x2.data(), n), x_true);
+
+    std::cout << std::setw(9) << std::setprecision(0) << std::scientific << kappa << std::defaultfloat
+              << std::setw(11) << type
+              << std::setw(12) << std::setprecision(4) << chol_seconds
+              << std::setw(12) << lu_seconds
+              << std::setw(10) << std::setprecision(3) << lu_seconds / chol_seconds << "x"
+              << std::setw(12) << chol_error << std::setw(12) << lu_error
+              << (chol_info != 0 ? "  not positive definite in " + std::string(type) : std::string()) << std::endl;
+    csv << kappa << "," << type << ",cholesky," << std::setprecision(9) << chol_seconds << "," << chol_info << "," << chol_error << std::endl;
+    csv << kappa << "," << type << ",lu," << lu_seconds << "," << lu_info << "," << lu_error << std::endl;
+}
+
+void run_spd_test() {
+    const size_t n = 500;
+    std::vector<double> condition_numbers = {1e2, 1e4, 1e6, 1e8};
+
+    std::string timestamp = get_timestamp();
+    std::string data_dir = "tblas_results_" + timestamp;
+    ensure_directory_exists(data_dir);
+    std::string csv_file = data_dir + "/spd.csv";
+    std::ofstream csv(csv_file);
+    csv << "kappa,type,method,seconds,info,forward_error" << std::endl;
+
+    std::cout << "\n===== SPD SYSTEMS: CHOLESKY VS LU (n = " << n << ") =====" << std::endl;
+    std::cout << std::setw(9) << "kappa" << std::setw(11) << "type"
+              << std::setw(12) << "chol (s)" << std::setw(12) << "LU (s)"
+              << std::setw(11) << "speedup" << std::setw(12) << "err chol" << std::setw(12) << "err LU" << std::endl;
+    for (double kappa : condition_numbers) {
+        std::mt19937 gen(static_cast<unsigned>(std::log10(kappa)));
+        std::vector<double> A = make_spd_matrix(n, kappa, gen);
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        std::vector<double> x_true(n), b(n, 0.0);
+        for (double& v : x_true) v = dist(gen);
+        for (size_t j = 0; j < n; j++) {
+            for (size_t i = 0; i < n; i++) {
+                b[i] += A[i + j * n] * x_true[j];
+            }
+        }
+        bench_spd<float>("float", kappa, A, b, x_true, n, csv);
+        bench_spd<double>("double", kappa, A, b, x_true, n, csv);
+        bench_spd<hub_float>("hub_float", kappa, A, b, x_true, n, csv);
+    }
+    std::cout << "\nResults written to " << csv_file << std::endl;
+}
+
+// Random symmetric n x n matrix Q*diag(lambda)*Q' with Q Haar-distributed and
+// eigenvalues of alternating sign whose magnitudes are spread geometrically from
+// 1 down to 1/cond; returns A and the eigenvalues in ascending order
+std::vector<double> make_symmetric_matrix(size_t n, double cond, std::uint64_t seed, std::vector<double>& lambda) {
+    std::vector<double> Q(n * n), QD(n * n), A(n * n);
+    lambda.resize(n);
+    RNP::SingularValueDistribution(n, cond, 'G', seed, lambda.data());
+    for (size_t j = 1; j < n; j += 2) lambda[j] = -lambda[j];
+    RNP::_RandomOrthonormalColumns(n, n, seed, 0, Q.data());
+    QD = Q;
+    for (size_t j = 0; j < n; j++) {
+        RNP::TBLAS::Scale(n, lambda[j], &QD[j * n], 1);
+    }
+    RNP::TBLAS::MultMM<'N','T'>(n, n, n, 1.0, QD.data(), n, Q.data(), n, 0.0, A.data(), n);
+    for (size_t j = 0; j < n; j++) {
+        for (size_t i = j + 1; i < n; i++) {
+            const double v = 0.5 * (A[i + j * n] + A[j + i * n]);
+            A[i + j * n] = v;
+            A[j + i * n] = v;
+        }
+    }
+    std::sort(lambda.begin(), lambda.end());
+    return A;
+}
+
+// Times SymmetricEigensystem in type T, with and without eigenvectors, on A
+// rounded to T. Errors are measured in double against the exact eigenvalues and
+// relative to ||A||_2 = 1: the largest eigenvalue error, the loss of
+// orthogonality max|Z'*Z - I| and the residual max|A*Z - Z*diag(w)|.
+template<typename T>
+void bench_eigen(const char* type, double cond, const std::vector<double>& A, const std::vector<double>& lambda,
+                 size_t n, std::ofstream& csv) {
+    std::vector<T> A_t(n * n);
+    for (size_t i = 0; i < n * n; i++) A_t[i] = static_cast<T>(A[i]);
+
+    // Best of a few runs of each job
+    const size_t runs = 3;
+    double values_seconds = 0.0, vectors_seconds = 0.0;
+    std::vector<T> A1, A2, w1(n), w2(n);
+    int info = 0;
+    for (size_t run = 0; run < runs; run++) {
+        A1 = A_t;
+        auto start = std::chrono::steady_clock::now();
+        RNP::SymmetricEigensystem<'N'>(n, A1.data(), n, w1.data());
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (run == 0 || seconds < values_seconds) values_seconds = seconds;
+
+        A2 = A_t;
+        start = std::chrono::steady_clock::now();
+        info = RNP::SymmetricEigensystem<'V'>(n, A2.data(), n, w2.data());
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (run == 0 || seconds < vectors_seconds) vectors_seconds = seconds;
+    }
+
+    double value_error = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        value_error = std::max(value_error, std::fabs(static_cast<double>(w2[i]) - lambda[i]));
+    }
+    std::vector<double> Z(arrayToDoubleVector(A2.data(), n * n)), ZtZ(n * n), AZ(n * n);
+    RNP::TBLAS::MultMM<'T','N'>(n, n, n, 1.0, Z.data(), n, Z.data(), n, 0.0, ZtZ.data(), n);
+    RNP::TBLAS::MultMM<'N','N'>(n, n, n, 1.0, A.data(), n, Z.data(), n, 0.0, AZ.data(), n);
+    double orthogonality = 0.0, residual = 0.0;
+    for (size_t j = 0; j < n; j++) {
+        for (size_t i = 0; i < n; i++) {
+            orthogonality = std::max(orthogonality, std::fabs(ZtZ[i + j * n] - (i == j ? 1.0 : 0.0)));
+            residual = std::max(residual, std::fabs(AZ[i + j * n] - static_cast<double>(w2[j]) * Z[i + j * n]));
+        }
+    }
+
+    std::cout << std::setw(6) << n << std::setw(9) << std::setprecision(0) << std::scientific << cond << std::defaultfloat
+              << std::setw(11) << type
+              << std::setw(12) << std::setprecision(4) << values_seconds
+              << std::setw(12) << vectors_seconds
+              << std::setw(12) << std::setprecision(3) << value_error
+              << std::setw(12) << orthogonality << std::setw(12) << residual
+              << (info != 0 ? "  QL did not converge" : "") << std::endl;
+    csv << n << "," << cond << "," << type << "," << std::setprecision(9) << values_seconds << "," << vectors_seconds << ","
+        << info << "," << value_error << "," << orthogonality << "," << residual << std::endl;
+}
+
+void run_eigen_test() {
+    const std::vector<size_t> sizes = {50, 100, 200};
+    const std::vector<double> condition_numbers = {1e2, 1e6};
+
+    std::string timestamp = get_timestamp();
+    std::string data_dir = "tblas_results_" + timestamp;
+    ensure_directory_exists(data_dir);
+    std::string csv_file = data_dir + "/eigen.csv";
+    std::ofstream csv(csv_file);
+    csv << "n,cond,type,values_seconds,vectors_seconds,info,eigenvalue_error,orthogonality,residual" << std::endl;
+
+    std::cout << "\n===== SYMMETRIC EIGENSYSTEM (TRIDIAGONAL QL) =====" << std::endl;
+    std::cout << std::setw(6) << "n" << std::setw(9) << "cond" << std::setw(11) << "type"
+              << std::setw(12) << "values (s)" << std::setw(12) << "vectors (s)"
+              << std::setw(12) << "max |dw|" << std::setw(12) << "|Z'Z-I|" << std::setw(12) << "|AZ-ZW|" << std::endl;
+    for (double cond : condition_numbers) {
+        for (size_t n : sizes) {
+            std::vector<double> lambda;
+            std::vector<double> A = make_symmetric_matrix(n, cond, (std::uint64_t(n) << 8) | std::uint64_t(std::log10(cond)), lambda);
+            bench_eigen<float>("float", cond, A, lambda, n, csv);
+            bench_eigen<double>("double", cond, A, lambda, n, csv);
+            bench_eigen<hub_float>("hub_float", cond, A, lambda, n, csv);
+        }
+    }
+    std::cout << "\nResults written to " << csv_file << std::endl;
+}
+
+// Number of entries of x and y whose bit patterns differ (as doubles)
+template<typename T>
+size_t count_bit_differences(const std::vector<T>& x, const std::vector<T>& y) {
+    size_t differences = 0;
+    for (size_t i = 0; i < x.size(); i++) {
+        const double xd = static_cast<double>(x[i]), yd = static_cast<double>(y[i]);
+        if (std::memcmp(&xd, &yd, sizeof(double)) != 0) differences++;
+    }
+    return differences;
+}
+
+// MultMM<transa,transb> takes the blocked path for these sizes; compare it with
+// the reference loops on a B with about a quarter of its entries zero
+template<char transa, char transb, typename T>
+bool check_blocked_gemm(const char* type, size_t m, size_t n, size_t k, const T& beta) {
+    std::mt19937 gen(static_cast<unsigned>(transa * 256 + transb));
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<T> A(m * k), B(k * n), C(m * n);
+    for (T& v : A) v = static_cast<T>(dist(gen));
+    for (T& v : B) v = (dist(gen) < -0.5) ? T(0) : static_cast<T>(dist(gen));
+    for (T& v : C) v = static_cast<T>(dist(gen));
+    const size_t lda = (transa == 'N') ? m : k;
+    const size_t ldb = (transb == 'N') ? k : n;
+    std::vector<T> blocked = C, reference = C;
+    RNP::TBLAS::MultMM<transa,transb>(m, n, k, T(0.75), A.data(), lda, B.data(), ldb, beta, blocked.data(), m);
+    RNP::TBLAS::_GemmReference<transa,transb>(m, n, k, T(0.75), A.data(), lda, B.data(), ldb, beta, reference.data(), m);
+    const size_t differences = count_bit_differences(blocked, reference);
+    std::cout << "gemm " << transa << transb << " " << std::setw(9) << type << " " << std::setw(11)
+              << (std::to_string(m) + "x" + std::to_string(n) + "x" + std::to_string(k)) << " beta " << std::setw(4)
+              << static_cast<double>(beta) << ": " << (differences ? std::to_string(differences) + " entries differ" : "identical")
+              << std::endl;
+    return differences == 0;
+}
+
+// A product within one block of the packing, and one with several mc row blocks
+// and kc depth blocks of both the generic (double) and hub_float kernels
+template<typename T>
+bool check_blocked_kernels(const char* type) {
+    const size_t sizes[2][3] = {{70, 45, 90}, {300, 70, 600}};
+    bool ok = true;
+    for (const auto& size : sizes) {
+        for (double beta : {0.0, 1.0, 0.5}) {
+            ok &= check_blocked_gemm<'N','N'>(type, size[0], size[1], size[2], T(beta));
+            ok &= check_blocked_gemm<'N','T'>(type, size[0], size[1], size[2], T(beta));
+            ok &= check_blocked_gemm<'T','N'>(type, size[0], size[1], size[2], T(beta));
+            ok &= check_blocked_gemm<'T','T'>(type, size[0], size[1], size[2], T(beta));
+        }
+    }
+    return ok;
+}
+
+// LUDecomposition must give the same factors and pivots as UnblockedLUDecomposition
+template<typename T>
+bool check_blocked_lu(const char* type) {
+    const size_t n = 300;
+    std::vector<double> general(n * n);
+    RNP::RandomConditionedMatrix(n, n, 1e3, 'G', 4, general.data(), n);
+    std::vector<T> blocked(n * n), unblocked(n * n);
+    for (size_t i = 0; i < n * n; i++) blocked[i] = unblocked[i] = static_cast<T>(general[i]);
+    std::vector<size_t> blocked_pivots(n), unblocked_pivots(n);
+    const int blocked_info = RNP::TLASupport::LUDecomposition(n, n, blocked.data(), n, blocked_pivots.data());
+    const int unblocked_info = RNP::TLASupport::UnblockedLUDecomposition(n, n, unblocked.data(), n, unblocked_pivots.data());
+    const size_t differences = count_bit_differences(blocked, unblocked);
+    const bool ok = differences == 0 && blocked_pivots == unblocked_pivots && blocked_info == unblocked_info;
+    std::cout << "lu      " << std::setw(9) << type << "          : "
+              << (ok ? std::string("identical") : std::to_string(differences) + " entries differ"
+                      + (blocked_pivots == unblocked_pivots ? "" : ", pivots differ")) << std::endl;
+    return ok;
+}
+
+// --check: the blocked kernels must give the same bits as the reference code,
+// run serially and with the products split over 4 threads
+bool run_checks() {
+    bool ok = true;
+    for (size_t threads : {1, 4}) {
+        RNP::TBLAS::SetThreadCount(threads);
+        std::cout << "--- " << threads << (threads == 1 ? " thread" : " threads") << std::endl;
+        ok &= check_blocked_kernels<double>("double");
+        ok &= check_blocked_kernels<hub_float>("hub_float");
+        ok &= check_blocked_lu<double>("double");
+        ok &= check_blocked_lu<hub_float>("hub_float");
+    }
+    std::cout << (ok ? "All checks passed" : "Some checks FAILED") << std::endl;
+    return ok;
+}
+
+// Throughput of the main dense kernels in type T, in flops per second. Every
+// iteration of a factorization starts from a fresh copy of the input matrix.
+template<typename T>
+void add_dense_benchmarks(BenchmarkHarness& harness, const char* type) {
+    const size_t n = 128;
+    const double dn = static_cast<double>(n);
+    std::mt19937 gen(1);
+    std::vector<double> lambda;
+    const std::vector<double> spd = make_spd_matrix(n, 1e3, gen);
+    const std::vector<double> sym = make_symmetric_matrix(n, 1e3, 2, lambda);
+    std::vector<double> general(n * n);
+    RNP::RandomConditionedMatrix(n, n, 1e3, 'G', 3, general.data(), n);
+
+    std::vector<T> A(n * n), S(n * n), G(n * n), work(n * n), C(n * n), tau(n), w(n);
+    std::vector<size_t> pivots(n);
+    for (size_t i = 0; i < n * n; i++) {
+        A[i] = static_cast<T>(spd[i]);
+        S[i] = static_cast<T>(sym[i]);
+        G[i] = static_cast<T>(general[i]);
+    }
+
+    harness.add("gemm", type, {{"n", dn}}, [n, G, C]() mutable {
+        RNP::TBLAS::MultMM<'N','N'>(n, n, n, T(1), G.data(), n, G.data(), n, T(0), C.data(), n);
+        do_not_optimize(C[0]);
+    }, 2.0 * dn * dn * dn);
+    harness.add("lu", type, {{"n", dn}}, [n, G, work, pivots]() mutable {
+        work = G;
+        RNP::TLASupport::LUDecomposition(n, n, work.data(), n, pivots.data());
+        do_not_optimize(work[0]);
+    }, 2.0 / 3.0 * dn * dn * dn);
+    harness.add("cholesky", type, {{"n", dn}}, [n, A, work]() mutable {
+        work = A;
+        RNP::TLASupport::CholeskyDecomposition<'L'>(n, work.data(), n);
+        do_not_optimize(work[0]);
+    }, dn * dn * dn / 3.0);
+    harness.add("qr", type, {{"n", dn}}, [n, G, work, tau]() mutable {
+        work = G;
+        RNP::TLASupport::QRFactorization(n, n, work.data(), n, tau.data());
+        do_not_optimize(work[0]);
+    }, 4.0 / 3.0 * dn * dn * dn);
+    harness.add("eigenvalues", type, {{"n", dn}}, [n, S, work, w]() mutable {
+        work = S;
+        RNP::SymmetricEigensystem<'N'>(n, work.data(), n, w.data());
+        do_not_optimize(w[0]);
+    }, 4.0 / 3.0 * dn * dn * dn);
+    harness.add("eigenvectors", type, {{"n", dn}}, [n, S, work, w]() mutable {
+        work = S;
+        RNP::SymmetricEigensystem<'V'>(n, work.data(), n, w.data());
+        do_not_optimize(w[0]);
+    }, 9.0 * dn * dn * dn);
+}
+
+void run_benchmarks(const BenchmarkOptions& options) {
+    BenchmarkHarness harness("tblas_lapack", options);
+    add_dense_benchmarks<float>(harness, "float");
+    add_dense_benchmarks<double>(harness, "double");
+    add_dense_benchmarks<hub_float>(harness, "hub_float");
+    harness.run();
+}
+
+int main(int argc, char* argv[]) {
+    // Level-3 routines use every core unless --threads says otherwise;
+    // the results do not depend on the thread count
+    // --bench times the dense kernels through the benchmark harness instead of
+    // showing the menu, and --check compares the blocked kernels with the
+    // reference code
+    size_t threads = ThreadPool::default_threads();
+    BenchmarkOptions bench_options;
+    bool bench = false;
+    bool check = false;
+    bool usage = !bench_options.parse(argc, argv);
+    for (int i = 1; i < argc && !usage; i++) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--bench") == 0) {
+            bench = true;
+        } else if (std::strcmp(argv[i], "--check") == 0) {
+            check = true;
+        } else {
+            usage = true;
+        }
+    }
+    if (usage) {
+        std::cerr << "Usage: " << argv[0] << " [--threads N] [--check] [--bench " << BenchmarkOptions::usage() << "]" << std::endl;
+        return 1;
+    }
+    RNP::TBLAS::SetThreadCount(threads);
+    if (check) {
+        return run_checks() ? 0 : 1;
+    }
+    if (bench) {
+        run_benchmarks(bench_options);
+        return 0;
+    }
+
     // Choose between simple test and exhaustive test
     char choice;
     std::cout << "Choose test type:\n"
               << "1. Simple 3x3 system test\n"
               << "2. Exhaustive multi-size stability test\n"
-              << "Enter choice (1 or 2): ";
+              << "3. Mixed-precision iterative refinement benchmark\n"
+              << "4. Batched small-system solver benchmark\n"
+              << "5. Tall least squares (blocked QR) benchmark\n"
+              << "6. SPD systems: Cholesky vs LU benchmark\n"
+              << "7. Symmetric eigensystem benchmark\n"
+              << "Enter choice (1-7): ";
     std::cin >> choice;
     
     if (choice == '2') {
-        run_exhaustive_test();
+        run_exhaustive_test(threads);
+        return 0;
+    }
+    if (choice == '3') {
+        run_refinement_test();
+        return 0;
+    }
+    if (choice == '4') {
+        run_batched_test();
+        return 0;
+    }
+    if (choice == '5') {
+        run_least_squares_test();
+        return 0;
+    }
+    if (choice == '6') {
+        run_spd_test();
+        return 0;
+    }
+    if (choice == '7') {
+        run_eigen_test();
         return 0;
     }
     